@@ -8,6 +8,8 @@ import glob
 import io
 import os
 import pprint
+import re
+import socket
 import sys
 import time
 
@@ -37,6 +39,46 @@ with sh.pushd(PRISTINE):
 
 variants = {}
 
+
+def gdb_session(sim, test, cmds):
+	'''Runs test under the simulator's gdb stub, returning the reply to each
+	of cmds. The last command should end the session (e.g. 'k')'''
+	with socket.socket() as probe:
+		probe.bind(('localhost', 0))
+		port = probe.getsockname()[1]
+	proc = sim('-f', test, '--gdb={}'.format(port), _bg=True)
+
+	for attempt in range(100):
+		try:
+			conn = socket.create_connection(('localhost', port))
+			break
+		except ConnectionRefusedError:
+			time.sleep(.1)
+	else:
+		raise OSError("No gdb stub on port {}".format(port))
+
+	replies = []
+	with conn:
+		conn.sendall(b'+')
+		buf = b''
+		for cmd in ['qSupported'] + cmds:
+			csum = sum(cmd.encode()) & 0xff
+			conn.sendall('${}#{:02x}'.format(cmd, csum).encode())
+			while True:
+				m = re.search(rb'\$([^#]*)#..', buf)
+				if m:
+					buf = buf[m.end():]
+					conn.sendall(b'+')
+					replies.append(m.group(1).decode())
+					break
+				data = conn.recv(4096)
+				if not data:
+					replies.append(None)
+					break
+				buf += data
+	proc.wait()
+	return replies[1:]
+
 log.info(sh.cc('--version'))
 
 for variant_file in os.listdir('simulator/configs'):
@@ -81,6 +123,35 @@ for variant_file in os.listdir('simulator/configs'):
 				log.info("\t\t\t\t%s", e)
 				any_fail = True
 
+		# Dirty page tracking moves stores off the host pointer path,
+		# unaligned stores must still land every byte
+		for test in glob.iglob('tests/**/str*_reg_t1.bin', recursive=True):
+			log.info("\t\ttest (--dirty-pages): %s", test)
+			try:
+				sim('-r', '-f', test, '--dirty-pages', '/dev/null')
+				log.info("\t\t\tPASSED")
+			except sh.ErrorReturnCode as e:
+				log.info("\t\t\tFAILED -- Error code %s", e.exit_code)
+				log.info("\t\t\t\t%s", e)
+				any_fail = True
+
+		# Seeking has to bring every pipeline stage thread to the same cycle,
+		# through instructions that take more than one
+		if 'CONFIG_HAVE_REPLAY=y' in open(os.path.join('configs', variant)).read():
+			for test in glob.iglob('tests/**/str_reg_t1.bin', recursive=True):
+				log.info("\t\ttest (seek): %s", test)
+				try:
+					r = gdb_session(sim, test,
+							['c', 'g', 'bs', 'bs', 'bs', 'bs', 'c', 'g',
+							 'bc', 'c', 'g', 'k'])
+					if (r[2:6] != ['S05'] * 4) or (r[8] != 'S05') or \
+							(r[1] != r[7]) or (r[1] != r[10]):
+						raise ValueError(r)
+					log.info("\t\t\tPASSED")
+				except (sh.ErrorReturnCode, ValueError, OSError) as e:
+					log.info("\t\t\tFAILED -- %s", e)
+					any_fail = True
+
 		if any_fail:
 			raise NotImplementedError("Failed test cases")
 
@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+
+# Compares simulated cycles/sec of the threaded pipeline's stage
+# synchronization implementations: the original semaphores
+# (build-373-release-semaphores) and the default spin/futex barrier
+# (build-373-release). Build both variants first, e.g.
+#
+#   tup variant configs/373-release configs/373-release-semaphores
+#   tup
+
+import argparse
+import os
+import re
+import shutil
+import statistics
+import subprocess
+import sys
+
+assert sys.version_info >= (3,4)
+
+parser = argparse.ArgumentParser()
+parser.add_argument('-n', '--runs', type=int, default=5,
+		help='Runs per variant (default 5)')
+parser.add_argument('-l', '--limit', type=int, default=200000,
+		help='Cycles per run (default 200000)')
+parser.add_argument('--pin-stages', action='store_true',
+		help='Pass --pin-stages to the simulator')
+parser.add_argument('variants', nargs='*',
+		default=['build-373-release-semaphores', 'build-373-release'],
+		help='Variant build directories to compare, the first is the baseline')
+args = parser.parse_args()
+
+freq_re = re.compile(r'Approximate average frequency: ([0-9.]+) hz')
+
+def run(sim):
+	cmd = [sim, '--usetestflash', '-l', str(args.limit)]
+	if args.pin_stages:
+		cmd.append('--pin-stages')
+	# The 373 test flash never exits on its own, so the cycle limit ends
+	# every run with an error; only the reported frequency matters here
+	p = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+			universal_newlines=True)
+	# The 373 GPIO peripheral leaves its named pipes behind
+	shutil.rmtree('/tmp/generic_gpio', ignore_errors=True)
+	m = freq_re.search(p.stdout)
+	if m is None:
+		print(p.stdout[-2000:], file=sys.stderr)
+		raise RuntimeError("No frequency reported by " + sim)
+	return float(m.group(1))
+
+results = {}
+for variant in args.variants:
+	sim = os.path.join(variant, 'simulator')
+	if not os.path.exists(sim):
+		print("Missing %s, build the variant first" % (sim), file=sys.stderr)
+		sys.exit(1)
+	results[variant] = []
+
+# Interleave runs so drift in host load hits every variant alike
+for i in range(args.runs):
+	for variant in args.variants:
+		hz = run(os.path.join(variant, 'simulator'))
+		results[variant].append(hz)
+		print("%-32s run %d: %12.1f cycles/sec" % (variant, i, hz))
+
+print()
+base = None
+for variant in args.variants:
+	med = statistics.median(results[variant])
+	if base is None:
+		base = med
+	print("%-32s median %12.1f cycles/sec  (%.2fx)" % (variant, med, med / base))
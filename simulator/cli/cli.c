@@ -24,6 +24,18 @@
 #include "core/pretty_print.h"
 
 #include "core/simulator.h"
+#include "core/profile.h"
+#include "core/callstack.h"
+#include "core/trace.h"
+#include "core/memdump.h"
+#include "core/dirty.h"
+#include "core/symbols.h"
+#ifdef HAVE_REPLAY
+#include "core/replay.h"
+#endif
+#ifdef HAVE_ENERGY
+#include "core/energy.h"
+#endif
 
 #include <getopt.h>
 #include <ctype.h>
@@ -69,6 +81,39 @@ static void usage_fail(int retcode) {
 	      );
 #endif
 	printf("\
+\t--trace FILE\n\
+\t\tWrite a compact binary trace of executed instructions and\n\
+\t\texceptions (and memory accesses, in builds with -m) to FILE.\n\
+\t\tDecode, filter, or compare traces with tools/trace_decode\n\
+\t--trace-fetch\n\
+\t\tAlso record instruction fetches in the --trace FILE\n"
+	      );
+#ifdef HAVE_REPLAY
+	printf("\
+\t--replay-mem MB\n\
+\t\tKeep at most MB megabytes of replay history in memory per\n\
+\t\tthread (default 64). Older history is spilled to a temporary\n\
+\t\tfile and can still be seeked to\n\
+\t--replay-checkpoint N\n\
+\t\tCheckpoint replay history every N cycles (default 65536).\n\
+\t\tSeeks cross whole checkpoint intervals in one step\n"
+	      );
+#endif
+#ifdef HAVE_ENERGY
+	printf("\
+\t--energy\n\
+\t\tEstimate the energy of the run and print a summary, with the\n\
+\t\tfunctions that used the most, on exit\n\
+\t--energy-model FILE\n\
+\t\tRead energy costs from FILE ('key = value' lines, see\n\
+\t\tcore/energy.c) instead of the built-in placeholders.\n\
+\t\tImplies --energy\n\
+\t--energy-report FILE\n\
+\t\tWrite the energy of every function to FILE on exit.\n\
+\t\tImplies --energy\n"
+	      );
+#endif
+	printf("\
 \t-s, --speed SPEED\n\
 \t\tSpecify a clock speed to run at. The units are assumed to be kHz\n\
 \t\tunless otherwise specified. A warning will be printed if the \n\
@@ -86,9 +131,41 @@ static void usage_fail(int retcode) {
 \t\t(useful for catching runaway test cases)\n\
 \t-T, --no-terminate\n\
 \t\tDo not terminate when code branches to self (run forever)\n\
+\t--pairstats FILE\n\
+\t\tCount adjacent pairs of executed instructions and write them,\n\
+\t\tmost frequent first, to FILE on exit\n\
+\t--profile FILE\n\
+\t\tProfile where cycles are spent and write a report (by function,\n\
+\t\tbasic block, and instruction) to FILE on exit\n\
+\t--profile-callgrind FILE\n\
+\t\tWrite the profile to FILE in callgrind format, for kcachegrind\n\
+\t--profile-interval N\n\
+\t\tSample the PC every N cycles instead of counting every\n\
+\t\tinstruction (no basic blocks are reported then)\n\
+\t--callgraph FILE\n\
+\t\tFollow calls and returns (and exceptions, on their own) and\n\
+\t\twrite inclusive and exclusive cycles per function to FILE\n\
+\t--callgraph-folded FILE\n\
+\t\tWrite the cycles of every call chain to FILE as folded\n\
+\t\tstacks, for flamegraph.pl\n\
+\t--compare-ram FILE\n\
+\t\tCompare RAM on exit with the image in FILE (a RAM dump of a\n\
+\t\tgood run, say) and print the regions that differ. The exit\n\
+\t\tcode is a failure if any do\n\
+\t--dirty-pages FILE\n\
+\t\tTrack which pages of RAM and ROM the program stores to and\n\
+\t\twrite the ranges to FILE on exit\n\
+\t--dirty-page-size BYTES\n\
+\t\tSize of a tracked page, a power of two (default 256)\n\
+\t--symbols FILE\n\
+\t\tName functions in reports from the symbols of ELF FILE. By\n\
+\t\tdefault the .elf beside the flashed image is used, if any\n\
 \t--rzwi-memory\n\
 \t\tTreat accesses to unknown memory addresses as 'read zero,\n\
 \t\twrite ignore'. Can be useful for partially implemented cores\n\
+\t--pin-stages\n\
+\t\tPin the main thread and each pipeline stage thread to its own\n\
+\t\tCPU (threaded pipeline only)\n\
 \t-f, --flash FILE\n\
 \t\tFlash FILE into ROM before executing\n\
 \t\t(this file is likely somthing.bin)\n\
@@ -138,8 +215,30 @@ int main(int argc, char **argv) {
 			{"limit",         required_argument, 0,              'l'},
 			{"no-terminate",  no_argument,       &CONF_no_terminate, 'T'},
 			{"rzwi-memory",   no_argument,       &CONF_rzwi_memory, 2},
+			{"pin-stages",    no_argument,       &CONF_pin_stages, 1},
 			{"flash",         required_argument, 0,              'f'},
 			{"usetestflash",  no_argument,       &usetestflash,  1},
+			{"pairstats",     required_argument, 0,              3},
+			{"profile",       required_argument, 0,              8},
+			{"profile-callgrind", required_argument, 0,          9},
+			{"profile-interval", required_argument, 0,           10},
+			{"symbols",       required_argument, 0,              11},
+			{"callgraph",     required_argument, 0,              12},
+			{"callgraph-folded", required_argument, 0,           13},
+			{"trace",         required_argument, 0,              14},
+			{"trace-fetch",   no_argument,       &trace_fetch_flag, 1},
+			{"compare-ram",   required_argument, 0,              15},
+			{"dirty-pages",   required_argument, 0,              16},
+			{"dirty-page-size", required_argument, 0,            17},
+#ifdef HAVE_REPLAY
+			{"replay-mem",    required_argument, 0,              4},
+			{"replay-checkpoint", required_argument, 0,          5},
+#endif
+#ifdef HAVE_ENERGY
+			{"energy",        no_argument,       &energy_flag,   1},
+			{"energy-model",  required_argument, 0,              6},
+			{"energy-report", required_argument, 0,              7},
+#endif
 			{"help",          no_argument,       0,              '?'},
 			{0,0,0,0}
 		};
@@ -163,6 +262,83 @@ int main(int argc, char **argv) {
 				// option set a flag
 				break;
 
+			case 3:
+				pairstats_file = optarg;
+				break;
+
+			case 8:
+				profile_file = optarg;
+				break;
+
+			case 9:
+				profile_callgrind_file = optarg;
+				break;
+
+			case 10:
+				profile_interval = atoi(optarg);
+				if (profile_interval <= 0)
+					ERR(E_UNKNOWN, "--profile-interval must be at least 1\n");
+				break;
+
+			case 11:
+				symbols_load(optarg);
+				break;
+
+			case 12:
+				callstack_report_file = optarg;
+				callstack_flag = true;
+				break;
+
+			case 13:
+				callstack_folded_file = optarg;
+				callstack_flag = true;
+				break;
+
+			case 14:
+				trace_file = optarg;
+				break;
+
+			case 15:
+				compare_ram_file = optarg;
+				break;
+
+			case 16:
+				dirty_report_file = optarg;
+				break;
+
+			case 17:
+				dirty_set_page_size(atoi(optarg));
+				break;
+
+#ifdef HAVE_REPLAY
+			case 4:
+			{
+				long ret = strtol(optarg, NULL, 10);
+				if (ret <= 0)
+					ERR(E_UNKNOWN, "--replay-mem must be at least 1 MB\n");
+				replay_mem_limit = (size_t) ret << 20;
+				break;
+			}
+
+			case 5:
+				replay_checkpoint_interval = atoi(optarg);
+				if (replay_checkpoint_interval <= 0)
+					ERR(E_UNKNOWN, "--replay-checkpoint must be at least 1\n");
+				break;
+#endif
+
+#ifdef HAVE_ENERGY
+			case 6:
+				energy_load_model(optarg);
+				energy_flag = true;
+				break;
+
+			case 7:
+				energy_report_file = optarg;
+				energy_flag = true;
+				break;
+#endif
+
 			case 'g':
 				gdb_port = optarg ? atoi(optarg) : 0;
 				break;
@@ -270,6 +446,18 @@ int main(int argc, char **argv) {
 		}
 	}
 
+	if (trace_fetch_flag && !trace_file)
+		ERR(E_UNKNOWN, "--trace-fetch needs --trace FILE\n");
+
+	if (dirty_report_file)
+		dirty_enable();
+
+#ifdef HAVE_ENERGY
+	// Energy is counted per function of the call stack
+	if (energy_flag)
+		callstack_flag = true;
+#endif
+
 	if (flash_file && usetestflash) {
 		ERR(E_BAD_FLASH, "Only one of -f or --usetestflash may be used\n");
 	} else if (usetestflash) {
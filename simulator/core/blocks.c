@@ -0,0 +1,288 @@
+/* Mulator - An extensible {ARM} {e,si}mulator
+ * Copyright 2011-2012  Pat Pannuto <pat.pannuto@gmail.com>
+ *
+ * This file is part of Mulator.
+ *
+ * Mulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define STAGE BLK
+
+#include "blocks.h"
+#include "pipeline.h"
+#include "state_sync.h"
+
+#include "simulator.h"
+#include "opcodes.h"
+
+#include "cpu/core.h"
+#include "cpu/misc.h"
+#include "cpu/recryptor/recryptor.h"
+
+#ifdef BLOCK_ENGINE
+
+#ifndef NO_PIPELINE
+#error "The block engine replaces the NO_PIPELINE stage ticks, it requires NO_PIPELINE"
+#endif
+#ifdef HAVE_REPLAY
+#error "The block engine does not record per-stage state history for replay"
+#endif
+
+/* Basic-block translation
+ *
+ * In NO_PIPELINE builds every instruction is fetched, decoded and executed by
+ * three stage ticks, each bracketed by state_start_tick()/state_tock(). The
+ * block engine instead decodes a run of straight-line Thumb code once into an
+ * array of handler pointers and instruction words and replays it with
+ * computed-goto dispatch.
+ *
+ * Each instruction still runs as its own simulated cycle: the simulator's
+ * per-cycle bookkeeping (sim_cycle_begin) runs first, the IF/ID latches are
+ * set to exactly what the stage ticks would have left there, async
+ * exceptions are checked and the handler runs inside its own tick. A block
+ * exits as soon as the fetch PC is no longer the next instruction in the
+ * block (any branch, PC write or exception entry), when the simulator wants
+ * control back (sim_break_pending), or when memory holding translated code
+ * is written. Translation stops at unconditional control flow and IT, and
+ * instructions in an IT block always go through the stage ticks.
+ */
+
+#define BLOCK_MAX_INSTS 32
+#define BLOCK_CACHE_BITS 10
+#define BLOCK_CACHE_SIZE (1 << BLOCK_CACHE_BITS)
+#define BLOCK_CACHE_IDX(_pc) (((_pc) >> 1) & (BLOCK_CACHE_SIZE - 1))
+
+enum block_kind {
+	BLOCK_END,
+	BLOCK_OP16,
+	BLOCK_OP32,
+};
+
+struct block_inst {
+	enum block_kind kind;
+	uint32_t inst;
+	uint32_t pc;
+	uint32_t next_pc;
+	struct op *o;
+	union {
+		void (*fn16) (uint16_t);
+		void (*fn32) (uint32_t);
+	};
+};
+
+struct block {
+	uint32_t pc;
+	uint32_t gen;
+	struct block_inst insts[BLOCK_MAX_INSTS + 1];
+};
+
+static struct block blocks[BLOCK_CACHE_SIZE];
+
+// Bumping the generation drops every translation at once
+static uint32_t blocks_gen = 1;
+
+// Set when translated code is overwritten, the running block must stop
+static bool blocks_dirty;
+
+// Which 64-byte lines hold translated code, two-level like the memmap
+#define CODE_MAP_L1_SHIFT 20
+#define CODE_MAP_LINE_SHIFT 6
+#define CODE_MAP_L2_BITS (1 << (CODE_MAP_L1_SHIFT - CODE_MAP_LINE_SHIFT))
+
+static uint8_t *code_map[1 << (32 - CODE_MAP_L1_SHIFT)];
+
+static void code_map_mark(uint32_t bot, uint32_t top) {
+	for (uint32_t addr = bot & ~((1U << CODE_MAP_LINE_SHIFT) - 1);
+			addr < top; addr += (1U << CODE_MAP_LINE_SHIFT)) {
+		uint8_t **l2 = &code_map[addr >> CODE_MAP_L1_SHIFT];
+		if (*l2 == NULL) {
+			*l2 = calloc(CODE_MAP_L2_BITS / 8, 1);
+			assert(*l2 && "Allocating code map");
+		}
+		uint32_t line = (addr & ((1U << CODE_MAP_L1_SHIFT) - 1))
+			>> CODE_MAP_LINE_SHIFT;
+		(*l2)[line / 8] |= 1 << (line % 8);
+	}
+}
+
+EXPORT void blocks_flush(void) {
+	blocks_gen++;
+	blocks_dirty = true;
+	for (unsigned i = 0; i < (1 << (32 - CODE_MAP_L1_SHIFT)); i++)
+		if (code_map[i])
+			memset(code_map[i], 0, CODE_MAP_L2_BITS / 8);
+}
+
+EXPORT void blocks_invalidate(uint32_t addr) {
+	uint8_t *l2 = code_map[addr >> CODE_MAP_L1_SHIFT];
+	if (likely(l2 == NULL))
+		return;
+	uint32_t line = (addr & ((1U << CODE_MAP_L1_SHIFT) - 1))
+		>> CODE_MAP_LINE_SHIFT;
+	if (unlikely(l2[line / 8] & (1 << (line % 8)))) {
+		DBG1("Write to translated code at %08x, flushing blocks\n", addr);
+		blocks_flush();
+	}
+}
+
+// Instructions after which the fetch PC is (almost) never sequential
+static bool ends_block16(uint16_t inst) {
+	return ((inst & 0xf800) == 0xe000) ||	// B (T2)
+		((inst & 0xff00) == 0x4700) ||	// BX, BLX
+		((inst & 0xff00) == 0xbd00) ||	// POP {...,PC}
+		((inst & 0xff00) == 0xdf00) ||	// SVC
+		((inst & 0xff00) == 0xde00) ||	// UDF
+		((inst & 0xff00) == 0xbe00) ||	// BKPT
+		(((inst & 0xff00) == 0xbf00) && (inst & 0xf));	// IT
+}
+
+static bool ends_block32(uint32_t inst) {
+	// B (T3, T4), BL, and the misc control space (MSR, CPS, ...)
+	return (inst & 0xf8008000) == 0xf0008000;
+}
+
+static struct block* translate(uint32_t pc) {
+	struct block *b = &blocks[BLOCK_CACHE_IDX(pc)];
+	int n = 0;
+
+	// The slot is rewritten in place, never leave it half valid
+	b->gen = 0;
+
+	while (n < BLOCK_MAX_INSTS) {
+		struct block_inst *e = &b->insts[n];
+		uint16_t hw;
+		if (!try_fetch_halfword(pc, &hw))
+			break;
+
+		uint32_t inst = hw;
+		uint32_t next_pc = pc + 2;
+		switch (hw & 0xf800) {
+			case 0xe800:
+			case 0xf000:
+			case 0xf800:
+				if (!try_fetch_halfword(pc + 2, &hw))
+					goto done;
+				inst = (inst << 16) | hw;
+				next_pc = pc + 4;
+				e->kind = BLOCK_OP32;
+				break;
+			default:
+				e->kind = BLOCK_OP16;
+		}
+
+		// Undefined encodings (often a literal pool past the last
+		// instruction) are left for the ID stage to report if reached
+		struct op *o = find_op_quiet(inst);
+		if (o == NULL)
+			break;
+
+		e->inst = inst;
+		e->pc = pc;
+		e->next_pc = next_pc;
+		e->o = o;
+		if (o->is16)
+			e->fn16 = o->op16.fn;
+		else
+			e->fn32 = o->op32.fn;
+		n++;
+		pc = next_pc;
+
+		if ((e->kind == BLOCK_OP16) ? ends_block16(inst) : ends_block32(inst))
+			break;
+	}
+done:
+	if (n == 0)
+		return NULL;
+
+	b->insts[n].kind = BLOCK_END;
+	b->pc = b->insts[0].pc;
+	b->gen = blocks_gen;
+	code_map_mark(b->pc, pc);
+	DBG2("translated %d instructions at %08x\n", n, b->pc);
+	return b;
+}
+
+static struct block* lookup(uint32_t pc) {
+	struct block *b = &blocks[BLOCK_CACHE_IDX(pc)];
+	if (likely((b->pc == pc) && (b->gen == blocks_gen)))
+		return b;
+	return translate(pc);
+}
+
+// Private export from state.c
+       bool state_ex_stage_take_async_exception(uint32_t next_pc);
+
+// What tick_if and tick_id leave in the pipeline registers for e
+static inline void latch(const struct block_inst *e) {
+	pre_if_PC = e->next_pc;
+	if_id_PC = e->pc + 4;
+	if_id_inst = e->inst;
+	id_ex_PC = e->pc + 4;
+	id_ex_inst = e->inst;
+	id_ex_o = e->o;
+}
+
+EXPORT int blocks_run(void) {
+	static const void *const dispatch[] = {
+		[BLOCK_END] = &&end,
+		[BLOCK_OP16] = &&op16,
+		[BLOCK_OP32] = &&op32,
+	};
+
+	if (in_ITblock())
+		return 0;
+
+	struct block *b = lookup(pre_if_PC);
+	if (b == NULL)
+		return 0;
+
+	const struct block_inst *e = b->insts;
+	int executed = 0;
+	blocks_dirty = false;
+
+	goto *dispatch[e->kind];
+
+op16:
+	if (executed && sim_break_pending())
+		goto end;
+	sim_cycle_begin();
+	latch(e);
+	state_start_tick();
+	if (!state_ex_stage_take_async_exception(e->pc))
+		e->fn16(e->inst);
+	goto retire;
+
+op32:
+	if (executed && sim_break_pending())
+		goto end;
+	sim_cycle_begin();
+	latch(e);
+	state_start_tick();
+	if (!state_ex_stage_take_async_exception(e->pc))
+		e->fn32(e->inst);
+
+retire:
+	recryptor_tick();
+	state_tock();
+	executed++;
+	if (unlikely((pre_if_PC != e->next_pc) || blocks_dirty))
+		goto end;
+	e++;
+	goto *dispatch[e->kind];
+
+end:
+	return executed;
+}
+
+#endif // BLOCK_ENGINE
@@ -0,0 +1,37 @@
+/* Mulator - An extensible {ARM} {e,si}mulator
+ * Copyright 2011-2012  Pat Pannuto <pat.pannuto@gmail.com>
+ *
+ * This file is part of Mulator.
+ *
+ * Mulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BLOCKS_H
+#define BLOCKS_H
+
+#include "common.h"
+
+#ifdef BLOCK_ENGINE
+
+// Runs the translated basic block at the current fetch PC. Returns the number
+// of instructions executed, 0 if the caller must tick the pipeline instead
+int blocks_run(void);
+
+// Drop any translation covering the word at addr
+void blocks_invalidate(uint32_t addr);
+void blocks_flush(void);
+
+#endif // BLOCK_ENGINE
+
+#endif // BLOCKS_H
@@ -0,0 +1,365 @@
+/* Mulator - An extensible {ARM} {e,si}mulator
+ * Copyright 2011-2016  Pat Pannuto <pat.pannuto@gmail.com>
+ *
+ * This file is part of Mulator.
+ *
+ * Mulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "callstack.h"
+#include "simulator.h"
+#include "symbols.h"
+
+/* Shadow call stack
+ *
+ * BL and BLX push a frame holding the return address they leave in LR. Any
+ * branch to the return address of the top frame pops it, which covers BX LR,
+ * POP {PC}, LDR PC and LDM alike, since all of them end in BranchTo. Tail
+ * calls (B to another function) stay in the caller's frame.
+ *
+ * Exception entry pushes a frame for the handler that only exception return
+ * pops, along with anything the handler left on top of it. Handlers hang off
+ * the root rather than the code they interrupted, so ISR time is reported on
+ * its own and never counts towards the interrupted function.
+ *
+ * Frames point into a calling context tree: one node per distinct chain of
+ * calls from the root, which is what folded stacks are made of. Cycles are
+ * charged to the node on top of the stack whenever the top changes. Inclusive
+ * cycles are worked out from the tree at report time, counting each subtree
+ * once however often its function recurses within it.
+ */
+
+#define CALLSTACK_MAX_DEPTH	1024
+#define CALLSTACK_NO_RETURN	0xffffffff	// Branch targets are even
+
+EXPORT int callstack_flag = 0;
+EXPORT const char *callstack_report_file = NULL;
+EXPORT const char *callstack_folded_file = NULL;
+
+struct callstack_fn {
+	uint32_t entry;
+	int exception;		// Exception number it was entered for, or 0
+	unsigned id;
+	uint64_t calls;
+	uint64_t exclusive;
+	uint64_t inclusive;	// Summed from the tree at report time
+	int on_path;		// Times on the path of the node being summed
+};
+
+struct callstack_node {
+	struct callstack_fn *fn;
+	struct callstack_node *parent;
+	struct callstack_node *child;
+	struct callstack_node *sibling;
+	uint64_t calls;
+	uint64_t cycles;
+};
+
+// Functions by entry address, open addressing, never more than half full
+static struct callstack_fn **fns;
+static unsigned fns_size;
+// And by id
+static struct callstack_fn **fn_ids;
+static unsigned fn_count;
+static unsigned fn_ids_alloc;
+
+static struct {
+	struct callstack_node *node;
+	uint32_t ret;
+} stack[CALLSTACK_MAX_DEPTH];
+static int depth;
+
+static struct callstack_fn root_fn;
+static struct callstack_node root = {&root_fn, NULL, NULL, NULL, 0, 0};
+static struct callstack_node *top = &root;
+static int64_t top_since;
+
+EXPORT unsigned callstack_current_id = 0;
+
+static void fn_register(struct callstack_fn *fn) {
+	if (fn_count == fn_ids_alloc) {
+		fn_ids_alloc = (fn_ids_alloc) ? fn_ids_alloc * 2 : 256;
+		fn_ids = realloc(fn_ids, fn_ids_alloc * sizeof(*fn_ids));
+		if (fn_ids == NULL)
+			ERR(E_UNKNOWN, "Out of memory for call stack\n");
+	}
+	fn->id = fn_count;
+	fn_ids[fn_count++] = fn;
+}
+
+static struct callstack_fn *fn_new(uint32_t entry, int exception) {
+	struct callstack_fn *fn = calloc(1, sizeof(struct callstack_fn));
+	if (fn == NULL)
+		ERR(E_UNKNOWN, "Out of memory for call stack\n");
+	fn->entry = entry;
+	fn->exception = exception;
+	fn_register(fn);
+	return fn;
+}
+
+static unsigned fn_hash(uint32_t entry) {
+	return ((entry >> 1) * 0x9e3779b1u) & (fns_size - 1);
+}
+
+// Exception handlers and functions at the same address are kept apart
+static struct callstack_fn *fn_lookup(uint32_t entry, int exception) {
+	unsigned i;
+
+	if ((fn_count * 2) >= fns_size) {
+		struct callstack_fn **old = fns;
+		unsigned old_size = fns_size;
+
+		fns_size = (fns_size) ? fns_size * 2 : 256;
+		fns = calloc(fns_size, sizeof(*fns));
+		if (fns == NULL)
+			ERR(E_UNKNOWN, "Out of memory for call stack\n");
+		for (i = 0; i < old_size; i++) {
+			if (old[i] != NULL) {
+				unsigned j = fn_hash(old[i]->entry);
+				while (fns[j] != NULL)
+					j = (j + 1) & (fns_size - 1);
+				fns[j] = old[i];
+			}
+		}
+		free(old);
+	}
+
+	i = fn_hash(entry);
+	while (fns[i] != NULL) {
+		if ((fns[i]->entry == entry) && (fns[i]->exception == exception))
+			return fns[i];
+		i = (i + 1) & (fns_size - 1);
+	}
+	fns[i] = fn_new(entry, exception);
+	return fns[i];
+}
+
+static struct callstack_node *node_child(struct callstack_node *parent,
+		struct callstack_fn *fn) {
+	struct callstack_node **link = &parent->child;
+	struct callstack_node *node;
+
+	while ((node = *link) != NULL) {
+		if (node->fn == fn) {
+			// Move to the front, the next lookup is likely the same
+			*link = node->sibling;
+			break;
+		}
+		link = &node->sibling;
+	}
+	if (node == NULL) {
+		node = calloc(1, sizeof(struct callstack_node));
+		if (node == NULL)
+			ERR(E_UNKNOWN, "Out of memory for call stack\n");
+		node->fn = fn;
+		node->parent = parent;
+	}
+	node->sibling = parent->child;
+	parent->child = node;
+	return node;
+}
+
+EXPORT void callstack_settle(void) {
+	if (cycle > top_since) {
+		top->cycles += cycle - top_since;
+		top->fn->exclusive += cycle - top_since;
+	}
+	top_since = cycle;
+}
+
+static void push(struct callstack_node *parent, struct callstack_fn *fn,
+		uint32_t ret) {
+	static bool warned = false;
+
+	if (depth == CALLSTACK_MAX_DEPTH) {
+		if (!warned) {
+			WARN("Calls nest deeper than %d, deeper calls are "
+					"counted towards their callers\n",
+					CALLSTACK_MAX_DEPTH);
+			warned = true;
+		}
+		return;
+	}
+
+	callstack_settle();
+	stack[depth].node = top;
+	stack[depth].ret = ret;
+	depth++;
+	top = node_child(parent, fn);
+	top->calls++;
+	fn->calls++;
+	callstack_current_id = fn->id;
+}
+
+static void pop(void) {
+	callstack_settle();
+	depth--;
+	top = stack[depth].node;
+	callstack_current_id = top->fn->id;
+}
+
+EXPORT void callstack_call(uint32_t target, uint32_t ret) {
+	push(top, fn_lookup(target & 0xfffffffe, 0), ret & 0xfffffffe);
+}
+
+EXPORT void callstack_branch(uint32_t target) {
+	if ((depth > 0) && (stack[depth - 1].ret == (target & 0xfffffffe)))
+		pop();
+}
+
+EXPORT void callstack_exception_enter(int type, uint32_t handler) {
+	push(&root, fn_lookup(handler & 0xfffffffe, type), CALLSTACK_NO_RETURN);
+}
+
+EXPORT void callstack_exception_exit(void) {
+	int i;
+	for (i = depth - 1; i >= 0; i--) {
+		if (stack[i].ret == CALLSTACK_NO_RETURN) {
+			while (depth > i)
+				pop();
+			return;
+		}
+	}
+}
+
+EXPORT unsigned callstack_function_count(void) {
+	return fn_count;
+}
+
+EXPORT uint64_t callstack_function_calls(unsigned id) {
+	return (id < fn_count) ? fn_ids[id]->calls : 0;
+}
+
+EXPORT uint64_t callstack_function_cycles(unsigned id) {
+	return (id < fn_count) ? fn_ids[id]->exclusive : 0;
+}
+
+static void fn_name(const struct callstack_fn *fn, char *buf, size_t len) {
+	char name[96];
+
+	if (fn == &root_fn) {
+		snprintf(buf, len, "[root]");
+		return;
+	}
+	symbols_name(fn->entry, name, sizeof(name));
+	if (fn->exception)
+		snprintf(buf, len, "exc%d:%s", fn->exception, name);
+	else
+		snprintf(buf, len, "%s", name);
+}
+
+EXPORT void callstack_function_name(unsigned id, char *buf, size_t len) {
+	fn_name((id < fn_count) ? fn_ids[id] : &root_fn, buf, len);
+}
+
+// Cycles of the subtree, adding them to the inclusive time of its function
+// unless an outer call of the same function already counts them
+static uint64_t sum_inclusive(struct callstack_node *node) {
+	struct callstack_node *child;
+	uint64_t total = node->cycles;
+
+	node->fn->on_path++;
+	for (child = node->child; child; child = child->sibling)
+		total += sum_inclusive(child);
+	node->fn->on_path--;
+
+	if (node->fn->on_path == 0)
+		node->fn->inclusive += total;
+	return total;
+}
+
+static void write_folded(FILE *fp, struct callstack_node *node,
+		char *path, size_t used, size_t len) {
+	struct callstack_node *child;
+	char name[128];
+	int n;
+
+	fn_name(node->fn, name, sizeof(name));
+	n = snprintf(path + used, len - used, "%s%s", (used) ? ";" : "", name);
+	if ((n < 0) || ((size_t) n >= len - used))
+		n = len - used - 1;	// Truncated, still one line per node
+
+	if (node->cycles)
+		fprintf(fp, "%s %" PRIu64 "\n", path, node->cycles);
+	for (child = node->child; child; child = child->sibling)
+		write_folded(fp, child, path, used + n, len);
+	path[used] = '\0';
+}
+
+static int cmp_inclusive(const void *a, const void *b) {
+	uint64_t ia = (*(struct callstack_fn * const *) a)->inclusive;
+	uint64_t ib = (*(struct callstack_fn * const *) b)->inclusive;
+	return (ia < ib) - (ia > ib);
+}
+
+EXPORT void callstack_report(void) {
+	unsigned i;
+
+	callstack_settle();
+
+	if (callstack_report_file) {
+		FILE *fp = fopen(callstack_report_file, "w");
+		if (fp == NULL) {
+			WARN("Could not open %s: %s\n", callstack_report_file,
+					strerror(errno));
+		} else {
+			struct callstack_fn **sorted = malloc(fn_count * sizeof(*sorted));
+			uint64_t total;
+
+			if (sorted == NULL)
+				ERR(E_UNKNOWN, "Out of memory for call graph\n");
+			for (i = 0; i < fn_count; i++)
+				fn_ids[i]->inclusive = 0;
+			total = sum_inclusive(&root);
+			memcpy(sorted, fn_ids, fn_count * sizeof(*sorted));
+			qsort(sorted, fn_count, sizeof(*sorted), cmp_inclusive);
+
+			fprintf(fp, "Call graph: %" PRIu64 " cycles, symbols: %s\n\n",
+					total, (symbols_file) ? symbols_file : "none");
+			fprintf(fp, "  incl%%        inclusive        exclusive"
+					"        calls  function\n");
+			for (i = 0; i < fn_count; i++) {
+				char name[128];
+				fn_name(sorted[i], name, sizeof(name));
+				fprintf(fp, "%7.2f %16" PRIu64 " %16" PRIu64
+						" %12" PRIu64 "  %s\n",
+						(total) ? 100.0 * sorted[i]->inclusive / total : 0.0,
+						sorted[i]->inclusive, sorted[i]->exclusive,
+						sorted[i]->calls, name);
+			}
+			free(sorted);
+			fclose(fp);
+			INFO("Wrote call graph of %u functions to %s\n", fn_count,
+					callstack_report_file);
+		}
+	}
+
+	if (callstack_folded_file) {
+		FILE *fp = fopen(callstack_folded_file, "w");
+		if (fp == NULL) {
+			WARN("Could not open %s: %s\n", callstack_folded_file,
+					strerror(errno));
+		} else {
+			char path[4096] = "";
+			write_folded(fp, &root, path, 0, sizeof(path));
+			fclose(fp);
+			INFO("Wrote folded stacks to %s\n", callstack_folded_file);
+		}
+	}
+}
+
+__attribute__ ((constructor))
+void register_callstack_root(void) {
+	fn_register(&root_fn);
+}
@@ -0,0 +1,67 @@
+/* Mulator - An extensible {ARM} {e,si}mulator
+ * Copyright 2011-2016  Pat Pannuto <pat.pannuto@gmail.com>
+ *
+ * This file is part of Mulator.
+ *
+ * Mulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CALLSTACK_H
+#define CALLSTACK_H
+
+#include "common.h"
+
+#ifndef PP_STRING
+#define PP_STRING "CST"
+#include "pretty_print.h"
+#endif
+
+// Whether the shadow call stack is kept. Set by the reports that need it
+extern int callstack_flag;
+extern const char *callstack_report_file;
+extern const char *callstack_folded_file;
+
+void callstack_call(uint32_t target, uint32_t ret);
+void callstack_branch(uint32_t target);
+void callstack_exception_enter(int type, uint32_t handler);
+void callstack_exception_exit(void);
+
+// Functions are numbered densely from 0, the code outside any call, so
+// other modules can keep per-function tables indexed by them
+extern unsigned callstack_current_id;
+unsigned callstack_function_count(void);
+uint64_t callstack_function_calls(unsigned id);
+uint64_t callstack_function_cycles(unsigned id);	// Exclusive
+void callstack_function_name(unsigned id, char *buf, size_t len);
+
+// Charges cycles run so far to the current function. Done by every report
+void callstack_settle(void);
+
+// Writes the requested reports
+void callstack_report(void);
+
+#define CALLSTACK_CALL(_target, _ret) do {\
+	if (callstack_flag) callstack_call(_target, _ret);\
+} while (0)
+#define CALLSTACK_BRANCH(_target) do {\
+	if (callstack_flag) callstack_branch(_target);\
+} while (0)
+#define CALLSTACK_EXCEPTION_ENTER(_type, _handler) do {\
+	if (callstack_flag) callstack_exception_enter(_type, _handler);\
+} while (0)
+#define CALLSTACK_EXCEPTION_EXIT() do {\
+	if (callstack_flag) callstack_exception_exit();\
+} while (0)
+
+#endif // CALLSTACK_H
@@ -19,3 +19,4 @@
 
 int CONF_no_terminate;
 int CONF_rzwi_memory;
+int CONF_pin_stages;
@@ -22,5 +22,6 @@
 
 extern int CONF_no_terminate;
 extern int CONF_rzwi_memory;
+extern int CONF_pin_stages;
 
 #endif // CONF_H
@@ -0,0 +1,127 @@
+/* Mulator - An extensible {ARM} {e,si}mulator
+ * Copyright 2011-2016  Pat Pannuto <pat.pannuto@gmail.com>
+ *
+ * This file is part of Mulator.
+ *
+ * Mulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dirty.h"
+
+/* Dirty page tracking
+ *
+ * RAM and ROM keep a bitmap with one bit per page, set by their write
+ * handlers on every store. Until something asks for it the bitmap is not
+ * allocated and a store pays one never-taken branch. Once tracking is on,
+ * plain stores give up the host-pointer shortcut in the core and take the
+ * handler path, which is what marks them; the shortcut is kept for loads.
+ *
+ * Flashing an image does not mark anything, the bitmap shows what the
+ * program itself changed.
+ */
+
+#define DIRTY_DEFAULT_SHIFT	8	// 256 byte pages
+
+EXPORT int dirty_tracking = 0;
+EXPORT unsigned dirty_page_shift = DIRTY_DEFAULT_SHIFT;
+EXPORT const char *dirty_report_file = NULL;
+
+static struct dirty_map *maps;
+
+EXPORT void dirty_register(struct dirty_map *d) {
+	d->next = maps;
+	maps = d;
+}
+
+EXPORT void dirty_set_page_size(unsigned bytes) {
+	unsigned shift = 0;
+
+	if ((bytes < 4) || (bytes & (bytes - 1)))
+		ERR(E_UNKNOWN, "Page size %u is not a power of two of at least 4\n",
+				bytes);
+	while ((1U << shift) < bytes)
+		shift++;
+	if (dirty_tracking && (shift != dirty_page_shift))
+		ERR(E_UNKNOWN, "Page size cannot change once tracking is on\n");
+	dirty_page_shift = shift;
+}
+
+EXPORT void dirty_enable(void) {
+	struct dirty_map *d;
+
+	if (dirty_tracking)
+		return;
+	for (d = maps; d; d = d->next) {
+		d->pages = ((uint64_t) d->size + (1U << dirty_page_shift) - 1) >>
+			dirty_page_shift;
+		d->bits = calloc((d->pages + 63) / 64, sizeof(uint64_t));
+		if (d->bits == NULL)
+			ERR(E_UNKNOWN, "Out of memory for %s dirty pages\n", d->name);
+	}
+	dirty_tracking = true;
+}
+
+EXPORT unsigned dirty_count(const struct dirty_map *d) {
+	unsigned i, n = 0;
+
+	if (d->bits == NULL)
+		return 0;
+	for (i = 0; i < (d->pages + 63) / 64; i++)
+		n += __builtin_popcountll(d->bits[i]);
+	return n;
+}
+
+static void report_map(FILE *fp, const struct dirty_map *d) {
+	unsigned page = 0;
+	unsigned n = dirty_count(d);
+
+	fprintf(fp, "%s %08x-%08x: %u of %u page%s written\n", d->name,
+			d->bot, d->bot + d->size - 1, n, d->pages,
+			(d->pages == 1) ? "" : "s");
+
+	while (page < d->pages) {
+		unsigned first;
+
+		if (!dirty_page_test(d, page)) {
+			page++;
+			continue;
+		}
+		first = page;
+		while ((page < d->pages) && dirty_page_test(d, page))
+			page++;
+
+		fprintf(fp, "\t%08x-%08x  %u page%s\n",
+				d->bot + (first << dirty_page_shift),
+				d->bot + (uint32_t) MIN((uint64_t) page << dirty_page_shift,
+					d->size) - 1,
+				page - first, (page - first == 1) ? "" : "s");
+	}
+}
+
+EXPORT void dirty_report(void) {
+	const struct dirty_map *d;
+	FILE *fp;
+
+	fp = fopen(dirty_report_file, "w");
+	if (fp == NULL) {
+		WARN("Could not open %s: %s\n", dirty_report_file,
+				strerror(errno));
+		return;
+	}
+	fprintf(fp, "Pages written, %u bytes each\n\n", 1U << dirty_page_shift);
+	for (d = maps; d; d = d->next)
+		report_map(fp, d);
+	fclose(fp);
+	INFO("Wrote dirty page report to %s\n", dirty_report_file);
+}
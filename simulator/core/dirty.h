@@ -0,0 +1,74 @@
+/* Mulator - An extensible {ARM} {e,si}mulator
+ * Copyright 2011-2016  Pat Pannuto <pat.pannuto@gmail.com>
+ *
+ * This file is part of Mulator.
+ *
+ * Mulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DIRTY_H
+#define DIRTY_H
+
+#include "common.h"
+
+#ifndef PP_STRING
+#define PP_STRING "DRT"
+#include "pretty_print.h"
+#endif
+
+// The pages of one host-backed memory (RAM, ROM) that have been stored to
+struct dirty_map {
+	struct dirty_map *next;
+	const char *name;
+	uint32_t bot;
+	uint32_t size;		// In bytes
+	unsigned pages;
+	uint64_t *bits;		// NULL until dirty_enable
+};
+
+// Set by dirty_enable. Host-pointer stores are turned off while it is, so
+// that every store to tracked memory reaches a handler that marks it
+extern int dirty_tracking;
+extern unsigned dirty_page_shift;	// log2 of the page size
+extern const char *dirty_report_file;
+
+// Called by memories as they register, before main
+void dirty_register(struct dirty_map *d);
+
+// Sets the page size (a power of two, at least a word)
+void dirty_set_page_size(unsigned bytes);
+
+// Starts tracking every registered memory. Consumers call this before the
+// simulation starts, the core's TLBs are not flushed
+void dirty_enable(void);
+
+// Called by the write handlers of registered memories for every store
+static inline void dirty_mark(struct dirty_map *d, uint32_t addr) {
+	if (d->bits) {
+		uint32_t page = (addr - d->bot) >> dirty_page_shift;
+		d->bits[page >> 6] |= UINT64_C(1) << (page & 63);
+	}
+}
+
+static inline bool dirty_page_test(const struct dirty_map *d, unsigned page) {
+	return (d->bits) && (d->bits[page >> 6] & (UINT64_C(1) << (page & 63)));
+}
+
+// Pages of d stored to so far
+unsigned dirty_count(const struct dirty_map *d);
+
+// Writes the address ranges stored to in each memory to dirty_report_file
+void dirty_report(void);
+
+#endif // DIRTY_H
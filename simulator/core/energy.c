@@ -0,0 +1,408 @@
+/* Mulator - An extensible {ARM} {e,si}mulator
+ * Copyright 2011-2016  Pat Pannuto <pat.pannuto@gmail.com>
+ *
+ * This file is part of Mulator.
+ *
+ * Mulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "energy.h"
+#include "simulator.h"
+#include "callstack.h"
+
+#ifdef RECRYPTOR_DECODER_ADDR
+#include "cpu/recryptor/recryptor.h"
+#endif
+
+#include <ctype.h>
+
+#ifdef HAVE_ENERGY
+
+/* Energy estimation
+ *
+ * Execution only counts events; nothing is multiplied out until the report.
+ * Every cycle costs model.cycle, and the events the timing model already
+ * charges (loads, stores, refills, multiplies, ...) add their class's cost on
+ * top. Data accesses also cost the read or write energy of the memory region
+ * they fall in, and recryptor operations cost per word they compute.
+ *
+ * Sleep costs model.sleep_uw for every simulated cycle between a WFI and its
+ * wakeup, with a clock period of 1 / model.clock_mhz, never for host time.
+ * The core runs no cycles while it waits for the host thread that raises the
+ * wakeup interrupt, so a WFI currently adds no sleep cycles.
+ *
+ * Counts are kept per function of the shadow call stack (callstack.c), which
+ * --energy turns on, so the report can say where energy went. Exception
+ * handlers are functions of their own, as are the things they call.
+ *
+ * The numbers built in here and in each memmap.h are placeholders of the
+ * right order for a small Cortex-M0 class core, not measurements of any chip.
+ * Measured numbers go in a file passed to --energy-model, which overrides
+ * them by name:
+ *
+ *   # comments and blank lines are ignored
+ *   cycle = 10.0          pJ every cycle
+ *   load = 3.0            pJ per event of a class (see class_names)
+ *   read.SRAM = 2.0       pJ per word read from a MEMMAP_ENERGY_REGIONS region
+ *   write.SRAM = 2.5      pJ per word written
+ *   recryptor = 1.0       pJ per word of every recryptor operation
+ *   recryptor.XOR = 0.8   pJ per word of one recryptor operation (OpNames,
+ *                         only on platforms with a recryptor)
+ *   sleep_uw = 0.01       uW while asleep
+ *   clock_mhz = 1.0       MHz, the length of a cycle spent asleep
+ *
+ * Counts are not part of the replay history: cycles executed again after a
+ * seek backwards are counted again.
+ */
+
+#ifndef MEMMAP_ENERGY_REGIONS
+#error "memmap.h must declare MEMMAP_ENERGY_REGIONS to build with HAVE_ENERGY"
+#endif
+
+// The recryptor op field is 4 bits
+#define ENERGY_RECRYPTOR_OPS	16
+#define ENERGY_MAX_REGIONS	8
+
+EXPORT int energy_flag = 0;
+EXPORT const char *energy_report_file = NULL;
+
+static const char *class_names[ENERGY_NCLASS] = {
+	[ENERGY_LOAD] = "load",
+	[ENERGY_STORE] = "store",
+	[ENERGY_MULTIPLE] = "multiple",
+	[ENERGY_BRANCH] = "branch",
+	[ENERGY_MUL] = "mul",
+	[ENERGY_MLA] = "mla",
+	[ENERGY_MULL] = "mull",
+	[ENERGY_DIV] = "div",
+};
+
+static struct {
+	const char *file;	// NULL for the built-in model
+	double cycle;
+	double events[ENERGY_NCLASS];
+	double recryptor[ENERGY_RECRYPTOR_OPS];
+	double sleep_uw;
+	double clock_mhz;
+} model = {
+	.file = NULL,
+	.cycle = 10.0,
+	.events = {
+		[ENERGY_LOAD] = 3.0,
+		[ENERGY_STORE] = 3.5,
+		[ENERGY_MULTIPLE] = 3.0,
+		[ENERGY_BRANCH] = 2.0,
+		[ENERGY_MUL] = 2.0,
+		[ENERGY_MLA] = 2.5,
+		[ENERGY_MULL] = 5.0,
+		[ENERGY_DIV] = 8.0,
+	},
+	.recryptor = {
+		1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0,
+		1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0,
+	},
+	.sleep_uw = 0.01,
+	.clock_mhz = 1.0,
+};
+
+// The last entry catches everything else (peripherals) and costs nothing
+static struct {
+	const char *name;
+	uint32_t bot;
+	uint32_t top;
+	double read;
+	double write;
+} regions[] = {
+	MEMMAP_ENERGY_REGIONS
+	{"other", 0, 0, 0.0, 0.0},
+};
+#define ENERGY_NREGIONS	((int) (sizeof(regions) / sizeof(regions[0])))
+_Static_assert(sizeof(regions) / sizeof(regions[0]) <= ENERGY_MAX_REGIONS,
+		"Too many MEMMAP_ENERGY_REGIONS");
+
+struct energy_counts {
+	uint64_t cycles;	// Filled in from the call stack at report time
+	uint64_t events[ENERGY_NCLASS];
+	uint64_t reads[ENERGY_MAX_REGIONS];
+	uint64_t writes[ENERGY_MAX_REGIONS];
+	uint64_t recryptor[ENERGY_RECRYPTOR_OPS];
+};
+
+// By call stack function id, grown as functions are found
+static struct energy_counts *counts;
+static unsigned counts_alloc;
+
+static uint64_t sleeps;
+static uint64_t sleep_cycles;
+static int64_t sleep_start;
+
+static void counts_grow(unsigned n) {
+	unsigned old = counts_alloc;
+
+	counts_alloc = (counts_alloc) ? counts_alloc : 256;
+	while (n > counts_alloc)
+		counts_alloc *= 2;
+	counts = realloc(counts, counts_alloc * sizeof(*counts));
+	if (counts == NULL)
+		ERR(E_UNKNOWN, "Out of memory for energy counts\n");
+	memset(counts + old, 0, (counts_alloc - old) * sizeof(*counts));
+}
+
+static struct energy_counts *current(void) {
+	if (callstack_current_id >= counts_alloc)
+		counts_grow(callstack_current_id + 1);
+	return &counts[callstack_current_id];
+}
+
+EXPORT void energy_event(enum energy_class cls, int count) {
+	current()->events[cls] += count;
+}
+
+EXPORT void energy_access(uint32_t addr, bool write, int count) {
+	int i;
+	for (i = 0; i < ENERGY_NREGIONS - 1; i++)
+		if ((addr >= regions[i].bot) && (addr < regions[i].top))
+			break;
+	if (write)
+		current()->writes[i] += count;
+	else
+		current()->reads[i] += count;
+}
+
+EXPORT void energy_recryptor(int op, int words) {
+	current()->recryptor[op & (ENERGY_RECRYPTOR_OPS - 1)] += words;
+}
+
+EXPORT void energy_sleep(void) {
+	sleep_start = cycle;
+	sleeps++;
+}
+
+EXPORT void energy_wakeup(void) {
+	sleep_cycles += cycle - sleep_start;
+}
+
+static bool model_set(const char *key, double val) {
+	int i;
+
+	if (0 == strcmp(key, "cycle")) {
+		model.cycle = val;
+		return true;
+	}
+	if (0 == strcmp(key, "sleep_uw")) {
+		model.sleep_uw = val;
+		return true;
+	}
+	if (0 == strcmp(key, "clock_mhz")) {
+		if (val <= 0)
+			return false;
+		model.clock_mhz = val;
+		return true;
+	}
+	if (0 == strcmp(key, "recryptor")) {
+		for (i = 0; i < ENERGY_RECRYPTOR_OPS; i++)
+			model.recryptor[i] = val;
+		return true;
+	}
+	for (i = 0; i < ENERGY_NCLASS; i++) {
+		if (0 == strcmp(key, class_names[i])) {
+			model.events[i] = val;
+			return true;
+		}
+	}
+	for (i = 0; i < ENERGY_NREGIONS; i++) {
+		if ((0 == strncmp(key, "read.", 5)) &&
+				(0 == strcmp(key + 5, regions[i].name))) {
+			regions[i].read = val;
+			return true;
+		}
+		if ((0 == strncmp(key, "write.", 6)) &&
+				(0 == strcmp(key + 6, regions[i].name))) {
+			regions[i].write = val;
+			return true;
+		}
+	}
+#ifdef RECRYPTOR_DECODER_ADDR
+	if (0 == strncmp(key, "recryptor.", 10)) {
+		for (i = AN; i <= InvalidOp; i++) {
+			if (0 == strcmp(key + 10, OpNames[i - 1])) {
+				model.recryptor[i] = val;
+				return true;
+			}
+		}
+	}
+#endif
+	return false;
+}
+
+EXPORT void energy_load_model(const char *file) {
+	FILE *fp = fopen(file, "r");
+	if (fp == NULL)
+		ERR(E_UNKNOWN, "Could not open energy model %s: %s\n",
+				file, strerror(errno));
+
+	char line[256];
+	int lineno = 0;
+	while (fgets(line, sizeof(line), fp)) {
+		char key[64];
+		double val;
+		char *p;
+
+		lineno++;
+		line[strcspn(line, "\n")] = '\0';
+		if ((p = strchr(line, '#')) != NULL)
+			*p = '\0';
+		for (p = line; isspace(*p); p++)
+			;
+		if (*p == '\0')
+			continue;
+
+		if ((2 != sscanf(p, "%63[^= \t] = %lf", key, &val)) ||
+				!model_set(key, val))
+			ERR(E_UNKNOWN, "%s:%d: Bad energy model line: %s\n",
+					file, lineno, line);
+	}
+	fclose(fp);
+
+	model.file = file;
+}
+
+struct energy_split {
+	double core;		// Cycles and instruction classes
+	double memory;
+	double recryptor;
+};
+
+static struct energy_split energy_of(const struct energy_counts *c) {
+	struct energy_split e = {0, 0, 0};
+	int i;
+
+	e.core = c->cycles * model.cycle;
+	for (i = 0; i < ENERGY_NCLASS; i++)
+		e.core += c->events[i] * model.events[i];
+	for (i = 0; i < ENERGY_NREGIONS; i++)
+		e.memory += c->reads[i] * regions[i].read +
+			c->writes[i] * regions[i].write;
+	for (i = 0; i < ENERGY_RECRYPTOR_OPS; i++)
+		e.recryptor += c->recryptor[i] * model.recryptor[i];
+	return e;
+}
+
+static double total_of(struct energy_split e) {
+	return e.core + e.memory + e.recryptor;
+}
+
+static int cmp_energy(const void *a, const void *b) {
+	double ea = total_of(energy_of(&counts[*(const unsigned *) a]));
+	double eb = total_of(energy_of(&counts[*(const unsigned *) b]));
+	return (ea < eb) - (ea > eb);
+}
+
+EXPORT void energy_report(void) {
+	struct energy_counts run;
+	unsigned *sorted;
+	unsigned i, n;
+	int j;
+
+	callstack_settle();
+	n = callstack_function_count();
+	if (n > counts_alloc)
+		counts_grow(n);
+
+	// Every function, sorted by energy
+	sorted = malloc(n * sizeof(*sorted));
+	if (sorted == NULL)
+		ERR(E_UNKNOWN, "Out of memory for energy report\n");
+	for (i = 0; i < n; i++) {
+		counts[i].cycles = callstack_function_cycles(i);
+		sorted[i] = i;
+	}
+	qsort(sorted, n, sizeof(*sorted), cmp_energy);
+
+	memset(&run, 0, sizeof(run));
+	for (i = 0; i < n; i++) {
+		const struct energy_counts *c = &counts[i];
+		run.cycles += c->cycles;
+		for (j = 0; j < ENERGY_NCLASS; j++)
+			run.events[j] += c->events[j];
+		for (j = 0; j < ENERGY_NREGIONS; j++) {
+			run.reads[j] += c->reads[j];
+			run.writes[j] += c->writes[j];
+		}
+		for (j = 0; j < ENERGY_RECRYPTOR_OPS; j++)
+			run.recryptor[j] += c->recryptor[j];
+	}
+
+	struct energy_split e = energy_of(&run);
+	// uW over us is pJ
+	double sleep_pj = model.sleep_uw * sleep_cycles / model.clock_mhz;
+	double total = total_of(e) + sleep_pj;
+
+	INFO("Energy model: %s\n", (model.file) ? model.file :
+			"built-in placeholders (see --energy-model)");
+	INFO("Energy: %.1f pJ over %" PRIu64 " cycles (%.2f pJ/cycle active)\n",
+			total, run.cycles,
+			(run.cycles) ? total_of(e) / run.cycles : 0.0);
+	INFO("  core %.1f pJ, memory %.1f pJ, recryptor %.1f pJ, "
+			"sleep %.1f pJ (%" PRIu64 " cycles in %" PRIu64 " sleep%s)\n",
+			e.core, e.memory, e.recryptor, sleep_pj,
+			sleep_cycles, sleeps, (sleeps == 1) ? "" : "s");
+	for (j = 0; j < ENERGY_NREGIONS; j++) {
+		if (run.reads[j] || run.writes[j])
+			INFO("  %-6s %" PRIu64 " word reads, %" PRIu64
+					" word writes\n", regions[j].name,
+					run.reads[j], run.writes[j]);
+	}
+
+	for (i = 0; i < n && i < 10; i++) {
+		char name[64];
+		double fe = total_of(energy_of(&counts[sorted[i]]));
+		if (fe <= 0)
+			break;
+		callstack_function_name(sorted[i], name, sizeof(name));
+		INFO("  %-24s %12.1f pJ %5.1f%%\n", name, fe,
+				(total > 0) ? 100 * fe / total : 0.0);
+	}
+
+	if (energy_report_file) {
+		FILE *fp = fopen(energy_report_file, "w");
+		if (fp == NULL) {
+			WARN("Could not open %s: %s\n", energy_report_file,
+					strerror(errno));
+		} else {
+			fprintf(fp, "# function\tcalls\tcycles\tcore_pJ\t"
+					"memory_pJ\trecryptor_pJ\ttotal_pJ\n");
+			for (i = 0; i < n; i++) {
+				char name[128];
+				struct energy_split fe = energy_of(&counts[sorted[i]]);
+				callstack_function_name(sorted[i], name, sizeof(name));
+				fprintf(fp, "%s\t%" PRIu64 "\t%" PRIu64
+						"\t%.1f\t%.1f\t%.1f\t%.1f\n",
+						name, callstack_function_calls(sorted[i]),
+						counts[sorted[i]].cycles,
+						fe.core, fe.memory, fe.recryptor,
+						total_of(fe));
+			}
+			fprintf(fp, "# sleep\t%" PRIu64 "\t-\t-\t-\t-\t%.1f\n",
+					sleeps, sleep_pj);
+			fclose(fp);
+			INFO("Wrote energy of %u functions to %s\n", n,
+					energy_report_file);
+		}
+	}
+
+	free(sorted);
+}
+
+#endif // HAVE_ENERGY
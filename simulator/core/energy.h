@@ -0,0 +1,91 @@
+/* Mulator - An extensible {ARM} {e,si}mulator
+ * Copyright 2011-2016  Pat Pannuto <pat.pannuto@gmail.com>
+ *
+ * This file is part of Mulator.
+ *
+ * Mulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ENERGY_H
+#define ENERGY_H
+
+#include "common.h"
+
+#ifndef PP_STRING
+#define PP_STRING "NRG"
+#include "pretty_print.h"
+#endif
+
+#ifdef HAVE_ENERGY
+
+// Instruction classes that cost energy beyond an ordinary cycle
+enum energy_class {
+	ENERGY_LOAD,
+	ENERGY_STORE,
+	ENERGY_MULTIPLE,	// Each register of LDM/STM/PUSH/POP/LDRD/STRD
+	ENERGY_BRANCH,		// Each pipeline refill
+	ENERGY_MUL,
+	ENERGY_MLA,
+	ENERGY_MULL,
+	ENERGY_DIV,
+	ENERGY_NCLASS
+};
+
+extern int energy_flag;
+extern const char *energy_report_file;
+
+// Reads cost overrides (`key = value` lines) from file
+void energy_load_model(const char *file);
+
+void energy_event(enum energy_class cls, int count);
+void energy_access(uint32_t addr, bool write, int count);
+// words is how many words the operation computes over all of its banks
+void energy_recryptor(int op, int words);
+void energy_sleep(void);
+void energy_wakeup(void);
+
+// Prints the run summary and writes the per-function report
+void energy_report(void);
+
+#define ENERGY_EVENT(_cls, _count) do {\
+	if (energy_flag) energy_event(_cls, _count);\
+} while (0)
+#define ENERGY_READ(_addr, _count) do {\
+	if (energy_flag) energy_access(_addr, false, _count);\
+} while (0)
+#define ENERGY_WRITE(_addr, _count) do {\
+	if (energy_flag) energy_access(_addr, true, _count);\
+} while (0)
+#define ENERGY_RECRYPTOR(_op, _words) do {\
+	if (energy_flag) energy_recryptor(_op, _words);\
+} while (0)
+#define ENERGY_SLEEP() do {\
+	if (energy_flag) energy_sleep();\
+} while (0)
+#define ENERGY_WAKEUP() do {\
+	if (energy_flag) energy_wakeup();\
+} while (0)
+
+#else
+
+#define ENERGY_EVENT(...)
+#define ENERGY_READ(...)
+#define ENERGY_WRITE(...)
+#define ENERGY_RECRYPTOR(...)
+#define ENERGY_SLEEP(...)
+#define ENERGY_WAKEUP(...)
+
+#endif // HAVE_ENERGY
+
+#endif // ENERGY_H
@@ -25,6 +25,8 @@
 
 #include "simulator.h"
 #include "opcodes.h"
+#include "profile.h"
+#include "trace.h"
 
 #include "cpu/core.h"
 #include "cpu/registers.h"
@@ -38,6 +40,10 @@ static void execute(struct op *o, uint32_t inst) {
 	if (decompile_flag)
 		decompile_ran = false;
 #endif
+	if (pairstats_file && (id_ex_PC != STALL_PC))
+		opcode_pairs_count(o);
+	if ((profile_file || profile_callgrind_file) && (id_ex_PC != STALL_PC))
+		profile_count(id_ex_PC - 4, o->is16);
 	if (o->is16)
 		o->op16.fn(inst);
 	else
@@ -73,6 +79,7 @@ static void tick_ex(void) {
 						cycle, id_ex_PC - 4, inst, o->name,
 						"ITSTATE {executed}");
 			}
+			TRACE_EXEC(TRACE_EXEC_IT, id_ex_PC - 4, inst, o);
 			execute(o, inst);
 		} else {
 			if (printcycles) {
@@ -81,6 +88,7 @@ static void tick_ex(void) {
 						cycle, id_ex_PC - 4, inst, o->name,
 						"ITSTATE {skipped}");
 			}
+			TRACE_EXEC(TRACE_SKIP_IT, id_ex_PC - 4, inst, o);
 #ifdef HAVE_DECOMPILE
 			extern int decompile_flag;
 			if (decompile_flag) {
@@ -103,6 +111,12 @@ static void tick_ex(void) {
 						inst, o->name);
 			}
 		}
+		if (trace_flag) {
+			if ((id_ex_PC == STALL_PC) && (inst == INST_NOP))
+				trace_exec(TRACE_STALL, id_ex_PC - 4, inst, NULL);
+			else
+				trace_exec(TRACE_EXEC, id_ex_PC - 4, inst, o);
+		}
 		execute(o, inst);
 	}
 
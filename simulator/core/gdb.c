@@ -305,7 +305,11 @@ static bool _wait_for_gdb(void) {
 #ifdef HAVE_REPLAY
 			if (cmd[1] == 's') {
 				if (cycle > 0) {
-					if (simulator_state_seek(cycle - 1)) {
+					// Instructions that take more than one cycle are
+					// stepped back over whole, landing before cycle - 1
+					int64_t from = cycle;
+					simulator_state_seek(cycle - 1);
+					if (cycle >= from) {
 						gdb_send_message("E00");
 						return true;
 					} else {
@@ -25,9 +25,70 @@
 
 #include "simulator.h"
 #include "opcodes.h"
+#include "blocks.h"
 
 #include "cpu/core.h"
 
+// Decoded instruction cache. Direct-mapped on PC; an entry is only a hit if
+// both the PC and the fetched instruction word match, so a stale entry can
+// never produce a wrong decode, the invalidation below just keeps the cache
+// from holding onto dead code.
+#define DECODE_CACHE_BITS 12
+#define DECODE_CACHE_SIZE (1 << DECODE_CACHE_BITS)
+#define DECODE_CACHE_IDX(_pc) (((_pc) >> 1) & (DECODE_CACHE_SIZE - 1))
+#define DECODE_CACHE_INVALID_PC 0xffffffff
+
+struct decode_cache_entry {
+	uint32_t pc;
+	uint32_t inst;
+	struct op *o;
+};
+
+static struct decode_cache_entry decode_cache[DECODE_CACHE_SIZE];
+
+__attribute__ ((constructor))
+static void decode_cache_init(void) {
+	for (int i = 0; i < DECODE_CACHE_SIZE; i++)
+		decode_cache[i].pc = DECODE_CACHE_INVALID_PC;
+}
+
+static void decode_cache_invalidate_pc(uint32_t pc) {
+	struct decode_cache_entry *e = &decode_cache[DECODE_CACHE_IDX(pc)];
+	if (e->pc == pc)
+		e->pc = DECODE_CACHE_INVALID_PC;
+}
+
+EXPORT void decode_cache_invalidate(uint32_t addr) {
+	addr &= ~0x3;
+	// A 32-bit instruction starting in the previous halfword also spans
+	// this word
+	decode_cache_invalidate_pc(addr - 2);
+	decode_cache_invalidate_pc(addr);
+	decode_cache_invalidate_pc(addr + 2);
+#ifdef BLOCK_ENGINE
+	blocks_invalidate(addr);
+#endif
+}
+
+EXPORT void decode_cache_flush(void) {
+	decode_cache_init();
+#ifdef BLOCK_ENGINE
+	blocks_flush();
+#endif
+}
+
+static struct op* decode_cache_lookup(uint32_t pc, uint32_t inst) {
+	struct decode_cache_entry *e = &decode_cache[DECODE_CACHE_IDX(pc)];
+	if (likely((e->pc == pc) && (e->inst == inst)))
+		return e->o;
+
+	struct op *o = find_op(inst);
+	e->pc = pc;
+	e->inst = inst;
+	e->o = o;
+	return o;
+}
+
 static void tick_id(void) {
 	DBG2("start\n");
 
@@ -35,7 +96,7 @@ static void tick_id(void) {
 	struct op* o;
 	uint32_t inst = if_id_inst;
 
-	o = find_op(if_id_inst);
+	o = decode_cache_lookup(if_id_PC, inst);
 	if (NULL == o) {
 		WARN("No handler registered for inst %x\n", inst);
 		CORE_ERR_illegal_instr(inst);
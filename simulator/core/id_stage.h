@@ -22,4 +22,8 @@
 
 #include "common.h"
 
+// Drop any cached decode of the instruction(s) overlapping the word at addr
+void decode_cache_invalidate(uint32_t addr);
+void decode_cache_flush(void);
+
 #endif //ID_STAGE_H
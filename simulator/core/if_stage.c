@@ -23,6 +23,7 @@
 #include "pipeline.h"
 #include "opcodes.h"
 #include "state_sync.h"
+#include "trace.h"
 
 #include "cpu/core.h"
 #include "cpu/registers.h"
@@ -158,6 +159,8 @@ static void tick_if(void) {
 				branch_target_forward16(SR(&pre_if_PC) + 4, inst, &pc);
 		}
 
+		TRACE_FETCH(SR(&pre_if_PC), inst);
+
 		// A5.1.2 p153
 		// use of 0b1111 as a register specifier
 		// reading PC must *always* return inst addr + 4
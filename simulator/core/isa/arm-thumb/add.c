@@ -31,7 +31,7 @@ static void adc_reg_t1(uint16_t inst) {
 
 	OP_DECOMPILE("ADC<IT> <Rdn>,<Rm>", rdn, rm);
 
-	return adc_reg(rdn, rdn, rm, setflags, SRType_LSL, 0);
+	return adc_reg_lo(rdn, rdn, rm, setflags);
 }
 
 // arm-thumb
@@ -68,7 +68,7 @@ static void add_reg_t1(uint16_t inst) {
 	bool setflags = !in_ITblock();
 
 	OP_DECOMPILE("ADD<IT> <Rd>,<Rn>,<Rm>", rd, rn, rm);
-	return add_reg(rd, rn, rm, setflags, SRType_LSL, 0);
+	return add_reg_lo(rd, rn, rm, setflags);
 }
 
 // arm-thumb
@@ -80,12 +80,8 @@ static void add_reg_t2(uint16_t inst) {
 		CORE_ERR_not_implemented("add_reg_t2 -> SP+reg\n");
 
 	// d = UInt(DN:Rdn); n = d; m = UInt(Rm);
+	// setflags = FALSE; (shift_t, shift_n) = (SRType_LSL, 0);
 	uint8_t rn = rd;
-	bool setflags = false;
-
-	enum SRType shift_t;
-	uint8_t shift_n;
-	DecodeImmShift(SRType_LSL, 0, &shift_t, &shift_n);
 
 	if ((rd == 15) && (rm == 15))
 		CORE_ERR_unpredictable("add_reg_t2\n");
@@ -94,7 +90,7 @@ static void add_reg_t2(uint16_t inst) {
 		CORE_ERR_unpredictable("add_reg_t2 it\n");
 
 	OP_DECOMPILE("ADD<c> <Rdn>,<Rm>", rd, rm);
-	return add_reg(rd, rn, rm, setflags, shift_t, shift_n);
+	return add_reg_hi(rd, rn, rm);
 }
 
 // arm-thumb
@@ -181,7 +177,11 @@ static void register_opcodes_arm_thumb_add(void) {
 	register_opcode_mask_16(0x1800, 0xe600, add_reg_t1);
 
 	// add_reg_t2: 0100 0100 <x's>
-	register_opcode_mask_16(0x4400, 0xbb00, add_reg_t2);
+	//  (except add_sp_plus_reg_t1 / add_sp_plus_reg_t2, below)
+	register_opcode_mask_16_ex(0x4400, 0xbb00, add_reg_t2,
+			0x68, 0x10,
+			0x85, 0x02,
+			0, 0);
 
 	// add_sp_plus_imm_t1: 1010 1<x's>
 	register_opcode_mask_16(0xa800, 0x5000, add_sp_plus_imm_t1);
@@ -27,11 +27,8 @@ static void cmn_reg_t1(uint16_t inst) {
 	uint8_t rn = inst & 0x7;
 	uint8_t rm = (inst >> 3) & 0x7;
 
-	enum SRType shift_t = SRType_LSL;
-	uint8_t shift_n = 0;
-
 	OP_DECOMPILE("CMN<c> <Rn>,<Rm>", rn, rm);
-	return cmn_reg(rn, rm, shift_t, shift_n);
+	return cmn_reg_lo(rn, rm);
 }
 
 // arm-thumb
@@ -51,7 +48,7 @@ static void cmp_reg_t1(uint16_t inst) {
 	uint8_t rm = (inst >> 3) & 0x7;
 
 	OP_DECOMPILE("CMP<c> <Rn>,<Rm>", rn, rm);
-	return cmp_reg(rn, rm, SRType_LSL, 0);
+	return cmp_reg_lo(rn, rm);
 }
 
 // arm-thumb
@@ -80,11 +77,8 @@ static void tst_reg_t1(uint16_t inst) {
 	uint8_t rn = inst & 0x7;
 	uint8_t rm = (inst >> 3) & 0x7;
 
-	enum SRType shift_t = SRType_LSL;
-	uint8_t shift_n = 0;
-
 	OP_DECOMPILE("TST<c> <Rn>,<Rm>", rn, rm);
-	return tst_reg(rn, rm, shift_t, shift_n);
+	return tst_reg_lo(rn, rm);
 }
 
 __attribute__ ((constructor))
@@ -21,13 +21,9 @@
 #include "core/isa/decode_helpers.h"
 
 #include "core/operations/ldr.h"
-#include "core/simulator.h"
 
 // arm-thumb
 static void ldr_imm_t1(uint16_t inst) {
-	//# cycles of Load: 2
-	cycle++;
-
 	uint8_t rt = inst & 0x7;
 	uint8_t rn = (inst >> 3) & 0x7;
 	uint8_t imm5 = (inst >> 6) & 0x1f;
@@ -43,9 +39,6 @@ static void ldr_imm_t1(uint16_t inst) {
 
 // arm-thumb
 static void ldr_imm_t2(uint16_t inst) {
-	//# cycles of Load: 2
-	cycle++;
-
 	uint8_t imm8 = inst & 0xff;
 	uint8_t rt   = (inst >> 8) & 0x7;
 
@@ -61,9 +54,6 @@ static void ldr_imm_t2(uint16_t inst) {
 
 // arm-thumb
 static void ldr_reg_t1(uint16_t inst) {
-	//# cycles of Load: 2
-	cycle++;
-
 	uint8_t rt = inst & 0x7;
 	uint8_t rn = (inst >> 3) & 0x7;
 	uint8_t rm = (inst >> 6) & 0x7;
@@ -80,9 +70,6 @@ static void ldr_reg_t1(uint16_t inst) {
 
 // arm-thumb
 static void ldr_lit_t1(uint16_t inst) {
-	//# cycles of Load: 2
-	cycle++;
-
 	uint32_t imm8 = inst & 0xff;
 	uint8_t rt = (inst & 0x700) >> 8;
 
@@ -94,9 +81,6 @@ static void ldr_lit_t1(uint16_t inst) {
 
 // arm-thumb
 static void ldrb_imm_t1(uint16_t inst) {
-	//# cycles of Load: 2
-	cycle++;
-
 	uint8_t rt = inst & 0x7;
 	uint8_t rn = (inst >> 3) & 0x7;
 	uint8_t imm5 = (inst >> 6) & 0x1f;
@@ -112,9 +96,6 @@ static void ldrb_imm_t1(uint16_t inst) {
 
 // arm-thumb
 static void ldrb_reg_t1(uint16_t inst) {
-	//# cycles of Load: 2
-	cycle++;
-
 	uint8_t rt = inst & 0x7;
 	uint8_t rn = (inst >> 3) & 0x7;
 	uint8_t rm = (inst >> 6) & 0x7;
@@ -132,9 +113,6 @@ static void ldrb_reg_t1(uint16_t inst) {
 
 // arm-thumb
 static void ldrh_imm_t1(uint16_t inst) {
-	//# cycles of Load: 2
-	cycle++;
-
 	uint8_t rt = inst & 0x7;
 	uint8_t rn = (inst >> 3) & 0x7;
 	uint8_t imm5 = (inst >> 6) & 0x1f;
@@ -150,9 +128,6 @@ static void ldrh_imm_t1(uint16_t inst) {
 
 // arm-thumb
 static void ldrh_reg_t1(uint16_t inst) {
-	//# cycles of Load: 2
-	cycle++;
-
 	uint8_t rt = inst & 0x7;
 	uint8_t rn = (inst >> 3) & 0x7;
 	uint8_t rm = (inst >> 6) & 0x7;
@@ -169,9 +144,6 @@ static void ldrh_reg_t1(uint16_t inst) {
 
 // arm-thumb
 static void ldrsb_reg_t1(uint16_t inst) {
-	//# cycles of Load: 2
-	cycle++;
-
 	uint8_t rt = inst & 0x7;
 	uint8_t rn = (inst >> 3) & 0x7;
 	uint8_t rm = (inst >> 6) & 0x7;
@@ -189,9 +161,6 @@ static void ldrsb_reg_t1(uint16_t inst) {
 
 // arm-thumb
 static void ldrsh_reg_t1(uint16_t inst) {
-	//# cycles of Load: 2
-	cycle++;
-
 	uint8_t rt = inst & 0x7;
 	uint8_t rn = (inst >> 3) & 0x7;
 	uint8_t rm = (inst >> 6) & 0x7;
@@ -30,11 +30,9 @@ static void and_reg_t1(uint16_t inst) {
 	uint8_t rd = rdn;
 	uint8_t rn = rdn;
 	bool setflags = !in_ITblock();
-	enum SRType shift_t = SRType_LSL;
-	uint8_t shift_n = 0;
 
 	OP_DECOMPILE("AND<IT> <Rdn>,<Rm>", rdn, rm);
-	return and_reg(rd, rn, rm, setflags, shift_t, shift_n);
+	return and_reg_lo(rd, rn, rm, setflags);
 }
 
 // arm-thumb
@@ -45,11 +43,9 @@ static void bic_reg_t1(uint16_t inst) {
 	uint8_t rd = rdn;
 	uint8_t rn = rdn;
 	bool setflags = !in_ITblock();
-	enum SRType shift_t = SRType_LSL;
-	uint8_t shift_n = 0;
 
 	OP_DECOMPILE("BIC<IT> <Rdn>,<Rm>", rdn, rm);
-	return bic_reg(rd, rn, rm, setflags, shift_t, shift_n);
+	return bic_reg_lo(rd, rn, rm, setflags);
 }
 
 // arm-thumb
@@ -60,11 +56,9 @@ static void eor_reg_t1(uint16_t inst) {
 	uint8_t rd = rdn;
 	uint8_t rn = rdn;
 	bool setflags = !in_ITblock();
-	enum SRType shift_t = SRType_LSL;
-	uint8_t shift_n = 0;
 
 	OP_DECOMPILE("EOR<IT> <Rdn>,<Rm>", rdn, rm);
-	return eor_reg(setflags, rd, rn, rm, shift_t, shift_n);
+	return eor_reg_lo(rd, rn, rm, setflags);
 }
 
 // arm-thumb
@@ -73,11 +67,9 @@ static void mvn_reg_t1(uint16_t inst) {
 	uint8_t rm = (inst >> 3) & 0x7;
 
 	bool setflags = !in_ITblock();
-	enum SRType shift_t = LSL;
-	uint8_t shift_n = 0;
 
 	OP_DECOMPILE("MVN<IT> <Rd>,<Rm>", rd, rm);
-	return mvn_reg(setflags, rd, rm, shift_t, shift_n);
+	return mvn_reg_lo(rd, rm, setflags);
 }
 
 // arm-thumb
@@ -89,12 +81,10 @@ static void orr_reg_t1(uint16_t inst) {
 	uint8_t rn = rdn;
 
 	bool setflags = !in_ITblock();
-	enum SRType shift_t = LSL;
-	uint8_t shift_n = 0;
 
 	OP_DECOMPILE("ORR<IT> <Rdn>,<Rm>", rd, rm);
 
-	return orr_reg(setflags, rd, rn, rm, shift_t, shift_n);
+	return orr_reg_lo(rd, rn, rm, setflags);
 }
 
 __attribute__ ((constructor))
@@ -30,11 +30,10 @@ static void mov_imm_t1(uint16_t inst) {
 	bool setflags = !in_ITblock();
 	uint32_t imm32 = imm8;
 
-	union apsr_t apsr = CORE_apsr_read();
-	bool carry = apsr.bits.C;
+	bool carry = CORE_apsr_C_read();
 
 	OP_DECOMPILE("MOV<IT> <Rd>,#<imm8>", rd, imm8);
-	return mov_imm(apsr, setflags, imm32, rd, carry);
+	return mov_imm(setflags, imm32, rd, carry);
 }
 
 /* If <rd> and <rm> both in R0-R7 then all thumb */
@@ -24,17 +24,17 @@
 
 // arm-thumb
 static void asr_imm_t1(uint16_t inst) {
-	return shift_imm_t1(inst, ASR);
+	return asr_imm_t1_lo(inst);
 }
 
 // arm-thumb
 static void lsl_imm_t1(uint16_t inst) {
-	return shift_imm_t1(inst, LSL);
+	return lsl_imm_t1_lo(inst);
 }
 
 // arm-thumb
 static void lsr_imm_t1(uint16_t inst) {
-	return shift_imm_t1(inst, LSR);
+	return lsr_imm_t1_lo(inst);
 }
 
 // arm-thumb
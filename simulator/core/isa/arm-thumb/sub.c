@@ -43,7 +43,7 @@ static void sbc_reg_t1(uint16_t inst) {
 	bool setflags = !in_ITblock();
 
 	OP_DECOMPILE("SBC<IT> <Rdn>,<Rm>", rdn, rm);
-	return sbc_reg(rdn, rdn, rm, setflags, SRType_LSL, 0);
+	return sbc_reg_lo(rdn, rdn, rm, setflags);
 }
 
 // arm-thumb
@@ -80,7 +80,7 @@ static void sub_reg_t1(uint16_t inst) {
 	bool setflags = !in_ITblock();
 
 	OP_DECOMPILE("SUB<IT> <Rd>,<Rn><Rm>", rd, rn, rm);
-	return sub_reg(rd, rn, rm, SRType_LSL, 0, setflags);
+	return sub_reg_lo(rd, rn, rm, setflags);
 }
 
 // arm-thumb
@@ -141,5 +141,7 @@ static void register_opcodes_arm_thumb_sub(void) {
 	register_opcode_mask_16(0xb080, 0x4f00, sub_sp_imm_t1);
 
 	// sub_sp_reg_t1: 1110 1011 101x 1101 0<x's>
-	register_opcode_mask_32(0xebad0000, 0x14428000, sub_sp_reg_t1);
+	register_opcode_mask_32_ex(0xebad0000, 0x14428000, sub_sp_reg_t1,
+			0x100f00, 0x0,
+			0, 0);
 }
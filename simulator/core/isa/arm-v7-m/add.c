@@ -272,7 +272,9 @@ static void register_opcodes_arm_v7_m_add(void) {
 	register_opcode_mask_32(0xf20d0000, 0x09f28000, add_sp_plus_imm_t4);
 
 	// add_sp_plus_reg_t3: 1110 1011 000x 1101 0<x's>
-	register_opcode_mask_32(0xeb0d0000, 0x14e28000, add_sp_plus_reg_t3);
+	register_opcode_mask_32_ex(0xeb0d0000, 0x14e28000, add_sp_plus_reg_t3,
+			0x100f00, 0x0,
+			0, 0);
 
 	// adr_t2: 1111 0x10 1010 1111 0<x's>
 	register_opcode_mask_32(0xf2af0000, 0x09508000, adr_t2);
@@ -98,10 +98,9 @@ static void teq_imm_t1(uint32_t inst) {
 	uint8_t rn   = (inst >> 16) & 0xf;
 	bool    i    = (inst >> 26) & 0x1;
 
-	union apsr_t apsr = CORE_apsr_read();
 	uint32_t imm32;
 	bool carry;
-	ThumbExpandImm_C(imm8 | (imm3 << 8) | (i << 11), apsr.bits.C,
+	ThumbExpandImm_C(imm8 | (imm3 << 8) | (i << 11), CORE_apsr_C_read(),
 			&imm32, &carry);
 
 	if (BadReg(rn))
@@ -140,9 +139,7 @@ static void tst_imm_t1(uint32_t inst) {
 	uint16_t imm12 = (i << 11) | (imm3 << 8) | (imm8);
 	uint32_t imm32;
 	bool carry;
-	union apsr_t apsr = CORE_apsr_read();
-
-	ThumbExpandImm_C(imm12, apsr.bits.C, &imm32, &carry);
+	ThumbExpandImm_C(imm12, CORE_apsr_C_read(), &imm32, &carry);
 
 	if ((rn == 13) || (rn == 15))
 		CORE_ERR_unpredictable("bad reg\n");
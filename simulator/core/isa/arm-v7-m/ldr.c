@@ -547,6 +547,7 @@ static void register_opcodes_arm_v7_m_ldr(void) {
 	// ldrd_lit_t1: 1110 100x x1x1 1111 <x's>
 	register_opcode_mask_32_ex(0xe85f0000, 0x16000000, ldrd_lit_t1,
 			0x0, 0x01800000,
+			0x0, 0x01200000,
 			0, 0);
 
 	// ldrh_imm_t2: 1111 1000 1011 <x's>
@@ -24,8 +24,6 @@
 
 // arm-v7-m
 static void and_imm_t1(uint32_t inst) {
-	union apsr_t apsr = CORE_apsr_read();
-
 	uint8_t imm8 = inst & 0xff;
 	uint8_t rd = (inst & 0xf00) >> 8;
 	uint8_t imm3 = (inst & 0x7000) >> 12;
@@ -42,7 +40,7 @@ static void and_imm_t1(uint32_t inst) {
 	uint32_t imm32;
 	bool carry;
 	uint16_t imm12 = (i << 11) | (imm3 << 8) | imm8;
-	ThumbExpandImm_C(imm12, apsr.bits.C, &imm32, &carry);
+	ThumbExpandImm_C(imm12, CORE_apsr_C_read(), &imm32, &carry);
 
 	DBG2("rd: %d, rn %d, imm12 0x%03x (%d)\n", rd, rn, imm12, imm12);
 
@@ -50,7 +48,7 @@ static void and_imm_t1(uint32_t inst) {
 		CORE_ERR_unpredictable("Bad reg combo's in add_imm_t1\n");
 
 	OP_DECOMPILE("AND{S}<c> <Rd>,<Rn>,#<const>", setflags, rd, rn, imm32);
-	return and_imm(apsr, setflags, rd, rn, imm32, carry);
+	return and_imm(setflags, rd, rn, imm32, carry);
 }
 
 // arm-v7-m
@@ -87,19 +85,17 @@ static void bic_imm_t1(uint32_t inst) {
 	uint8_t S = !!(inst & 0x100000);
 	uint8_t i = !!(inst & 0x04000000);
 
-	union apsr_t apsr = CORE_apsr_read();
-
 	uint16_t imm12 = (i << 11) | (imm3 << 8) | imm8;
 	uint32_t imm32;
 	bool carry_out;
-	ThumbExpandImm_C(imm12, apsr.bits.C, &imm32, &carry_out);
+	ThumbExpandImm_C(imm12, CORE_apsr_C_read(), &imm32, &carry_out);
 
 	if ((rd >= 13) || (rn >= 13))
 		CORE_ERR_unpredictable("bic_imm_t1 bad reg\n");
 
 	OP_DECOMPILE("BIC{S}<c> <Rd>,<Rn>,#<const>",
 			S, rn, rn, imm32);
-	return bic_imm(apsr, S, rd, rn, imm32, carry_out);
+	return bic_imm(S, rd, rn, imm32, carry_out);
 }
 
 // arm-v7-m
@@ -136,16 +132,16 @@ static void eor_imm_t1(uint32_t inst) {
 
 	bool setflags = S;
 
-	union apsr_t apsr = CORE_apsr_read();
 	uint32_t imm32;
 	bool carry;
-	ThumbExpandImm_C((i << 11) | (imm3 << 8) | imm8, apsr.bits.C, &imm32, &carry);
+	ThumbExpandImm_C((i << 11) | (imm3 << 8) | imm8, CORE_apsr_C_read(),
+			&imm32, &carry);
 
 	if ((rd == 13) || ((rd == 15) && (S == 0)) || BadReg(rn))
 		CORE_ERR_unpredictable("bad reg\n");
 
 	OP_DECOMPILE("EOR{S}<c> <Rd>,<Rn>,#<const>", rd, rn, imm32);
-	return eor_imm(rd, rn, imm32, carry, setflags, apsr);
+	return eor_imm(rd, rn, imm32, carry, setflags);
 }
 
 // arm-v7-m
@@ -185,17 +181,16 @@ static void mvn_imm_t1(uint32_t inst) {
 
 	bool setflags = S==1;
 
-	union apsr_t apsr = CORE_apsr_read();
 	uint32_t imm32;
 	bool carry;
-	ThumbExpandImm_C(imm8 | (imm3 << 8) | (i << 11), apsr.bits.C,
+	ThumbExpandImm_C(imm8 | (imm3 << 8) | (i << 11), CORE_apsr_C_read(),
 			&imm32, &carry);
 
 	if (rd > 13)
 		CORE_ERR_unpredictable("mvn_imm_t1 case\n");
 
 	OP_DECOMPILE("MVN{S}<c> <Rd>,#<const>", setflags, rd, imm32);
-	return mvn_imm(rd, setflags, apsr, imm32, carry);
+	return mvn_imm(rd, setflags, imm32, carry);
 }
 
 // arm-v7-m
@@ -232,17 +227,16 @@ static void orn_imm_t1(uint32_t inst) {
 
 	bool setflags = S==1;
 
-	union apsr_t apsr = CORE_apsr_read();
 	uint32_t imm32;
 	bool carry;
-	ThumbExpandImm_C(imm8 | (imm3 << 8) | (i << 11), apsr.bits.C,
+	ThumbExpandImm_C(imm8 | (imm3 << 8) | (i << 11), CORE_apsr_C_read(),
 			&imm32, &carry);
 
 	if ((rd > 13) || (rn == 1))
 		CORE_ERR_unpredictable("orn_imm_t1 case\n");
 
 	OP_DECOMPILE("ORN{S}<c> <Rd>,<Rn>,#<const>", rd, rn, imm32);
-	return orn_imm(rd, rn, setflags, apsr, imm32, carry);
+	return orn_imm(rd, rn, setflags, imm32, carry);
 }
 
 // arm-v7-m
@@ -279,10 +273,9 @@ static void orr_imm_t1(uint32_t inst) {
 
 	bool setflags = S==1;
 
-	union apsr_t apsr = CORE_apsr_read();
 	uint32_t imm32;
 	bool carry;
-	ThumbExpandImm_C(imm8 | (imm3 << 8) | (i << 11), apsr.bits.C,
+	ThumbExpandImm_C(imm8 | (imm3 << 8) | (i << 11), CORE_apsr_C_read(),
 			&imm32, &carry);
 
 	if ((rd > 13) || (rn == 13))
@@ -290,7 +283,7 @@ static void orr_imm_t1(uint32_t inst) {
 
 	OP_DECOMPILE("ORR{S}<c> <Rd>,<Rn>,#<const>",
 			setflags, rd, rn, imm32);
-	return orr_imm(rd, rn, setflags, apsr, imm32, carry);
+	return orr_imm(rd, rn, setflags, imm32, carry);
 }
 
 // arm-v7-m
@@ -343,7 +336,9 @@ static void register_opcodes_arm_v7_m_logical(void) {
 			0, 0);
 
 	// eor_reg_t2: 1110 1010 100x xxxx 0<x's>
-	register_opcode_mask_32(0xea800000, 0x15608000, eor_reg_t2);
+	register_opcode_mask_32_ex(0xea800000, 0x15608000, eor_reg_t2,
+			0x100f00, 0x0,
+			0, 0);
 
 	// mvn_imm_t1: 1111 0x00 011x 1111 0<x's>
 	register_opcode_mask_32(0xf06f0000, 0x0b808000, mvn_imm_t1);
@@ -24,8 +24,6 @@
 
 // arm-v7-m
 static void mov_imm_t2(uint32_t inst) {
-	union apsr_t apsr = CORE_apsr_read();
-
 	int   imm8 =  (inst & 0x000000ff);
 	uint8_t Rd =  (inst & 0x00000f00) >> 8;
 	int   imm3 =  (inst & 0x00007000) >> 12;
@@ -41,20 +39,18 @@ static void mov_imm_t2(uint32_t inst) {
 	arg |= (i << 11);
 	uint32_t imm32;
 	bool carry;
-	ThumbExpandImm_C(arg, apsr.bits.C, &imm32, &carry);
+	ThumbExpandImm_C(arg, CORE_apsr_C_read(), &imm32, &carry);
 
 	if ((Rd == 13) || (Rd == 15)) {
 		CORE_ERR_unpredictable("mov to SP or PC\n");
 	}
 
 	OP_DECOMPILE("MOV{S}<c>.W <Rd>,#<const>", setflags, Rd, imm32);
-	return mov_imm(apsr, setflags, imm32, Rd, carry);
+	return mov_imm(setflags, imm32, Rd, carry);
 }
 
 // arm-v7-m
 static void mov_imm_t3(uint32_t inst) {
-	union apsr_t apsr = CORE_apsr_read();
-
 	uint8_t imm8 = inst & 0xff;
 	uint8_t rd = (inst & 0xf00) >> 8;
 	uint8_t imm3 = (inst & 0x7000) >> 12;
@@ -71,7 +67,7 @@ static void mov_imm_t3(uint32_t inst) {
 
 	OP_DECOMPILE("MOVW<c> <Rd>,#<imm16>", rd, imm32);
 	// carry set to 0 irrelevant since setflags is false
-	return mov_imm(apsr, setflags, imm32, rd, 0);
+	return mov_imm(setflags, imm32, rd, 0);
 }
 
 // arm-v7-m
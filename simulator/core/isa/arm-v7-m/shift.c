@@ -83,7 +83,9 @@ static void register_opcodes_arm_v7_m_shift(void) {
 	register_opcode_mask_32(0xea4f0020, 0x15a08010, asr_imm_t2);
 
 	// lsl_imm_t2: 1110 1010 010x 1111 0xxx xxxx xx00 xxxx
-	register_opcode_mask_32(0xea4f0000, 0x15a08030, lsl_imm_t2);
+	register_opcode_mask_32_ex(0xea4f0000, 0x15a08030, lsl_imm_t2,
+			0x0, 0x70c0,
+			0, 0);
 
 	// lsr_imm_t2: 1110 1010 010x 1111 0xxx xxxx xx01 xxxx
 	register_opcode_mask_32(0xea4f0010, 0x15a08020, lsr_imm_t2);
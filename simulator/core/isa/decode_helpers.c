@@ -144,12 +144,10 @@ void ROR_C(uint32_t x, int Nbits, uint8_t shift,
 }
 
 uint32_t ThumbExpandImm(uint32_t imm12) {
-	union apsr_t apsr = CORE_apsr_read();
-
 	uint32_t result;
 	bool carry;
 
-	ThumbExpandImm_C(imm12, apsr.bits.C, &result, &carry);
+	ThumbExpandImm_C(imm12, CORE_apsr_C_read(), &result, &carry);
 
 	return result;
 }
@@ -0,0 +1,296 @@
+#!/usr/bin/env python
+
+# Mulator - An extensible {ARM} {e,si}mulator
+# Copyright 2011-2012  Pat Pannuto <pat.pannuto@gmail.com>
+#
+# This file is part of Mulator.
+#
+# Mulator is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Mulator is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+
+# Collects every register_opcode_mask_* call from the ISA sources given on the
+# command line and emits decoder.c / decoder.h, a static decision tree that
+# maps an instruction to the index ("slot") of the registration it matches.
+#
+# The handlers themselves are static to their ISA files, so the generated code
+# only knows slots; core/opcodes.c binds each slot to its struct op as the
+# constructors register them.
+
+from __future__ import print_function
+
+import re
+import sys
+
+class Error(Exception):
+	pass
+
+class Op(object):
+	def __init__(self, f, lineno, is16, ones, zeros, fn, exceptions):
+		self.f = f
+		self.lineno = lineno
+		self.is16 = is16
+		self.ones = ones
+		self.zeros = zeros
+		self.fn = fn
+		self.exceptions = exceptions
+
+	def where(self):
+		return "%s:%d (%s)" % (self.f, self.lineno, self.fn)
+
+	def ex_care(self):
+		c = 0
+		for o,z in self.exceptions:
+			c |= o | z
+		return c
+
+	def matches(self, inst):
+		if (inst & self.ones) != self.ones:
+			return False
+		if (~inst & self.zeros) != self.zeros:
+			return False
+		for o,z in self.exceptions:
+			if (inst & o) == o and (~inst & z) == z:
+				return False
+		return True
+
+comment_re = re.compile(r'//[^\n]*|/\*.*?\*/', re.S)
+register_re = re.compile(
+		r'register_opcode_mask_(16|32)(_ex)?\s*\(([^;]*?)\)\s*;', re.S)
+
+def parse(filename):
+	ops = []
+	src = open(filename).read()
+	# Blank out comments, but keep line numbers intact
+	src = comment_re.sub(lambda m: re.sub(r'[^\n]', ' ', m.group(0)), src)
+	for m in register_re.finditer(src):
+		lineno = src.count('\n', 0, m.start()) + 1
+		args = [a.strip() for a in m.group(3).split(',')]
+		try:
+			ones = int(args[0], 0)
+			zeros = int(args[1], 0)
+		except ValueError:
+			raise Error("%s:%d: Opcode masks must be integer literals" %\
+					(filename, lineno))
+		fn = args[2]
+		exceptions = []
+		if m.group(2):
+			ex = [int(a, 0) for a in args[3:]]
+			if len(ex) % 2 or ex[-2:] != [0, 0]:
+				raise Error("%s:%d: Exception list must end with 0, 0" %\
+						(filename, lineno))
+			for i in range(0, len(ex) - 2, 2):
+				exceptions.append((ex[i], ex[i+1]))
+		ops.append(Op(filename, lineno, m.group(1) == '16',
+			ones, zeros, fn, exceptions))
+	return ops
+
+def overlap(a, b, known, known_val):
+	'''Returns an instruction matched by both a and b, or None'''
+	if (a.ones & b.zeros) or (b.ones & a.zeros):
+		return None
+	ones = a.ones | b.ones | known_val
+	zeros = a.zeros | b.zeros | (known & ~known_val)
+	if ones & zeros:
+		return None
+	# Only bits the exceptions look at can change the outcome
+	free = (a.ex_care() | b.ex_care()) & ~(ones | zeros)
+	sub = 0
+	while True:
+		inst = ones | sub
+		if a.matches(inst) and b.matches(inst):
+			return inst
+		sub = (sub - free) & free
+		if sub == 0:
+			return None
+
+class Decoder(object):
+	def __init__(self, ops, width):
+		self.ops = ops
+		self.width = width
+		self.overlaps = []
+
+	def pick_bit(self, cands, known):
+		best = None
+		best_score = None
+		for bit in range(self.width - 1, -1, -1):
+			m = 1 << bit
+			if known & m:
+				continue
+			n0 = n1 = 0
+			for c in cands:
+				if self.ops[c].ones & m:
+					n1 += 1
+				elif self.ops[c].zeros & m:
+					n0 += 1
+			if n0 + n1 == 0:
+				continue
+			# Prefer bits that many ops care about and that split evenly
+			score = (n0 + n1, min(n0, n1))
+			if best_score is None or score > best_score:
+				best = bit
+				best_score = score
+		return best
+
+	def emit(self, cands, known, known_val, depth):
+		ind = '\t' * depth
+		out = ''
+		bit = None
+		if len(cands) > 1:
+			bit = self.pick_bit(cands, known)
+		if bit is None:
+			for i in range(len(cands)):
+				for j in range(i + 1, len(cands)):
+					a = self.ops[cands[i]]
+					b = self.ops[cands[j]]
+					inst = overlap(a, b, known, known_val)
+					if inst is not None:
+						self.overlaps.append((a, b, inst))
+			for c in cands:
+				o = self.ops[c]
+				# Bits already tested on the way down needn't be re-checked
+				ones = o.ones & ~known
+				zeros = o.zeros & ~known
+				cond = []
+				if ones or zeros:
+					cond.append('MATCH(inst, 0x%x, 0x%x)' % (ones, zeros))
+				for eo,ez in o.exceptions:
+					cond.append('!MATCH(inst, 0x%x, 0x%x)' % (eo, ez))
+				if cond:
+					out += ind + 'if (' + ' && '.join(cond) + ')\n'
+					out += ind + '\treturn %d; // %s\n' % (c, o.fn)
+				else:
+					out += ind + 'return %d; // %s\n' % (c, o.fn)
+					return out
+			out += ind + 'return -1;\n'
+			return out
+
+		m = 1 << bit
+		c1 = [c for c in cands if not (self.ops[c].zeros & m)]
+		c0 = [c for c in cands if not (self.ops[c].ones & m)]
+		out += ind + 'if (inst & 0x%x) {\n' % (m)
+		out += self.emit(c1, known | m, known_val | m, depth + 1)
+		out += ind + '} else {\n'
+		out += self.emit(c0, known | m, known_val, depth + 1)
+		out += ind + '}\n'
+		return out
+
+def main(files):
+	ops = []
+	for f in files:
+		ops += parse(f)
+
+	# Keep slot numbering stable across builds
+	ops.sort(key=lambda o: (not o.is16, o.ones, o.zeros, o.fn))
+
+	op16 = [i for i in range(len(ops)) if ops[i].is16]
+	op32 = [i for i in range(len(ops)) if not ops[i].is16]
+
+	d16 = Decoder(ops, 16)
+	tree16 = d16.emit(op16, 0, 0, 1)
+	# 32-bit encodings always start 111{01,10,11}, the top bits are
+	# implied by the caller having seen a non-zero upper halfword
+	d32 = Decoder(ops, 32)
+	tree32 = d32.emit(op32, 0, 0, 1)
+
+	overlaps = d16.overlaps + d32.overlaps
+	if overlaps:
+		for a,b,inst in overlaps:
+			print("Overlapping opcode registrations, e.g. inst %08x:" % (inst),
+					file=sys.stderr)
+			print("\t" + a.where(), file=sys.stderr)
+			print("\t" + b.where(), file=sys.stderr)
+		raise Error("%d overlapping opcode registrations" % (len(overlaps)))
+
+	preamble = "/* THIS FILE AUTOMATICALLY GENERATED -- DO NOT EDIT */\n\n"
+
+	h = open("decoder.h", "w")
+	h.write(preamble)
+	h.write('#ifndef DECODER_H\n#define DECODER_H\n\n')
+	h.write('#include "core/common.h"\n\n')
+	h.write('#define GEN_DECODER_SLOTS %d\n\n' % (len(ops)))
+	h.write('struct gen_decoder_slot {\n')
+	h.write('\tbool is16;\n')
+	h.write('\tuint32_t ones_mask;\n')
+	h.write('\tuint32_t zeros_mask;\n')
+	h.write('\tint ex_cnt;\n')
+	h.write('\tconst char *fn_name;\n')
+	h.write('};\n\n')
+	h.write('extern const struct gen_decoder_slot gen_decoder_slots[GEN_DECODER_SLOTS];\n\n')
+	h.write('// Returns the slot matching inst, or -1 if no registration does\n')
+	h.write('int gen_decode(uint32_t inst) __attribute__ ((const));\n\n')
+	h.write('// Returns the slot for a registration, or -1 if it is unknown\n')
+	h.write('int gen_decoder_slot_lookup(bool is16, uint32_t ones_mask,\n')
+	h.write('\t\tuint32_t zeros_mask, const char *fn_name) __attribute__ ((pure));\n\n')
+	h.write('#endif // DECODER_H\n')
+	h.close()
+
+	c = open("decoder.c", "w")
+	c.write(preamble)
+	c.write('#include "decoder.h"\n\n')
+	c.write('#define MATCH(_i, _o, _z) ((((_i) & (_o)) == (_o)) && ((~(_i) & (_z)) == (_z)))\n\n')
+
+	c.write('const struct gen_decoder_slot gen_decoder_slots[GEN_DECODER_SLOTS] = {\n')
+	for o in ops:
+		c.write('\t{%s, 0x%08x, 0x%08x, %d, "%s"},\n' %\
+				(('true' if o.is16 else 'false'), o.ones, o.zeros,
+					len(o.exceptions), o.fn))
+	c.write('};\n\n')
+
+	c.write('static int gen_decode16(uint32_t inst) {\n')
+	c.write(tree16)
+	c.write('}\n\n')
+	c.write('static int gen_decode32(uint32_t inst) {\n')
+	c.write(tree32)
+	c.write('}\n\n')
+	c.write('EXPORT int gen_decode(uint32_t inst) {\n')
+	c.write('\tif ((inst & 0xffff0000) == 0)\n')
+	c.write('\t\treturn gen_decode16(inst);\n')
+	c.write('\treturn gen_decode32(inst);\n')
+	c.write('}\n\n')
+
+	# The registered name is __FILE__":"fn, only the function is compared
+	c.write('EXPORT int gen_decoder_slot_lookup(bool is16, uint32_t ones_mask,\n')
+	c.write('\t\tuint32_t zeros_mask, const char *fn_name) {\n')
+	c.write('\tconst char *fn = strrchr(fn_name, \':\');\n')
+	c.write('\tfn = (fn) ? fn + 1 : fn_name;\n\n')
+	c.write('\tint lo = 0;\n')
+	c.write('\tint hi = GEN_DECODER_SLOTS - 1;\n')
+	c.write('\twhile (lo <= hi) {\n')
+	c.write('\t\tint mid = (lo + hi) / 2;\n')
+	c.write('\t\tconst struct gen_decoder_slot *s = &gen_decoder_slots[mid];\n')
+	c.write('\t\tint cmp;\n')
+	c.write('\t\tif (s->is16 != is16)\n')
+	c.write('\t\t\tcmp = (s->is16) ? -1 : 1;\n')
+	c.write('\t\telse if (s->ones_mask != ones_mask)\n')
+	c.write('\t\t\tcmp = (s->ones_mask < ones_mask) ? -1 : 1;\n')
+	c.write('\t\telse if (s->zeros_mask != zeros_mask)\n')
+	c.write('\t\t\tcmp = (s->zeros_mask < zeros_mask) ? -1 : 1;\n')
+	c.write('\t\telse\n')
+	c.write('\t\t\tcmp = strcmp(s->fn_name, fn);\n')
+	c.write('\t\tif (cmp == 0)\n')
+	c.write('\t\t\treturn mid;\n')
+	c.write('\t\tif (cmp < 0)\n')
+	c.write('\t\t\tlo = mid + 1;\n')
+	c.write('\t\telse\n')
+	c.write('\t\t\thi = mid - 1;\n')
+	c.write('\t}\n')
+	c.write('\treturn -1;\n')
+	c.write('}\n')
+	c.close()
+
+if __name__ == '__main__':
+	try:
+		main(sys.argv[1:])
+	except Error as e:
+		print(str(e), file=sys.stderr)
+		sys.exit(1)
@@ -0,0 +1,224 @@
+/* Mulator - An extensible {ARM} {e,si}mulator
+ * Copyright 2011-2016  Pat Pannuto <pat.pannuto@gmail.com>
+ *
+ * This file is part of Mulator.
+ *
+ * Mulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memdump.h"
+
+#include <sys/stat.h>
+
+/* Memory dumps
+ *
+ * The RAM and ROM dumps are rewritten every time the full state is printed,
+ * which is every step in the shell. Most of memory is zero and most of the
+ * rest does not change between steps, so a dump compares each block with
+ * what the file already holds and writes only the blocks that differ. A new
+ * file is sized up front, leaving the zero blocks as holes.
+ */
+
+#define MEMDUMP_BLOCK		4096
+#define MEMDUMP_STRIDE		64	// Bytes compared at once before words
+#define MEMDUMP_GAP		4	// Equal words that still join two regions
+#define MEMDUMP_REGION_LINES	64	// Words printed per differing region
+
+EXPORT const char *compare_ram_file = NULL;
+
+EXPORT ssize_t memdump_write(const char *file, const void *mem, size_t size) {
+	const uint8_t *m = mem;
+	uint8_t old[MEMDUMP_BLOCK];
+	struct stat st;
+	ssize_t written = 0;
+	size_t off;
+	int fd;
+
+	fd = open(file, O_RDWR | O_CREAT, 0644);
+	if (fd < 0)
+		return -1;
+	if ((0 != fstat(fd, &st)) ||
+			((st.st_size != (off_t) size) && (0 != ftruncate(fd, size)))) {
+		close(fd);
+		return -1;
+	}
+
+	for (off = 0; off < size; off += MEMDUMP_BLOCK) {
+		size_t len = MIN(MEMDUMP_BLOCK, size - off);
+		ssize_t got = pread(fd, old, len, off);
+
+		if ((got == (ssize_t) len) && (0 == memcmp(old, m + off, len)))
+			continue;
+		if ((ssize_t) len != pwrite(fd, m + off, len, off)) {
+			close(fd);
+			return -1;
+		}
+		written += len;
+	}
+
+	if (0 != close(fd))
+		return -1;
+	return written;
+}
+
+static void hex_line(FILE *fp, const uint8_t *m, size_t off, size_t len) {
+	char line[80];
+	char *c = line;
+	size_t i;
+
+	c += sprintf(c, "%08zx ", off);
+	for (i = 0; i < 16; i++) {
+		if (i == 8)
+			*c++ = ' ';
+		if (i < len)
+			c += sprintf(c, " %02x", m[i]);
+		else
+			c += sprintf(c, "   ");
+	}
+	c += sprintf(c, "  |");
+	for (i = 0; i < len; i++)
+		*c++ = ((m[i] >= 0x20) && (m[i] < 0x7f)) ? m[i] : '.';
+	sprintf(c, "|\n");
+	fputs(line, fp);
+}
+
+// Lines that repeat the one before are folded into a '*', as hexdump does
+EXPORT void memdump_hex(FILE *fp, const void *mem, size_t size) {
+	const uint8_t *m = mem;
+	bool folding = false;
+	size_t off;
+
+	for (off = 0; off < size; off += 16) {
+		size_t len = MIN(16, size - off);
+
+		if ((off > 0) && (len == 16) && (0 == memcmp(m + off, m + off - 16, 16))) {
+			if (!folding)
+				fputs("*\n", fp);
+			folding = true;
+			continue;
+		}
+		folding = false;
+		hex_line(fp, m + off, off, len);
+	}
+	if (size)
+		fprintf(fp, "%08zx\n", size);
+}
+
+static uint32_t word_at(const uint8_t *m, size_t i) {
+	uint32_t w;
+	memcpy(&w, m + 4 * i, 4);
+	return w;
+}
+
+// Prints words first to last (inclusive), count of which differ
+static void print_region(const char *name, const uint8_t *golden,
+		const uint8_t *m, uint32_t base, size_t first, size_t last,
+		size_t count) {
+	size_t i;
+
+	printf("%s differs at %08zx-%08zx (%zu of %zu word%s):\n", name,
+			base + 4 * first, base + 4 * last + 3, count,
+			last - first + 1, (last == first) ? "" : "s");
+	printf("\taddress     golden     actual\n");
+	for (i = first; (i <= last) && (i < first + MEMDUMP_REGION_LINES); i++) {
+		uint32_t g = word_at(golden, i);
+		uint32_t a = word_at(m, i);
+		printf("\t%08zx  %08x   %08x%s\n", base + 4 * i, g, a,
+				(g != a) ? "  *" : "");
+	}
+	if (i <= last)
+		printf("\t... %zu more word%s\n", last - i + 1,
+				(last == i) ? "" : "s");
+}
+
+/* Equal memory is skipped a stride at a time with memcmp, which the C
+ * library vectorizes, and only strides that differ are walked word by word.
+ * Differing words closer than MEMDUMP_GAP are reported as one region.
+ */
+EXPORT int memdump_compare(const char *name, const void *mem, size_t size,
+		uint32_t base, const char *file) {
+	const uint8_t *m = mem;
+	uint8_t *golden;
+	size_t golden_size;
+	size_t words, i;
+	size_t first = 0, last = 0, count = 0;
+	int total = 0;
+	unsigned regions = 0;
+	FILE *fp;
+	long len;
+
+	fp = fopen(file, "rb");
+	if (fp == NULL) {
+		WARN("Could not open %s: %s\n", file, strerror(errno));
+		return -1;
+	}
+	if ((0 != fseek(fp, 0, SEEK_END)) || ((len = ftell(fp)) < 0) ||
+			(0 != fseek(fp, 0, SEEK_SET))) {
+		WARN("Could not size %s: %s\n", file, strerror(errno));
+		fclose(fp);
+		return -1;
+	}
+	golden_size = len;
+	golden = malloc(golden_size + 1);
+	if (golden == NULL)
+		ERR(E_UNKNOWN, "Out of memory for %s\n", file);
+	if (golden_size != fread(golden, 1, golden_size, fp)) {
+		WARN("Could not read %s\n", file);
+		free(golden);
+		fclose(fp);
+		return -1;
+	}
+	fclose(fp);
+
+	if (golden_size != size)
+		WARN("%s is %zu bytes but %s is %zu, comparing the first %zu\n",
+				file, golden_size, name, size,
+				MIN(golden_size, size) & ~(size_t) 3);
+	words = MIN(golden_size, size) / 4;
+
+	for (i = 0; i < words; ) {
+		if (((i % (MEMDUMP_STRIDE / 4)) == 0) &&
+				(i + MEMDUMP_STRIDE / 4 <= words) &&
+				(0 == memcmp(golden + 4 * i, m + 4 * i, MEMDUMP_STRIDE))) {
+			i += MEMDUMP_STRIDE / 4;
+			continue;
+		}
+		if (word_at(golden, i) != word_at(m, i)) {
+			if (count && (i > last + MEMDUMP_GAP)) {
+				print_region(name, golden, m, base, first, last, count);
+				regions++;
+				count = 0;
+			}
+			if (count == 0)
+				first = i;
+			last = i;
+			count++;
+			total++;
+		}
+		i++;
+	}
+	if (count) {
+		print_region(name, golden, m, base, first, last, count);
+		regions++;
+	}
+	free(golden);
+
+	if (total)
+		WARN("%s differs from %s in %d word%s (%u region%s)\n", name, file,
+				total, (total == 1) ? "" : "s",
+				regions, (regions == 1) ? "" : "s");
+	else
+		INFO("%s matches %s\n", name, file);
+	return total;
+}
@@ -0,0 +1,45 @@
+/* Mulator - An extensible {ARM} {e,si}mulator
+ * Copyright 2011-2016  Pat Pannuto <pat.pannuto@gmail.com>
+ *
+ * This file is part of Mulator.
+ *
+ * Mulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MEMDUMP_H
+#define MEMDUMP_H
+
+#include "common.h"
+
+#ifndef PP_STRING
+#define PP_STRING "MDP"
+#include "pretty_print.h"
+#endif
+
+// Golden image to compare the final RAM against on exit, or NULL
+extern const char *compare_ram_file;
+
+// Makes file a copy of mem, writing only the blocks that differ from what
+// it holds already. Returns the bytes written, or -1 on error
+ssize_t memdump_write(const char *file, const void *mem, size_t size);
+
+// Prints mem in the format of 'hexdump -C', offsets counting from 0
+void memdump_hex(FILE *fp, const void *mem, size_t size);
+
+// Compares mem (which starts at address base) with the image in file,
+// printing the regions that differ. Returns the number of words that do
+int memdump_compare(const char *name, const void *mem, size_t size,
+		uint32_t base, const char *file);
+
+#endif // MEMDUMP_H
@@ -18,6 +18,7 @@
  */
 
 #include "opcodes.h"
+#include "isa/decoder/decoder.h"
 
 #ifndef PP_STRING
 #define PP_STRING "---"
@@ -32,15 +33,12 @@ struct op_list {
 static int opcode_masks;
 EXPORT inline int get_opcode_masks(void) { return opcode_masks; }
 
-static void (*fn16_root[256]) (uint16_t);
-static void (*fn32_11101_root[256]) (uint32_t);
-static void (*fn32_11110_root[256]) (uint32_t);
-static void (*fn32_11111_root[256]) (uint32_t);
-
-static struct op_list* op16_root[256];
-static struct op_list* op32_11101_root[256];
-static struct op_list* op32_11110_root[256];
-static struct op_list* op32_11111_root[256];
+// Ops bound to the slots of the build-time generated decoder, which is the
+// only decoder. Registrations the generator does not know about (e.g. the
+// pipeline hazard op, registered at runtime) are kept on a list that is only
+// tried for encodings the generated decoder has no bound slot for.
+static struct op* gen_decoder_ops[GEN_DECODER_SLOTS];
+static struct op_list* unbound_ops;
 
 EXPORT bool match_mask8(uint8_t inst, uint8_t ones_mask, uint8_t zeros_mask) {
 	return
@@ -102,52 +100,53 @@ static bool __attribute__ ((pure)) match_op32(uint32_t inst, const struct op* co
 	return false;
 }
 
-static struct op* __attribute__ ((pure)) _find_op(uint32_t inst) {
-	struct op_list *olist = NULL;
-
-	switch (inst & 0xf8000000) {
-		case 0x00000000:
-			assert((inst & 0xffff0000) == 0);
-			olist = op16_root[(inst >> 8) & 0xff];
-			while (olist != NULL) {
-				// optimization
-				//if (olist->next == NULL) return olist->o;
-
-				if (match_op16(inst, olist->o))
-					return olist->o;
-				olist = olist->next;
-			}
-			return NULL;
-
-		case 0xe8000000:
-			olist = op32_11101_root[(inst >> 19) & 0xff];
-			break;
-		case 0xf0000000:
-			olist = op32_11110_root[(inst >> 19) & 0xff];
-			break;
-		case 0xf8000000:
-			olist = op32_11111_root[(inst >> 19) & 0xff];
-			break;
-	}
-
-	while (olist != NULL) {
-		// optimization
-		// if (olist->next == NULL) return olist->o;
-
-		if (match_op32(inst, olist->o))
+EXPORT struct op* find_op_quiet(uint32_t inst) {
+	// A slot is unbound when its handler was not built into this core
+	int slot = gen_decode(inst);
+	if (likely(slot >= 0) && likely(gen_decoder_ops[slot] != NULL))
+		return gen_decoder_ops[slot];
+
+	struct op_list *olist;
+	for (olist = unbound_ops; olist != NULL; olist = olist->next) {
+		if (olist->o->is16) {
+			if (((inst & 0xffff0000) == 0) && match_op16(inst, olist->o))
+				return olist->o;
+		} else if (match_op32(inst, olist->o))
 			return olist->o;
-		olist = olist->next;
 	}
 	return NULL;
 }
 
 EXPORT struct op* find_op(uint32_t inst) {
-	struct op *o = _find_op(inst);
+	struct op *o = find_op_quiet(inst);
 	if (o == NULL)
 		CORE_ERR_illegal_instr(inst);
 	return o;
 }
 
+static bool gen_decoder_bind(struct op* o, uint32_t ones_mask,
+		uint32_t zeros_mask, int ex_cnt) {
+	int slot = gen_decoder_slot_lookup(o->is16, ones_mask, zeros_mask, o->name);
+	if (slot < 0)
+		return false;
+
+	if (gen_decoder_slots[slot].ex_cnt != ex_cnt) {
+		WARN("Registration for %s does not match generated decoder\n", o->name);
+		ERR(E_BAD_OPCODE, "Generated decoder is out of date?\n");
+	}
+	gen_decoder_ops[slot] = o;
+	return true;
+}
+
+// Later registrations are tried first
+static void unbound_add(struct op* o) {
+	struct op_list* olist = malloc(sizeof(struct op_list));
+	assert((olist != NULL) && "alloc olist");
+	olist->o = o;
+	olist->next = unbound_ops;
+	unbound_ops = olist;
+}
+
 EXPORT int register_opcode_mask_16_ex_real(uint16_t ones_mask, uint16_t zeros_mask,
 		void (*fn) (uint16_t), const char *fn_name, ...) {
 	va_list va_args;
@@ -187,34 +186,8 @@ EXPORT int register_opcode_mask_16_ex_real(uint16_t ones_mask, uint16_t zeros_ma
 		exc_zeros_mask = va_arg(va_args, unsigned int);
 	}
 
-	////
-
-	bool inserted = false;
-	int i;
-	uint8_t ones_bucket = ones_mask >> 8;
-	uint8_t zeros_bucket = zeros_mask >> 8;
-	for (i = 0; i < 256; i++) {
-		if (match_mask8(i, ones_bucket, zeros_bucket)) {
-			inserted = true;
-
-			struct op_list* olist = malloc(sizeof(struct op_list));
-			assert((olist != NULL) && "alloc olist");
-			olist->next = NULL;
-			olist->o = o;
-
-			if (op16_root[i] == NULL) {
-				op16_root[i] = olist;
-				fn16_root[i] = fn;
-			} else {
-				fn16_root[i] = NULL;
-				olist->next = op16_root[i];
-				op16_root[i] = olist;
-			}
-		}
-	}
-
-	if (!inserted) {
-		WARN("Registration for %s was never inserted\n", fn_name);
+	if (ones_mask & zeros_mask) {
+		WARN("Registration for %s can never match\n", fn_name);
 		WARN("\t ones: %04x\n", ones_mask);
 		WARN("\tzeros: %04x\n", zeros_mask);
 		WARN("\t  exc: %d\n", o->op16.ex_cnt);
@@ -226,6 +199,9 @@ EXPORT int register_opcode_mask_16_ex_real(uint16_t ones_mask, uint16_t zeros_ma
 		ERR(E_BAD_OPCODE, "Uncallable instruction registered?\n");
 	}
 
+	if (!gen_decoder_bind(o, ones_mask, zeros_mask, o->op16.ex_cnt))
+		unbound_add(o);
+
 	va_end(va_args);
 	return ++opcode_masks;
 }
@@ -282,85 +258,21 @@ EXPORT int register_opcode_mask_32_ex_real(uint32_t ones_mask, uint32_t zeros_ma
 		exc_zeros_mask = va_arg(va_args, uint32_t);
 	}
 
-	////
-
-	bool inserted = false;
-	int i;
-	uint8_t ones_bucket = (ones_mask >> 19) & 0xff;
-	uint8_t zeros_bucket = (zeros_mask >> 19) & 0xff;
-	for (i = 0; i < 256; i++) {
-		if (
-				match_mask32(ones_mask, 0xe8000000, 0x10000000) &&
-				match_mask32(zeros_mask, 0x10000000, 0xe8000000)
-		   ){
-			if (match_mask8(i, ones_bucket, zeros_bucket)) {
-				inserted = true;
-
-				struct op_list* olist = malloc(sizeof(struct op_list));
-				assert((olist != NULL) && "alloc olist");
-				olist->next = NULL;
-				olist->o = o;
-
-				if (op32_11101_root[i] == NULL) {
-					op32_11101_root[i] = olist;
-					fn32_11101_root[i] = fn;
-				} else {
-					fn32_11101_root[i] = NULL;
-					olist->next = op32_11101_root[i];
-					op32_11101_root[i] = olist;
-				}
-			}
-		} else if (
-				match_mask32(ones_mask, 0xf0000000, 0x08000000) &&
-				match_mask32(zeros_mask, 0x08000000, 0xf0000000)
-			  ){
-			if (match_mask8(i, ones_bucket, zeros_bucket)) {
-				inserted = true;
-
-				struct op_list* olist = malloc(sizeof(struct op_list));
-				assert((olist != NULL) && "alloc olist");
-				olist->next = NULL;
-				olist->o = o;
-
-				if (op32_11110_root[i] == NULL) {
-					op32_11110_root[i] = olist;
-					fn32_11110_root[i] = fn;
-				} else {
-					fn32_11110_root[i] = NULL;
-					olist->next = op32_11110_root[i];
-					op32_11110_root[i] = olist;
-				}
-			}
-		} else if (
-				match_mask32(ones_mask, 0xf8000000, 0x0) &&
-				match_mask32(zeros_mask, 0x0, 0xf8000000)
-			  ){
-			if (match_mask8(i, ones_bucket, zeros_bucket)) {
-				inserted = true;
-
-				struct op_list* olist = malloc(sizeof(struct op_list));
-				assert((olist != NULL) && "alloc olist");
-				olist->next = NULL;
-				olist->o = o;
-
-				if (op32_11111_root[i] == NULL) {
-					op32_11111_root[i] = olist;
-					fn32_11111_root[i] = fn;
-				} else {
-					fn32_11111_root[i] = NULL;
-					olist->next = op32_11111_root[i];
-					op32_11111_root[i] = olist;
-				}
-			}
-		} else {
-			WARN("Troublesome: ones %08x zeros %08x name %s\n",
-					ones_mask, zeros_mask, fn_name);
-			ERR(E_BAD_OPCODE, "Legal 32-bit instructions begin with 111{01,10,11}\n");
-		}
+	bool legal =
+		(match_mask32(ones_mask, 0xe8000000, 0x10000000) &&
+		 match_mask32(zeros_mask, 0x10000000, 0xe8000000)) ||
+		(match_mask32(ones_mask, 0xf0000000, 0x08000000) &&
+		 match_mask32(zeros_mask, 0x08000000, 0xf0000000)) ||
+		(match_mask32(ones_mask, 0xf8000000, 0x0) &&
+		 match_mask32(zeros_mask, 0x0, 0xf8000000));
+	if (!legal) {
+		WARN("Troublesome: ones %08x zeros %08x name %s\n",
+				ones_mask, zeros_mask, fn_name);
+		ERR(E_BAD_OPCODE, "Legal 32-bit instructions begin with 111{01,10,11}\n");
 	}
 
-	if (!inserted) {
-		WARN("Registration for %s was never inserted\n", fn_name);
+	if (ones_mask & zeros_mask) {
+		WARN("Registration for %s can never match\n", fn_name);
 		WARN("\t ones: %08x\n", ones_mask);
 		WARN("\tzeros: %08x\n", zeros_mask);
 		WARN("\t  exc: %d\n", o->op32.ex_cnt);
@@ -372,6 +284,9 @@ EXPORT int register_opcode_mask_32_ex_real(uint32_t ones_mask, uint32_t zeros_ma
 		ERR(E_BAD_OPCODE, "Uncallable instruction registered?\n");
 	}
 
+	if (!gen_decoder_bind(o, ones_mask, zeros_mask, o->op32.ex_cnt))
+		unbound_add(o);
+
 	va_end(va_args);
 	return ++opcode_masks;
 }
@@ -381,74 +296,90 @@ EXPORT int register_opcode_mask_32_real(uint32_t ones_mask, uint32_t zeros_mask,
 	return register_opcode_mask_32_ex_real(ones_mask, zeros_mask, fn, fn_name, 0, 0);
 }
 
-////
-
 EXPORT void opcode_statistics(void) {
 #ifdef DEBUG1
-	int hist16[12] = {};
-	int hist32_11101[12] = {};
-	int hist32_11110[12] = {};
-	int hist32_11111[12] = {};
+	int bound = 0;
+	int unbound = 0;
 
 	int i;
-	for (i = 0; i < 256; i++) {
-		int j = 0;
-		struct op_list *olist = op16_root[i];
-		while (olist != NULL) {
-			j++;
-			olist = olist->next;
-		}
-		assert(j < 12);
-		hist16[j]++;
-	}
-	for (i = 0; i < 256; i++) {
-		int j = 0;
-		struct op_list *olist = op32_11101_root[i];
-		while (olist != NULL) {
-			j++;
-			olist = olist->next;
-		}
-		assert(j < 12);
-		hist32_11101[j]++;
-	}
-	for (i = 0; i < 256; i++) {
-		int j = 0;
-		struct op_list *olist = op32_11110_root[i];
-		while (olist != NULL) {
-			j++;
-			olist = olist->next;
+	for (i = 0; i < GEN_DECODER_SLOTS; i++)
+		if (gen_decoder_ops[i] != NULL)
+			bound++;
+
+	struct op_list *olist;
+	for (olist = unbound_ops; olist != NULL; olist = olist->next)
+		unbound++;
+
+	DBG1("%d of %d generated decoder slots bound, %d other op%s\n",
+			bound, GEN_DECODER_SLOTS, unbound, (unbound == 1) ? "":"s");
+#endif
+}
+
+// Adjacent pairs of executed ops (--pairstats)
+struct op_pair {
+	const struct op *first;
+	const struct op *second;
+	uint64_t count;
+};
+
+#define OP_PAIRS_BITS 14
+#define OP_PAIRS_SIZE (1 << OP_PAIRS_BITS)
+static struct op_pair op_pairs[OP_PAIRS_SIZE];
+static unsigned op_pairs_used;
+static const struct op *op_pairs_prev;
+
+EXPORT void opcode_pairs_count(const struct op *o) {
+	const struct op *prev = op_pairs_prev;
+	op_pairs_prev = o;
+	if (prev == NULL)
+		return;
+
+	unsigned i = ((((uintptr_t) prev) * 31) ^ ((uintptr_t) o)) >> 4;
+	for (i &= OP_PAIRS_SIZE - 1; op_pairs[i].first;
+			i = (i + 1) & (OP_PAIRS_SIZE - 1)) {
+		if ((op_pairs[i].first == prev) && (op_pairs[i].second == o)) {
+			op_pairs[i].count++;
+			return;
 		}
-		assert(j < 12);
-		hist32_11110[j]++;
 	}
-	for (i = 0; i < 256; i++) {
-		int j = 0;
-		struct op_list *olist = op32_11111_root[i];
-		while (olist != NULL) {
-			j++;
-			olist = olist->next;
+
+	if (op_pairs_used == OP_PAIRS_SIZE - 1) {
+		static bool warned = false;
+		if (!warned) {
+			WARN("Op pair table full, new pairs are not counted\n");
+			warned = true;
 		}
-		assert(j < 12);
-		hist32_11111[j]++;
+		return;
 	}
+	op_pairs_used++;
+	op_pairs[i].first = prev;
+	op_pairs[i].second = o;
+	op_pairs[i].count = 1;
+}
 
-	flockfile(stdout); flockfile(stderr);
-	_PP_EXTRA(stdout, 'D'); printf("hist16       ");
-	for (i = 0; i < 12; i++)
-		printf(" %2d: %3d", i, hist16[i]);
-	printf("\n");
-	_PP_EXTRA(stdout, 'D'); printf("hist32_11101 ");
-	for (i = 0; i < 12; i++)
-		printf(" %2d: %3d", i, hist32_11101[i]);
-	printf("\n");
-	_PP_EXTRA(stdout, 'D'); printf("hist32_11110 ");
-	for (i = 0; i < 12; i++)
-		printf(" %2d: %3d", i, hist32_11110[i]);
-	printf("\n");
-	_PP_EXTRA(stdout, 'D'); printf("hist32_11111 ");
-	for (i = 0; i < 12; i++)
-		printf(" %2d: %3d", i, hist32_11111[i]);
-	printf("\n");
-	funlockfile(stderr); funlockfile(stdout);
-#endif
+static int op_pair_cmp(const void *a, const void *b) {
+	const struct op_pair *pa = a;
+	const struct op_pair *pb = b;
+	if (pa->count != pb->count)
+		return (pa->count < pb->count) ? 1 : -1;
+	int ret = strcmp(pa->first->name, pb->first->name);
+	return ret ? ret : strcmp(pa->second->name, pb->second->name);
+}
+
+EXPORT unsigned opcode_pairs_dump(FILE *fp) {
+	struct op_pair *sorted = malloc(op_pairs_used * sizeof(*sorted) + 1);
+	assert(sorted && "Allocating op pair dump");
+
+	unsigned n = 0;
+	for (unsigned i = 0; i < OP_PAIRS_SIZE; i++)
+		if (op_pairs[i].first)
+			sorted[n++] = op_pairs[i];
+	qsort(sorted, n, sizeof(*sorted), op_pair_cmp);
+
+	for (unsigned i = 0; i < n; i++)
+		fprintf(fp, "%" PRIu64 "\t%s\t%s\n", sorted[i].count,
+				sorted[i].first->name, sorted[i].second->name);
+
+	free(sorted);
+	return n;
 }
@@ -50,7 +50,14 @@ bool match_mask8(uint8_t inst, uint8_t ones_mask, uint8_t zeros_mask) __attribut
 bool match_mask16(uint16_t inst, uint16_t ones_mask, uint16_t zeros_mask) __attribute__((const));
 bool match_mask32(uint32_t inst, uint32_t ones_mask, uint32_t zeros_mask) __attribute__((const));
 struct op* find_op(uint32_t inst) __attribute__((pure));
+// As find_op, but undefined encodings return NULL without raising an error
+struct op* find_op_quiet(uint32_t inst) __attribute__((pure));
 
 void opcode_statistics(void);
 
+// Histogram of adjacent executed ops, written as "count\tfirst\tsecond" lines
+// sorted by count. Returns the number of distinct pairs
+void opcode_pairs_count(const struct op *o);
+unsigned opcode_pairs_dump(FILE *fp);
+
 #endif //OPCODES_H
@@ -25,44 +25,39 @@
 void adc_imm(uint8_t rd, uint8_t rn, uint32_t imm32, bool setflags) {
 	uint32_t rn_val = CORE_reg_read(rn);
 
-	union apsr_t apsr = CORE_apsr_read();
 	uint32_t result;
 	bool carry;
 	bool overflow;
-	AddWithCarry(rn_val, imm32, apsr.bits.C, &result, &carry, &overflow);
+	AddWithCarry(rn_val, imm32, CORE_apsr_C_read(),
+			&result, &carry, &overflow);
 	CORE_reg_write(rd, result);
 
-	if (setflags) {
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry;
-		apsr.bits.V = overflow;
-		CORE_apsr_write(apsr);
-	}
+	if (setflags)
+		CORE_apsr_flags_add(rn_val, imm32, result);
 }
 
-void adc_reg(uint8_t rd, uint8_t rn, uint8_t rm,
+static inline __attribute__ ((always_inline))
+void adc_reg_tmpl(uint8_t rd, uint8_t rn, uint8_t rm,
 		bool setflags, enum SRType shift_t, uint8_t shift_n) {
-	union apsr_t apsr = CORE_apsr_read();
+	bool carry_in = CORE_apsr_C_read();
+	uint32_t rn_val = CORE_reg_read(rn);
 
-	uint32_t shifted = Shift(CORE_reg_read(rm), 32,
-			shift_t, shift_n, apsr.bits.C);
-
-	uint32_t result;
-	bool carry;
-	bool overflow;
-	AddWithCarry(CORE_reg_read(rn), shifted, apsr.bits.C,
-			&result, &carry, & overflow);
+	uint32_t shifted = shifted_reg(CORE_reg_read(rm), shift_t, shift_n);
+	uint32_t result = rn_val + shifted + carry_in;
 
 	CORE_reg_write(rd, result);
 
-	if (setflags) {
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry;
-		apsr.bits.V = overflow;
-		CORE_apsr_write(apsr);
-	}
+	if (setflags)
+		CORE_apsr_flags_add(rn_val, shifted, result);
+}
+
+void adc_reg(uint8_t rd, uint8_t rn, uint8_t rm,
+		bool setflags, enum SRType shift_t, uint8_t shift_n) {
+	adc_reg_tmpl(rd, rn, rm, setflags, shift_t, shift_n);
+}
+
+void adc_reg_lo(uint8_t rd, uint8_t rn, uint8_t rm, bool setflags) {
+	adc_reg_tmpl(rd & 0x7, rn & 0x7, rm & 0x7, setflags, LSL, 0);
 }
 
 void add_imm(uint8_t rn, uint8_t rd, uint32_t imm32, uint8_t setflags) {
@@ -75,51 +70,45 @@ void add_imm(uint8_t rn, uint8_t rd, uint32_t imm32, uint8_t setflags) {
 
 	CORE_reg_write(rd, result);
 
-	if (setflags) {
-		union apsr_t apsr = CORE_apsr_read();
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry;
-		apsr.bits.V = overflow;
-		CORE_apsr_write(apsr);
-	}
+	if (setflags)
+		CORE_apsr_flags_add(rn_val, imm32, result);
 
 	DBG2("add r%02d = r%02d + 0x%08x\t%08x = %08x + %08x\n",
 			rd, rn, imm32, result, rn_val, imm32);
 }
 
-void add_reg(uint8_t rd, uint8_t rn, uint8_t rm, bool setflags,
-		enum SRType shift_t, uint8_t shift_n) {
+static inline __attribute__ ((always_inline))
+void add_reg_tmpl(uint8_t rd, uint8_t rn, uint8_t rm, bool setflags,
+		enum SRType shift_t, uint8_t shift_n, bool lo) {
 	uint32_t rn_val = CORE_reg_read(rn);
-	uint32_t rm_val = CORE_reg_read(rm);
-
-	union apsr_t apsr = CORE_apsr_read();
+	uint32_t shifted = shifted_reg(CORE_reg_read(rm), shift_t, shift_n);
+	uint32_t result = rn_val + shifted;
 
-	uint32_t shifted;
-	shifted = Shift(rm_val, 32, shift_t, shift_n, apsr.bits.C);
-
-	uint32_t result;
-	bool carry;
-	bool overflow;
-	AddWithCarry(rn_val, shifted, 0, &result, &carry, &overflow);
-
-	if (rd == 15) {
+	if (!lo && (rd == 15)) {
 		// ALUWritePC
 		CORE_ERR_not_implemented("ALUWritePC case add_reg\n");
 	} else {
 		CORE_reg_write(rd, result);
-		if (setflags) {
-			apsr.bits.N = HIGH_BIT(result);
-			apsr.bits.Z = result == 0;
-			apsr.bits.C = carry;
-			apsr.bits.V = overflow;
-			CORE_apsr_write(apsr);
-		}
+		if (setflags)
+			CORE_apsr_flags_add(rn_val, shifted, result);
 	}
 
 	DBG2("add_reg r%02d = 0x%08x\n", rd, result);
 }
 
+void add_reg(uint8_t rd, uint8_t rn, uint8_t rm, bool setflags,
+		enum SRType shift_t, uint8_t shift_n) {
+	add_reg_tmpl(rd, rn, rm, setflags, shift_t, shift_n, false);
+}
+
+void add_reg_lo(uint8_t rd, uint8_t rn, uint8_t rm, bool setflags) {
+	add_reg_tmpl(rd & 0x7, rn & 0x7, rm & 0x7, setflags, LSL, 0, true);
+}
+
+void add_reg_hi(uint8_t rd, uint8_t rn, uint8_t rm) {
+	add_reg_tmpl(rd, rn, rm, false, LSL, 0, false);
+}
+
 void add_sp_plus_imm(uint8_t rd, uint32_t imm32, bool setflags) {
 	uint32_t sp_val = CORE_reg_read(SP_REG);
 
@@ -131,29 +120,16 @@ void add_sp_plus_imm(uint8_t rd, uint32_t imm32, bool setflags) {
 
 	CORE_reg_write(rd, result);
 
-	if (setflags) {
-		union apsr_t apsr = CORE_apsr_read();
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry;
-		apsr.bits.V = overflow;
-		CORE_apsr_write(apsr);
-	}
+	if (setflags)
+		CORE_apsr_flags_add(sp_val, imm32, result);
 }
 
 void add_sp_plus_reg(uint8_t rd, uint8_t rm,
 		bool setflags, enum SRType shift_t, uint8_t shift_n) {
+	uint32_t sp_val = CORE_reg_read(SP_REG);
 
-	union apsr_t apsr = CORE_apsr_read();
-
-	uint32_t shifted = Shift(CORE_reg_read(rm), 32,
-			shift_t, shift_n, apsr.bits.C);
-
-	uint32_t result;
-	bool carry;
-	bool overflow;
-	AddWithCarry(CORE_reg_read(SP_REG), shifted, 0,
-			&result, &carry, &overflow);
+	uint32_t shifted = shifted_reg(CORE_reg_read(rm), shift_t, shift_n);
+	uint32_t result = sp_val + shifted;
 
 	if (rd == 15) {
 		assert(setflags == false);
@@ -162,13 +138,8 @@ void add_sp_plus_reg(uint8_t rd, uint8_t rm,
 	} else {
 		CORE_reg_write(rd, result);
 
-		if (setflags) {
-			apsr.bits.N = HIGH_BIT(result);
-			apsr.bits.Z = result == 0;
-			apsr.bits.C = carry;
-			apsr.bits.V = overflow;
-			CORE_apsr_write(apsr);
-		}
+		if (setflags)
+			CORE_apsr_flags_add(sp_val, shifted, result);
 	}
 }
 
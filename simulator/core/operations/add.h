@@ -20,9 +20,12 @@
 void adc_imm(uint8_t rd, uint8_t rn, uint32_t imm32, bool setflags);
 void adc_reg(uint8_t rd, uint8_t rn, uint8_t rm,
 		bool setflags, enum SRType shift_t, uint8_t shift_n);
+void adc_reg_lo(uint8_t rd, uint8_t rn, uint8_t rm, bool setflags);
 void add_imm(uint8_t rn, uint8_t rd, uint32_t imm32, uint8_t setflags);
 void add_reg(uint8_t rd, uint8_t rn, uint8_t rm, bool setflags,
 		enum SRType shift_t, uint8_t shift_n);
+void add_reg_lo(uint8_t rd, uint8_t rn, uint8_t rm, bool setflags);
+void add_reg_hi(uint8_t rd, uint8_t rn, uint8_t rm);
 void add_sp_plus_imm(uint8_t rd, uint32_t imm32, bool setflags);
 void add_sp_plus_reg(uint8_t rd, uint8_t rm,
 		bool setflags, enum SRType shift_t, uint8_t shift_n);
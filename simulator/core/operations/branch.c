@@ -22,7 +22,8 @@
 #include "cpu/registers.h"
 #include "cpu/misc.h"
 #include "cpu/core.h"
-#include "core/simulator.h"
+#include "core/timing.h"
+#include "core/callstack.h"
 
 static void SelectInstrSet(uint8_t iset) {
 	switch (iset) {
@@ -57,9 +58,6 @@ void b(uint8_t cond, uint32_t imm32) {
 		BranchWritePC(pc + imm32);
 		DBG2("b taken old pc %08x new pc %08x (imm32: %08x)\n",
 				pc, CORE_reg_read(PC_REG), imm32);
-
-		//# cycles of Conditional/Unconditional taken Branches: 3
-		cycle = cycle + 2;
 	} else {
 		DBG2("b <not taken>\n");
 	}
@@ -86,6 +84,8 @@ void bl_blx(uint32_t pc, uint8_t targetInstrSet, uint32_t imm32) {
 	}
 
 	SelectInstrSet(targetInstrSet);
+	timing_bl();
+	CALLSTACK_CALL(targetAddress, lr);
 	BranchWritePC(targetAddress);
 }
 
@@ -93,6 +93,7 @@ void blx_reg(uint8_t rm) {
 	uint32_t target = CORE_reg_read(rm);
 	uint32_t next_instr_addr = CORE_reg_read(PC_REG) - 2;
 	CORE_reg_write(LR_REG, next_instr_addr | 0x1);
+	CALLSTACK_CALL(target, next_instr_addr);
 	BLXWritePC(target);
 }
 
@@ -105,10 +106,13 @@ void tbb(uint8_t rn, uint8_t rm, bool is_tbh) {
 	uint32_t rm_val = CORE_reg_read(rm);
 
 	uint32_t halfwords;
-	if (is_tbh)
+	if (is_tbh) {
+		timing_load(rn_val + (rm_val<<1));
 		halfwords = read_halfword(rn_val + (rm_val<<1));
-	else
+	} else {
+		timing_load(rn_val + rm_val);
 		halfwords = read_byte(rn_val + rm_val);
+	}
 
 	BranchWritePC(CORE_reg_read(PC_REG) + 2*halfwords);
 }
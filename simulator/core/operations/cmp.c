@@ -25,36 +25,30 @@
 
 void cmn_imm(uint8_t rn, uint32_t imm32) {
 	uint32_t rn_val = CORE_reg_read(rn);
-	union apsr_t apsr = CORE_apsr_read();
 
 	uint32_t result;
 	bool carry;
 	bool overflow;
 	AddWithCarry(rn_val, imm32, 0, &result, &carry, &overflow);
 
-	apsr.bits.N = HIGH_BIT(result);
-	apsr.bits.Z = result == 0;
-	apsr.bits.C = carry;
-	apsr.bits.V = overflow;
-	CORE_apsr_write(apsr);
+	CORE_apsr_flags_add(rn_val, imm32, result);
 }
 
-void cmn_reg(uint8_t rn, uint8_t rm, enum SRType shift_t, uint8_t shift_n) {
-	union apsr_t apsr = CORE_apsr_read();
+static inline __attribute__ ((always_inline))
+void cmn_reg_tmpl(uint8_t rn, uint8_t rm,
+		enum SRType shift_t, uint8_t shift_n) {
 	uint32_t rn_val = CORE_reg_read(rn);
-	uint32_t rm_val = CORE_reg_read(rm);
+	uint32_t shifted = shifted_reg(CORE_reg_read(rm), shift_t, shift_n);
 
-	uint32_t shifted = Shift(rm_val, 32, shift_t, shift_n, apsr.bits.C);
+	CORE_apsr_flags_add(rn_val, shifted, rn_val + shifted);
+}
 
-	uint32_t result;
-	bool carry_out, overflow_out;
-	AddWithCarry(rn_val, shifted, 0, &result, &carry_out, &overflow_out);
-
-	apsr.bits.N = HIGH_BIT(result);
-	apsr.bits.Z = result == 0;
-	apsr.bits.C = carry_out;
-	apsr.bits.V = overflow_out;
-	CORE_apsr_write(apsr);
+void cmn_reg(uint8_t rn, uint8_t rm, enum SRType shift_t, uint8_t shift_n) {
+	cmn_reg_tmpl(rn, rm, shift_t, shift_n);
+}
+
+void cmn_reg_lo(uint8_t rn, uint8_t rm) {
+	cmn_reg_tmpl(rn & 0x7, rm & 0x7, LSL, 0);
 }
 
 void cmp_imm(uint8_t rn, uint32_t imm32) {
@@ -69,81 +63,70 @@ void cmp_imm(uint8_t rn, uint32_t imm32) {
 	DBG2("result: %08x, carry: %d, overflow: %d\n",
 			result, carry_out, overflow_out);
 
-	union apsr_t apsr = CORE_apsr_read();
-	apsr.bits.N = HIGH_BIT(result);
-	apsr.bits.Z = result == 0;
-	apsr.bits.C = carry_out;
-	apsr.bits.V = overflow_out;
-	CORE_apsr_write(apsr);
+	CORE_apsr_flags_add(rn_val, ~imm32, result);
 }
 
-void cmp_reg(uint8_t rn, uint8_t rm, enum SRType shift_t, uint8_t shift_n) {
-	uint32_t rm_val = CORE_reg_read(rm);
+static inline __attribute__ ((always_inline))
+void cmp_reg_tmpl(uint8_t rn, uint8_t rm,
+		enum SRType shift_t, uint8_t shift_n) {
 	uint32_t rn_val = CORE_reg_read(rn);
+	uint32_t shifted = shifted_reg(CORE_reg_read(rm), shift_t, shift_n);
 
-	union apsr_t apsr = CORE_apsr_read();
-	uint32_t shifted = Shift(rm_val, 32, shift_t, shift_n, apsr.bits.C);
-
-	uint32_t result;
-	bool carry;
-	bool overflow;
-	AddWithCarry(rn_val, ~shifted, 1, &result, &carry, &overflow);
+	CORE_apsr_flags_add(rn_val, ~shifted, rn_val - shifted);
+}
 
-	//printf("shifted:%x ~shifted: %x, result:%x, rm_val: %x, rn_val: %x, carry: %d, overflow: %d\n",shifted, ~shifted, result,rm_val,rn_val, carry, overflow);
+void cmp_reg(uint8_t rn, uint8_t rm, enum SRType shift_t, uint8_t shift_n) {
+	cmp_reg_tmpl(rn, rm, shift_t, shift_n);
+}
 
-	apsr.bits.N = HIGH_BIT(result);
-	apsr.bits.Z = result == 0;
-	apsr.bits.C = carry;
-	apsr.bits.V = overflow;
-	CORE_apsr_write(apsr);
+void cmp_reg_lo(uint8_t rn, uint8_t rm) {
+	cmp_reg_tmpl(rn & 0x7, rm & 0x7, LSL, 0);
 }
 
 void teq_imm(uint8_t rn, uint32_t imm32, bool carry) {
 	uint32_t result = CORE_reg_read(rn) ^ imm32;
-	union apsr_t apsr = CORE_apsr_read();
-	apsr.bits.N = HIGH_BIT(result);
-	apsr.bits.Z = result == 0;
-	apsr.bits.C = carry;
-	CORE_apsr_write(apsr);
+	CORE_apsr_flags_nzc(result, carry);
 }
 
 void teq_reg(uint8_t rn, uint8_t rm, enum SRType shift_t, uint8_t shift_n) {
-	union apsr_t apsr = CORE_apsr_read();
-
 	uint32_t shifted;
 	bool carry;
-	Shift_C(CORE_reg_read(rm), 32, shift_t, shift_n, apsr.bits.C,
+	bool shifter_carry = shifted_reg_c(CORE_reg_read(rm), shift_t, shift_n,
 			&shifted, &carry);
 	uint32_t result = CORE_reg_read(rn) ^ shifted;
 
-	apsr.bits.N = HIGH_BIT(result);
-	apsr.bits.Z = result == 0;
-	apsr.bits.C = carry;
-	CORE_apsr_write(apsr);
+	if (shifter_carry)
+		CORE_apsr_flags_nzc(result, carry);
+	else
+		CORE_apsr_flags_nz(result);
 }
 
 void tst_imm(uint8_t rn, uint32_t imm32, bool carry) {
 	uint32_t rn_val = CORE_reg_read(rn);
-	union apsr_t apsr = CORE_apsr_read();
 
 	uint32_t result = rn_val & imm32;
-	apsr.bits.N = HIGH_BIT(result);
-	apsr.bits.Z = result == 0;
-	apsr.bits.C = carry;
-	CORE_apsr_write(apsr);
+	CORE_apsr_flags_nzc(result, carry);
 }
 
-void tst_reg(uint8_t rn, uint8_t rm, enum SRType shift_t, uint8_t shift_n) {
-	union apsr_t apsr = CORE_apsr_read();
-
+static inline __attribute__ ((always_inline))
+void tst_reg_tmpl(uint8_t rn, uint8_t rm,
+		enum SRType shift_t, uint8_t shift_n) {
 	uint32_t shifted;
 	bool carry;
-	Shift_C(CORE_reg_read(rm), 32, shift_t, shift_n, apsr.bits.C,
+	bool shifter_carry = shifted_reg_c(CORE_reg_read(rm), shift_t, shift_n,
 			&shifted, &carry);
 
 	uint32_t result = CORE_reg_read(rn) & shifted;
-	apsr.bits.N = HIGH_BIT(result);
-	apsr.bits.Z = result == 0;
-	apsr.bits.C = carry;
-	CORE_apsr_write(apsr);
+	if (shifter_carry)
+		CORE_apsr_flags_nzc(result, carry);
+	else
+		CORE_apsr_flags_nz(result);
+}
+
+void tst_reg(uint8_t rn, uint8_t rm, enum SRType shift_t, uint8_t shift_n) {
+	tst_reg_tmpl(rn, rm, shift_t, shift_n);
+}
+
+void tst_reg_lo(uint8_t rn, uint8_t rm) {
+	tst_reg_tmpl(rn & 0x7, rm & 0x7, LSL, 0);
 }
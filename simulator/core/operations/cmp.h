@@ -19,9 +19,12 @@
 
 void cmn_imm(uint8_t rn, uint32_t imm32);
 void cmn_reg(uint8_t rn, uint8_t rm, enum SRType shift_t, uint8_t shift_n);
+void cmn_reg_lo(uint8_t rn, uint8_t rm);
 void cmp_imm(uint8_t rn, uint32_t imm32);
 void cmp_reg(uint8_t rn, uint8_t rm, enum SRType shift_t, uint8_t shift_n);
+void cmp_reg_lo(uint8_t rn, uint8_t rm);
 void teq_imm(uint8_t rn, uint32_t imm32, bool carry);
 void teq_reg(uint8_t rn, uint8_t rm, enum SRType shift_t, uint8_t shift_n);
 void tst_imm(uint8_t rn, uint32_t imm32, bool carry);
 void tst_reg(uint8_t rn, uint8_t rm, enum SRType shift_t, uint8_t shift_n);
+void tst_reg_lo(uint8_t rn, uint8_t rm);
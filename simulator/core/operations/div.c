@@ -21,6 +21,7 @@
 
 #include "cpu/registers.h"
 #include "cpu/exception.h"
+#include "core/timing.h"
 
 //#include "cpu/common/private_peripheral_bus/ppb.h"
 //#define DIV_0_TRP (read_word(CONFIGURATION_CONTROL) & CONFIGURATION_CONTROL_DIV_0_TRAP_MASK)
@@ -41,6 +42,7 @@ void sdiv(uint8_t rd, uint8_t rn, uint8_t rm) {
 		result = rn_val / rm_val;
 	}
 
+	timing_div(result, true);
 	CORE_reg_write(rd, result);
 }
 
@@ -59,6 +61,7 @@ void udiv(uint8_t rd, uint8_t rn, uint8_t rm) {
 		result = rn_val / rm_val;
 	}
 
+	timing_div(result, false);
 	CORE_reg_write(rd, result);
 }
 
@@ -21,6 +21,8 @@
 
 #include "cpu/exception.h"
 #include "cpu/registers.h"
+#include "core/timing.h"
+#include "core/callstack.h"
 
 /* From Bit Twiddling Hacks:
  * http://graphics.stanford.edu/~seander/bithacks.html#BitReverseTable */
@@ -77,11 +79,8 @@ void AddWithCarry(uint32_t x, uint32_t y, bool carry_in,
 	if (*result == usum) *carry_out = 0;
 	else                 *carry_out = 1;
 
-	//if (((int32_t)(*result)) == ssum) *overflow_out = 0;
-	//else                 *overflow_out = 1;
-	if(sx64>0 && sy64>0 && ssum<0) 		*overflow_out = 1;
-	else if(sx64<0 && sy64<0 && ssum>0) 	*overflow_out = 1;
-	else 					*overflow_out = 0;
+	if (((int32_t)(*result)) == ssum) *overflow_out = 0;
+	else                              *overflow_out = 1;
 
 	DBG2("x %08x, y %08x, carry %d\n", x, y, carry_in);
 	DBG2("usum %09"PRIx64", ssum %09"PRIx64", result %08x, carry %d, ovflw %d\n",
@@ -92,12 +91,14 @@ void AddWithCarry(uint32_t x, uint32_t y, bool carry_in,
 }
 
 void LoadWritePC(uint32_t addr) {
+	timing_load_pc();
 	BXWritePC(addr);
 }
 
 void BXWritePC(uint32_t addr) {
 	if ((CORE_CurrentMode_read() == Mode_Handler)
 			&& ((addr & 0xf0000000) == 0xf0000000)) {
+		timing_branch(addr);
 		exception_return(addr);
 	} else {
 		BLXWritePC(addr);
@@ -110,6 +111,8 @@ void BLXWritePC(uint32_t addr) {
 }
 
 void BranchTo(uint32_t addr) {
+	timing_branch(addr);
+	CALLSTACK_BRANCH(addr);
 	CORE_reg_write(PC_REG, addr);
 }
 
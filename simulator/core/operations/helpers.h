@@ -23,6 +23,8 @@
 #include "core/common.h"
 #include "core/isa/arm_types.h"
 
+#include "cpu/registers.h"
+
 //XXX ?
 #include "core/isa/decode_helpers.h"
 
@@ -34,6 +36,70 @@ void AddWithCarry(uint32_t x, uint32_t y, bool carry_in,
 		uint32_t *result, bool *carry_out, bool *overflow_out)
 		__attribute__ ((nonnull));
 
+/* Operation templates
+ *
+ * The register forms of the data-processing operations are written once, as
+ * always_inline <op>_tmpl bodies taking the setflags, shift and register class
+ * arguments the decoder extracts. The exported generic entry point passes
+ * them through at run time; the <op>_lo variants that the 16-bit decoders bind
+ * to (low registers, no shift) pass constants, so the shifter, the PC write
+ * check and the Shift()/AddWithCarry() calls fold away.
+ */
+
+// Shift_C() for an immediate shift of 1..32 (0 is handled by the callers)
+static inline __attribute__ ((always_inline))
+void Shift_C_imm(uint32_t value, enum SRType type, uint8_t amount,
+		uint32_t *result, bool *carry_out) {
+	switch (type) {
+		case LSL:
+			*result = (amount == 32) ? 0 : value << amount;
+			*carry_out = (value >> (32 - amount)) & 0x1;
+			break;
+		case LSR:
+			*result = (amount == 32) ? 0 : value >> amount;
+			*carry_out = (value >> (amount - 1)) & 0x1;
+			break;
+		case ASR:
+			*result = ((int32_t) value) >> ((amount == 32) ? 31 : amount);
+			*carry_out = (value >> (amount - 1)) & 0x1;
+			break;
+		case ROR:
+			*result = (value >> (amount & 0x1f)) |
+				(value << ((32 - amount) & 0x1f));
+			*carry_out = *result >> 31;
+			break;
+		default:
+			Shift_C(value, 32, type, amount, CORE_apsr_C_read(),
+					result, carry_out);
+	}
+}
+
+// The shifted register operand; a shift by 0 leaves the value (and C) alone
+static inline __attribute__ ((always_inline))
+uint32_t shifted_reg(uint32_t value, enum SRType type, uint8_t amount) {
+	if (amount == 0)
+		return value;
+
+	uint32_t result;
+	bool carry_out;
+	Shift_C_imm(value, type, amount, &result, &carry_out);
+	return result;
+}
+
+// As shifted_reg, with the shifter carry. Returns false, leaving *carry_out
+// unset, when the shift does not change C
+static inline __attribute__ ((always_inline))
+bool shifted_reg_c(uint32_t value, enum SRType type, uint8_t amount,
+		uint32_t *result, bool *carry_out) {
+	if (amount == 0) {
+		*result = value;
+		return false;
+	}
+
+	Shift_C_imm(value, type, amount, result, carry_out);
+	return true;
+}
+
 void LoadWritePC(uint32_t addr);
 void BXWritePC(uint32_t addr);
 void BLXWritePC(uint32_t addr);
@@ -22,18 +22,19 @@
 #include "cpu/registers.h"
 #include "cpu/core.h"
 #include "cpu/misc.h"
-#include "core/simulator.h"
+#include "core/timing.h"
 
 void ldm(uint8_t rn, uint16_t registers, bool wback) {
 	uint32_t address = CORE_reg_read(rn);
 
-	int i;
+	uint32_t vals[15];
+	timing_load_multiple(address, hamming(registers & 0x7fff));
+	read_words(address, vals, hamming(registers & 0x7fff));
+
+	int i, v = 0;
 	for (i = 0; i <= 14; i++) {	// stupid arm inclusive for
 		if (registers & (1 << i)) {
-			CORE_reg_write(i, read_word(address));
-			address += 4;
-			//# cycles of Load Multiple: 1+N
-			cycle++;
+			CORE_reg_write(i, vals[v++]);
 		}
 	}
 	if (registers & 0x8000) {
@@ -50,13 +51,14 @@ void ldm(uint8_t rn, uint16_t registers, bool wback) {
 void ldmdb(uint8_t rn, uint16_t registers, bool wback) {
 	uint32_t address = CORE_reg_read(rn) - 4*hamming(registers);
 
-	int i;
+	uint32_t vals[14];
+	timing_load_multiple(address, hamming(registers & 0x3fff));
+	read_words(address, vals, hamming(registers & 0x3fff));
+
+	int i, v = 0;
 	for (i=0;i<14;i++) {
 		if (registers & (1 << i)) {
-			CORE_reg_write(i, read_word(address));
-			address += 4;
-			//# cycles of Load Multiple: 1+N
-			cycle++;
+			CORE_reg_write(i, vals[v++]);
 		}
 	}
 	if (registers & (1 << 15)) {
@@ -22,6 +22,7 @@
 #include "cpu/registers.h"
 #include "cpu/core.h"
 #include "cpu/misc.h"
+#include "core/timing.h"
 
 void ldr_imm(uint8_t rt, uint8_t rn, uint32_t imm32, bool index, bool add, bool wback) {
 	uint32_t rn_val = CORE_reg_read(rn);
@@ -38,6 +39,7 @@ void ldr_imm(uint8_t rt, uint8_t rn, uint32_t imm32, bool index, bool add, bool
 	else
 		address = rn_val;
 
+	timing_load(address);
 	uint32_t data = read_word(address);
 
 	if (wback)
@@ -75,6 +77,7 @@ void ldr_reg(uint8_t rt, uint8_t rn, uint8_t rm,
 	else
 		address = rn_val;
 
+	timing_load(address);
 	uint32_t data = read_word(address);
 
 	if (wback)
@@ -100,6 +103,7 @@ void ldr_lit(bool add, uint8_t rt, uint32_t imm32) {
 		addr = base - imm32;
 	}
 
+	timing_load(addr);
 	uint32_t data = read_word(addr);
 
 	if (rt == 15) {
@@ -128,6 +132,7 @@ void ldrb_imm(uint8_t rt, uint8_t rn, uint32_t imm32, bool add, bool index, bool
 	else
 		address = rn_val;
 
+	timing_load(address);
 	CORE_reg_write(rt, read_byte(address));
 
 	if (wback)
@@ -143,6 +148,7 @@ void ldrb_lit(uint8_t rt, uint32_t imm32, bool add) {
 	else
 		address = base - imm32;
 
+	timing_load(address);
 	CORE_reg_write(rt, read_byte(address));
 }
 
@@ -169,6 +175,7 @@ void ldrb_reg(uint8_t rt, uint8_t rn, uint8_t rm,
 	else
 		address = rn_val;
 
+	timing_load(address);
 	CORE_reg_write(rt, read_byte(address));
 }
 
@@ -188,6 +195,7 @@ void ldrd_imm(uint8_t rt, uint8_t rt2, uint8_t rn, uint32_t imm32,
 		addr = CORE_reg_read(rn);
 	}
 
+	timing_load_multiple(addr, 2);
 	CORE_reg_write(rt, read_word(addr));
 	CORE_reg_write(rt2, read_word(addr + 4));
 
@@ -204,6 +212,7 @@ void ldrd_lit(uint8_t rt, uint8_t rt2, uint32_t imm32, bool add) {
 	uint32_t address;
 	address = (add) ? pc_val + imm32 : pc_val - imm32;
 
+	timing_load_multiple(address, 2);
 	CORE_reg_write(rt, read_word(address));
 	CORE_reg_write(rt2, read_word(address+4));
 }
@@ -218,6 +227,7 @@ void ldrh_imm(uint8_t rt, uint8_t rn, uint32_t imm32,
 	uint32_t address;
 	address = (index) ? offset_addr : rn_val;
 
+	timing_load(address);
 	uint32_t data;
 	data = read_halfword(address);
 
@@ -232,6 +242,7 @@ void ldrh_lit(uint8_t rt, uint32_t imm32, bool add) {
 	uint32_t base = pc_val & ~0x3;
 	uint32_t address;
 	address = (add) ? base + imm32 : base - imm32;
+	timing_load(address);
 	uint32_t data = read_halfword(address);
 	CORE_reg_write(rt, data);
 }
@@ -251,6 +262,7 @@ void ldrh_reg(uint8_t rt, uint8_t rn, uint8_t rm,
 	uint32_t address;
 	address = (index) ? offset_addr : rn_val;
 
+	timing_load(address);
 	uint32_t data = read_halfword(address);
 
 	if (wback)
@@ -269,6 +281,7 @@ void ldrsb_imm(uint8_t rt, uint8_t rn, uint32_t imm32,
 	uint32_t address;
 	address = (index) ? offset_addr : rn_val;
 
+	timing_load(address);
 	int8_t sbyte = (int8_t) read_byte(address);
 	int32_t sword = sbyte;
 	CORE_reg_write(rt, (uint32_t) sword);
@@ -283,6 +296,7 @@ void ldrsb_lit(uint8_t rt, uint32_t imm32, bool add) {
 	uint32_t address;
 	address = (add) ? base + imm32 : base - imm32;
 
+	timing_load(address);
 	int8_t sbyte = (int8_t) read_byte(address);
 	int32_t sword = sbyte;
 	CORE_reg_write(rt, (uint32_t) sword);
@@ -311,6 +325,7 @@ void ldrsb_reg(uint8_t rt, uint8_t rn, uint8_t rm,
 	else
 		address = rn_val;
 
+	timing_load(address);
 	int32_t signd = (int32_t) read_byte(address);
 	CORE_reg_write(rt, signd);
 }
@@ -325,6 +340,7 @@ void ldrsh_imm(uint8_t rt, uint8_t rn, uint32_t imm32,
 	uint32_t address;
 	address = (index) ? offset_addr : rn_val;
 
+	timing_load(address);
 	int16_t shword = (int16_t) read_halfword(address);
 	int32_t sword = shword;
 	CORE_reg_write(rt, (uint32_t) sword);
@@ -339,6 +355,7 @@ void ldrsh_lit(uint8_t rt, uint32_t imm32, bool add) {
 	uint32_t address;
 	address = (add) ? base + imm32 : base - imm32;
 
+	timing_load(address);
 	int16_t shword = (int16_t) read_halfword(address);
 	int32_t sword = shword;
 	CORE_reg_write(rt, (uint32_t) sword);
@@ -358,6 +375,7 @@ void ldrsh_reg(uint8_t rt, uint8_t rn, uint8_t rm,
 	uint32_t address;
 	address = (index) ? offset_addr : rn_val;
 
+	timing_load(address);
 	int16_t shword = (int16_t) read_halfword(address);
 	int32_t sword = shword;
 	CORE_reg_write(rt, (uint32_t) sword);
@@ -22,7 +22,7 @@
 #include "cpu/registers.h"
 #include "cpu/misc.h"
 
-void and_imm(union apsr_t apsr, uint8_t setflags, uint8_t rd, uint8_t rn,
+void and_imm(uint8_t setflags, uint8_t rd, uint8_t rn,
 		uint32_t imm32, uint8_t carry) {
 	uint32_t rn_val = CORE_reg_read(rn);
 
@@ -32,198 +32,216 @@ void and_imm(union apsr_t apsr, uint8_t setflags, uint8_t rd, uint8_t rn,
 		CORE_ERR_not_implemented("ALUWritePC and_imm\n");
 	} else {
 		CORE_reg_write(rd, result);
-		if (setflags) {
-			apsr.bits.N = HIGH_BIT(result);
-			apsr.bits.Z = result == 0;
-			apsr.bits.C = carry;
-			CORE_apsr_write(apsr);
-		}
+		if (setflags)
+			CORE_apsr_flags_nzc(result, carry);
 	}
 
 	DBG2("and_imm done\n");
 }
 
-void and_reg(uint8_t rd, uint8_t rn, uint8_t rm,
+static inline __attribute__ ((always_inline))
+void and_reg_tmpl(uint8_t rd, uint8_t rn, uint8_t rm,
 		bool setflags, enum SRType shift_t, uint8_t shift_n) {
 	uint32_t rn_val = CORE_reg_read(rn);
-	uint32_t rm_val = CORE_reg_read(rm);
-	union apsr_t apsr = CORE_apsr_read();
 
 	uint32_t shifted;
 	bool carry_out;
-	Shift_C(rm_val, 32, shift_t, shift_n, apsr.bits.C, &shifted, &carry_out);
+	bool shifter_carry = shifted_reg_c(CORE_reg_read(rm), shift_t, shift_n,
+			&shifted, &carry_out);
 
 	uint32_t result = rn_val & shifted;
 	CORE_reg_write(rd, result);
 
 	if (setflags) {
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry_out;
-		CORE_apsr_write(apsr);
+		if (shifter_carry)
+			CORE_apsr_flags_nzc(result, carry_out);
+		else
+			CORE_apsr_flags_nz(result);
 	}
 }
 
-void bic_imm(union apsr_t apsr, uint8_t setflags,
+void and_reg(uint8_t rd, uint8_t rn, uint8_t rm,
+		bool setflags, enum SRType shift_t, uint8_t shift_n) {
+	and_reg_tmpl(rd, rn, rm, setflags, shift_t, shift_n);
+}
+
+void and_reg_lo(uint8_t rd, uint8_t rn, uint8_t rm, bool setflags) {
+	and_reg_tmpl(rd & 0x7, rn & 0x7, rm & 0x7, setflags, LSL, 0);
+}
+
+void bic_imm(uint8_t setflags,
 		uint8_t rd, uint8_t rn, uint32_t imm32, uint8_t carry) {
 	uint32_t result = CORE_reg_read(rn) & (~imm32);
 	CORE_reg_write(rd, result);
 
-	if (setflags) {
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry;
-		CORE_apsr_write(apsr);
-	}
+	if (setflags)
+		CORE_apsr_flags_nzc(result, carry);
 }
 
-void bic_reg(uint8_t rd, uint8_t rn, uint8_t rm,
+static inline __attribute__ ((always_inline))
+void bic_reg_tmpl(uint8_t rd, uint8_t rn, uint8_t rm,
 		bool setflags, enum SRType shift_t, uint8_t shift_n) {
-	union apsr_t apsr = CORE_apsr_read();
-
 	uint32_t shifted;
 	bool carry_out;
-	Shift_C(CORE_reg_read(rm), 32, shift_t, shift_n, apsr.bits.C,
+	bool shifter_carry = shifted_reg_c(CORE_reg_read(rm), shift_t, shift_n,
 			&shifted, &carry_out);
 
 	uint32_t result = CORE_reg_read(rn) & ~shifted;
 	CORE_reg_write(rd, result);
 
 	if (setflags) {
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry_out;
-		CORE_apsr_write(apsr);
+		if (shifter_carry)
+			CORE_apsr_flags_nzc(result, carry_out);
+		else
+			CORE_apsr_flags_nz(result);
 	}
 }
 
+void bic_reg(uint8_t rd, uint8_t rn, uint8_t rm,
+		bool setflags, enum SRType shift_t, uint8_t shift_n) {
+	bic_reg_tmpl(rd, rn, rm, setflags, shift_t, shift_n);
+}
+
+void bic_reg_lo(uint8_t rd, uint8_t rn, uint8_t rm, bool setflags) {
+	bic_reg_tmpl(rd & 0x7, rn & 0x7, rm & 0x7, setflags, LSL, 0);
+}
+
 void eor_imm(uint8_t rd, uint8_t rn, uint32_t imm32,
-		bool carry, bool setflags, union apsr_t apsr) {
+		bool carry, bool setflags) {
 	uint32_t rn_val = CORE_reg_read(rn);
 
 	uint32_t result = rn_val ^ imm32;
 	CORE_reg_write(rd, result);
 
-	if (setflags) {
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry;
-		CORE_apsr_write(apsr);
-	}
+	if (setflags)
+		CORE_apsr_flags_nzc(result, carry);
 }
 
-void eor_reg(uint8_t setflags, uint8_t rd, uint8_t rn, uint8_t rm,
+static inline __attribute__ ((always_inline))
+void eor_reg_tmpl(uint8_t setflags, uint8_t rd, uint8_t rn, uint8_t rm,
 		enum SRType shift_t, uint8_t shift_n) {
 	uint32_t result;
 	bool carry_out;
 
-	union apsr_t apsr = CORE_apsr_read();
-
-	Shift_C(CORE_reg_read(rm), 32, shift_t, shift_n, apsr.bits.C, &result, &carry_out);
+	bool shifter_carry = shifted_reg_c(CORE_reg_read(rm), shift_t, shift_n,
+			&result, &carry_out);
 
 	result = CORE_reg_read(rn) ^ result;
 	CORE_reg_write(rd, result);
 
 	if (setflags) {
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry_out;
-		CORE_apsr_write(apsr);
+		if (shifter_carry)
+			CORE_apsr_flags_nzc(result, carry_out);
+		else
+			CORE_apsr_flags_nz(result);
 	}
 }
 
-void mvn_imm(uint8_t rd, bool setflags, union apsr_t apsr,
+void eor_reg(uint8_t setflags, uint8_t rd, uint8_t rn, uint8_t rm,
+		enum SRType shift_t, uint8_t shift_n) {
+	eor_reg_tmpl(setflags, rd, rn, rm, shift_t, shift_n);
+}
+
+void eor_reg_lo(uint8_t rd, uint8_t rn, uint8_t rm, bool setflags) {
+	eor_reg_tmpl(setflags, rd & 0x7, rn & 0x7, rm & 0x7, LSL, 0);
+}
+
+void mvn_imm(uint8_t rd, bool setflags,
 		uint32_t imm32, bool carry) {
 	uint32_t result = ~imm32;
 	CORE_reg_write(rd, result);
-	if (setflags) {
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry;
-		CORE_apsr_write(apsr);
-	}
+	if (setflags)
+		CORE_apsr_flags_nzc(result, carry);
 }
 
-void mvn_reg(uint8_t setflags, uint8_t rd, uint8_t rm,
+static inline __attribute__ ((always_inline))
+void mvn_reg_tmpl(uint8_t setflags, uint8_t rd, uint8_t rm,
 		enum SRType shift_t, uint8_t shift_n) {
 	uint32_t result;
 	bool carry_out;
 
-	union apsr_t apsr = CORE_apsr_read();
-
-	Shift_C(CORE_reg_read(rm), 32, shift_t, shift_n, apsr.bits.C, &result, &carry_out);
+	bool shifter_carry = shifted_reg_c(CORE_reg_read(rm), shift_t, shift_n,
+			&result, &carry_out);
 
 	result = ~result;
 	CORE_reg_write(rd, result);
 
 	if (setflags) {
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry_out;
-		CORE_apsr_write(apsr);
+		if (shifter_carry)
+			CORE_apsr_flags_nzc(result, carry_out);
+		else
+			CORE_apsr_flags_nz(result);
 	}
 }
 
+void mvn_reg(uint8_t setflags, uint8_t rd, uint8_t rm,
+		enum SRType shift_t, uint8_t shift_n) {
+	mvn_reg_tmpl(setflags, rd, rm, shift_t, shift_n);
+}
+
+void mvn_reg_lo(uint8_t rd, uint8_t rm, bool setflags) {
+	mvn_reg_tmpl(setflags, rd & 0x7, rm & 0x7, LSL, 0);
+}
+
 void orn_imm(uint8_t rd, uint8_t rn, bool setflags,
-		union apsr_t apsr, uint32_t imm32, bool carry) {
+		uint32_t imm32, bool carry) {
 	uint32_t result = CORE_reg_read(rn) | ~imm32;
 	CORE_reg_write(rd, result);
-	if (setflags) {
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry;
-		CORE_apsr_write(apsr);
-	}
+	if (setflags)
+		CORE_apsr_flags_nzc(result, carry);
 }
 
 void orn_reg(uint8_t rd, uint8_t rn, uint8_t rm,
 		bool setflags, enum SRType shift_t, uint8_t shift_n) {
-	union apsr_t apsr = CORE_apsr_read();
-
 	uint32_t shifted;
 	bool carry_out;
-	Shift_C(CORE_reg_read(rm), 32, shift_t, shift_n, apsr.bits.C,
+	bool shifter_carry = shifted_reg_c(CORE_reg_read(rm), shift_t, shift_n,
 			&shifted, &carry_out);
 
 	uint32_t result = CORE_reg_read(rn) | ~shifted;
 	CORE_reg_write(rd, result);
 
 	if (setflags) {
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry_out;
-		CORE_apsr_write(apsr);
+		if (shifter_carry)
+			CORE_apsr_flags_nzc(result, carry_out);
+		else
+			CORE_apsr_flags_nz(result);
 	}
 }
 
 void orr_imm(uint8_t rd, uint8_t rn, bool setflags,
-		union apsr_t apsr, uint32_t imm32, bool carry) {
+		uint32_t imm32, bool carry) {
 	uint32_t result = CORE_reg_read(rn) | imm32;
 	CORE_reg_write(rd, result);
-	if (setflags) {
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry;
-		CORE_apsr_write(apsr);
-	}
+	if (setflags)
+		CORE_apsr_flags_nzc(result, carry);
 }
 
-void orr_reg(uint8_t setflags, uint8_t rd, uint8_t rn, uint8_t rm,
+static inline __attribute__ ((always_inline))
+void orr_reg_tmpl(uint8_t setflags, uint8_t rd, uint8_t rn, uint8_t rm,
 		enum SRType shift_t, uint8_t shift_n) {
 	uint32_t result;
 	bool carry_out;
 
-	union apsr_t apsr = CORE_apsr_read();
-
-	Shift_C(CORE_reg_read(rm), 32, shift_t, shift_n, apsr.bits.C, &result, &carry_out);
+	bool shifter_carry = shifted_reg_c(CORE_reg_read(rm), shift_t, shift_n,
+			&result, &carry_out);
 
 	result = CORE_reg_read(rn) | result;
 	CORE_reg_write(rd, result);
 
 	if (setflags) {
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry_out;
-		CORE_apsr_write(apsr);
+		if (shifter_carry)
+			CORE_apsr_flags_nzc(result, carry_out);
+		else
+			CORE_apsr_flags_nz(result);
 	}
 }
+
+void orr_reg(uint8_t setflags, uint8_t rd, uint8_t rn, uint8_t rm,
+		enum SRType shift_t, uint8_t shift_n) {
+	orr_reg_tmpl(setflags, rd, rn, rm, shift_t, shift_n);
+}
+
+void orr_reg_lo(uint8_t rd, uint8_t rn, uint8_t rm, bool setflags) {
+	orr_reg_tmpl(setflags, rd & 0x7, rn & 0x7, rm & 0x7, LSL, 0);
+}
@@ -17,28 +17,33 @@
  * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-void and_imm(union apsr_t apsr, uint8_t setflags, uint8_t rd, uint8_t rn,
+void and_imm(uint8_t setflags, uint8_t rd, uint8_t rn,
 		uint32_t imm32, uint8_t carry);
 void and_reg(uint8_t rd, uint8_t rn, uint8_t rm,
 		bool setflags, enum SRType shift_t, uint8_t shift_n);
-void bic_imm(union apsr_t apsr, uint8_t setflags,
+void and_reg_lo(uint8_t rd, uint8_t rn, uint8_t rm, bool setflags);
+void bic_imm(uint8_t setflags,
 		uint8_t rd, uint8_t rn, uint32_t imm32, uint8_t carry);
 void bic_reg(uint8_t rd, uint8_t rn, uint8_t rm,
 		bool setflags, enum SRType shift_t, uint8_t shift_n);
+void bic_reg_lo(uint8_t rd, uint8_t rn, uint8_t rm, bool setflags);
 void eor_imm(uint8_t rd, uint8_t rn, uint32_t imm32,
-		bool carry, bool setflags, union apsr_t apsr);
+		bool carry, bool setflags);
 void eor_reg(uint8_t setflags, uint8_t rd, uint8_t rn, uint8_t rm,
 		enum SRType shift_t, uint8_t shift_n);
-void mvn_imm(uint8_t rd, bool setflags, union apsr_t apsr,
+void eor_reg_lo(uint8_t rd, uint8_t rn, uint8_t rm, bool setflags);
+void mvn_imm(uint8_t rd, bool setflags,
 		uint32_t imm32, bool carry);
 void mvn_reg(uint8_t setflags, uint8_t rd, uint8_t rm,
 		enum SRType shift_t, uint8_t shift_n);
+void mvn_reg_lo(uint8_t rd, uint8_t rm, bool setflags);
 void orn_imm(uint8_t rd, uint8_t rn, bool setflags,
-		union apsr_t apsr, uint32_t imm32, bool carry);
+		uint32_t imm32, bool carry);
 void orn_reg(uint8_t rd, uint8_t rn, uint8_t rm,
 		bool setflags, enum SRType shift_t, uint8_t shift_n);
 void orr_imm(uint8_t rd, uint8_t rn, bool setflags,
-		union apsr_t apsr, uint32_t imm32, bool carry);
+		uint32_t imm32, bool carry);
 void orr_reg(uint8_t setflags, uint8_t rd, uint8_t rn, uint8_t rm,
 		enum SRType shift_t, uint8_t shift_n);
+void orr_reg_lo(uint8_t rd, uint8_t rn, uint8_t rm, bool setflags);
 
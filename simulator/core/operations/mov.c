@@ -23,7 +23,7 @@
 #include "cpu/registers.h"
 #include "cpu/misc.h"
 
-void mov_imm(union apsr_t apsr, uint8_t setflags, uint32_t imm32, uint8_t rd, uint8_t carry){
+void mov_imm(uint8_t setflags, uint32_t imm32, uint8_t rd, uint8_t carry){
 	uint32_t result = imm32;
 
 	// 32-bit Thumb encoding can't use PC, but 16-bit thumb can use PC
@@ -32,12 +32,8 @@ void mov_imm(union apsr_t apsr, uint8_t setflags, uint32_t imm32, uint8_t rd, ui
 	//	//ALUWritePC(result);
 	//} else {
 		CORE_reg_write(rd, result);
-		if (setflags) {
-			apsr.bits.N = HIGH_BIT(result);
-			apsr.bits.Z = result == 0;
-			apsr.bits.C = carry;
-			CORE_apsr_write(apsr);
-		}
+		if (setflags)
+			CORE_apsr_flags_nzc(result, carry);
 	//}
 
 	DBG2("mov_imm r%02d = 0x%08x\n", rd, result);
@@ -52,12 +48,8 @@ void mov_reg(uint8_t rd, uint8_t rm, bool setflags) {
 	//	//ALUWritePC(rm_val);
 	//} else {
 		CORE_reg_write(rd, rm_val);
-		if (setflags) {
-			union apsr_t apsr = CORE_apsr_read();
-			apsr.bits.N = HIGH_BIT(rm_val);
-			apsr.bits.Z = rm_val == 0;
-			CORE_apsr_write(apsr);
-		}
+		if (setflags)
+			CORE_apsr_flags_nz(rm_val);
 	//}
 
 	DBG2("mov_reg r%02d = r%02d (val: %08x)\n", rd, rm, rm_val);
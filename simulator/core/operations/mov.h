@@ -17,6 +17,6 @@
  * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-void mov_imm(union apsr_t apsr, uint8_t setflags, uint32_t imm32, uint8_t rd, uint8_t carry);
+void mov_imm(uint8_t setflags, uint32_t imm32, uint8_t rd, uint8_t carry);
 void mov_reg(uint8_t rd, uint8_t rm, bool setflags);
 
@@ -21,6 +21,7 @@
 
 #include "cpu/registers.h"
 #include "cpu/misc.h"
+#include "core/timing.h"
 
 void mla(uint8_t rd, uint8_t rn, uint8_t rm, uint8_t ra) {
 	uint32_t rn_val = CORE_reg_read(rn);
@@ -32,6 +33,7 @@ void mla(uint8_t rd, uint8_t rn, uint8_t rm, uint8_t ra) {
 	uint64_t addend = ra_val;
 	uint64_t result = operand1 * operand2 + addend;
 
+	timing_mla();
 	CORE_reg_write(rd, result & 0xffffffff);
 }
 
@@ -44,6 +46,7 @@ void mls(uint8_t rd, uint8_t rn, uint8_t rm, uint8_t ra) {
 	uint32_t operand2 = rm_val;
 	uint32_t addend = ra_val;
 	uint32_t result = addend - operand1 * operand2;
+	timing_mla();
 	CORE_reg_write(rd, result);
 }
 
@@ -51,14 +54,11 @@ void mul(uint8_t setflags, uint8_t rd, uint8_t rn, uint8_t rm) {
 	uint32_t result;
 
 	result = CORE_reg_read(rn) * CORE_reg_read(rm);
+	timing_mul();
 	CORE_reg_write(rd, result);
 
-	if (setflags) {
-		union apsr_t apsr = CORE_apsr_read();
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		CORE_apsr_write(apsr);
-	}
+	if (setflags)
+		CORE_apsr_flags_nz(result);
 }
 
 void smull(uint8_t rdlo, uint8_t rdhi, uint8_t rn, uint8_t rm,
@@ -69,6 +69,8 @@ void smull(uint8_t rdlo, uint8_t rdhi, uint8_t rn, uint8_t rm,
 	int64_t rm_val = CORE_reg_read(rm);
 	int64_t result = rn_val * rm_val;
 
+	timing_mull(rm_val, true);
+
 	CORE_reg_write(rdhi, (result >> 32) & 0xffffffff);
 	CORE_reg_write(rdlo, result & 0xffffffff);
 }
@@ -81,6 +83,8 @@ void umull(uint8_t rdlo, uint8_t rdhi, uint8_t rn, uint8_t rm,
 	uint64_t rm_val = CORE_reg_read(rm);
 	uint64_t result = rn_val * rm_val;
 
+	timing_mull(rm_val, false);
+
 	CORE_reg_write(rdhi, (result >> 32) & 0xffffffff);
 	CORE_reg_write(rdlo, result & 0xffffffff);
 }
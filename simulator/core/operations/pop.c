@@ -22,25 +22,24 @@
 #include "cpu/registers.h"
 #include "cpu/core.h"
 #include "cpu/misc.h"
-#include "core/simulator.h"
+#include "core/timing.h"
 
 void pop(uint16_t registers) {
 	uint32_t address = CORE_reg_read(SP_REG);
 
-	int i;
+	uint32_t vals[16];
+	timing_load_multiple(address, hamming(registers));
+	read_words(address, vals, hamming(registers));
+
+	int i, v = 0;
 	for (i = 0; i <= 14; i++) {
 		if (registers & (1 << i)) {
-			CORE_reg_write(i, read_word(address));
-			address += 4;
-			//# cycles of Pop: 1+N
-			cycle++;
+			CORE_reg_write(i, vals[v++]);
 		}
 	}
 
 	if (registers & (1 << 15)) {
-		LoadWritePC(read_word(address));
-		//# cycles of Pop: 4+N
-		cycle = cycle + 4;
+		LoadWritePC(vals[v]);
 	}
 
 	CORE_reg_write(SP_REG, CORE_reg_read(SP_REG) + 4 * hamming(registers));
@@ -21,22 +21,22 @@
 
 #include "cpu/registers.h"
 #include "cpu/core.h"
-#include "core/simulator.h"
+#include "core/timing.h"
 
 void push(const uint16_t registers) {
 	uint32_t sp = CORE_reg_read(SP_REG);
 
 	uint32_t address = sp - 4 * hamming(registers);
 
-	int i;
+	uint32_t vals[15];
+	int i, v = 0;
 	for (i=0; i <= 14; i++) {
 		if (registers & (1 << i)) {
-			write_word(address, CORE_reg_read(i));
-			address += 4;
-			//# cycles of Push: 1+N
-			cycle++;
+			vals[v++] = CORE_reg_read(i);
 		}
 	}
+	timing_store_multiple(address, v);
+	write_words(address, vals, v);
 
 	CORE_reg_write(SP_REG, sp - 4 * hamming(registers));
 }
@@ -25,39 +25,46 @@
 #include "cpu/registers.h"
 #include "cpu/misc.h"
 
-void shift_imm(union apsr_t apsr, uint8_t setflags, uint8_t rd, uint8_t rm,
-		enum SRType shift_t, uint8_t shift_n) {
+static inline __attribute__ ((always_inline))
+void shift_imm_tmpl(uint8_t setflags, uint8_t rd, uint8_t rm,
+		enum SRType shift_t, uint8_t shift_n, bool lo) {
 	uint32_t rm_val = CORE_reg_read(rm);
 
 	uint32_t result;
 	bool carry;
-	Shift_C(rm_val, 32, shift_t, shift_n, apsr.bits.C, &result, &carry);
+	bool shifter_carry = shifted_reg_c(rm_val, shift_t, shift_n,
+			&result, &carry);
 
-	if (rd == 15) {
+	if (!lo && (rd == 15)) {
 		// ALUWritePC(result);
 		CORE_ERR_not_implemented("ALUWritePC shift_imm\n");
 	} else {
 		CORE_reg_write(rd, result);
 		if (setflags) {
-			apsr.bits.N = HIGH_BIT(result);
-			apsr.bits.Z = result == 0;
-			apsr.bits.C = carry;
-			CORE_apsr_write(apsr);
+			if (shifter_carry)
+				CORE_apsr_flags_nzc(result, carry);
+			else
+				CORE_apsr_flags_nz(result);
 		}
 	}
 
 	DBG2("shift_imm complete\n");
 }
 
-void shift_imm_t1(uint16_t inst, enum SRType shift_t) {
+void shift_imm(uint8_t setflags, uint8_t rd, uint8_t rm,
+		enum SRType shift_t, uint8_t shift_n) {
+	shift_imm_tmpl(setflags, rd, rm, shift_t, shift_n, false);
+}
+
+// The 16-bit encodings fix the shift type, the _lo entry points below
+// instantiate one copy per type
+static inline __attribute__ ((always_inline))
+void shift_imm_t1_tmpl(uint16_t inst, enum SRType shift_t) {
 	uint8_t rd = inst & 0x7;
 	uint8_t rm = (inst >> 3) & 0x7;
 	uint8_t imm5 = (inst >> 6) & 0x1f;
 	bool setflags = !in_ITblock();
 
-	uint8_t shift_n;
-	DecodeImmShift(SRType_ENUM_TO_MASK(shift_t), imm5, &shift_t, &shift_n);
-
 	if (shift_t == ASR)
 		OP_DECOMPILE("ASR<IT> <Rd>,<Rm>,#<imm5>", rd, rm, imm5);
 	if (shift_t == LSL)
@@ -66,13 +73,38 @@ void shift_imm_t1(uint16_t inst, enum SRType shift_t) {
 		OP_DECOMPILE("LSR<IT> <Rd>,<Rm>,#<imm5>", rd, rm, imm5);
 	if (shift_t == ROR)
 		OP_DECOMPILE("ROR<IT> <Rd>,<Rm>,#<imm5>", rd, rm, imm5);
-	return shift_imm(CORE_apsr_read(), setflags, rd, rm,
-			shift_t, shift_n);
+
+	// DecodeImmShift, open-coded so a constant shift_t stays constant
+	uint8_t shift_n = imm5;
+	if ((shift_t != LSL) && (imm5 == 0)) {
+		if (shift_t == ROR) {
+			shift_t = RRX;
+			shift_n = 1;
+		} else {
+			shift_n = 32;
+		}
+	}
+
+	return shift_imm_tmpl(setflags, rd, rm, shift_t, shift_n, true);
 }
 
-void shift_imm_t2(uint32_t inst, enum SRType shift_t) {
-	union apsr_t apsr = CORE_apsr_read();
+void shift_imm_t1(uint16_t inst, enum SRType shift_t) {
+	return shift_imm_t1_tmpl(inst, shift_t);
+}
+
+void asr_imm_t1_lo(uint16_t inst) {
+	return shift_imm_t1_tmpl(inst, ASR);
+}
 
+void lsl_imm_t1_lo(uint16_t inst) {
+	return shift_imm_t1_tmpl(inst, LSL);
+}
+
+void lsr_imm_t1_lo(uint16_t inst) {
+	return shift_imm_t1_tmpl(inst, LSR);
+}
+
+void shift_imm_t2(uint32_t inst, enum SRType shift_t) {
 	uint8_t rm = inst & 0xf;
 	uint8_t imm2 = (inst >> 6) & 0x3;
 	uint8_t rd = (inst >> 8) & 0xf;
@@ -96,7 +128,7 @@ void shift_imm_t2(uint32_t inst, enum SRType shift_t) {
 		OP_DECOMPILE("LSR{S}<c>.W <Rd>,<Rm>,#<imm5>", setflags, rd, rm, imm5);
 	if (shift_t == ROR)
 		OP_DECOMPILE("ROR{S}<c>.W <Rd>,<Rm>,#<imm5>", setflags, rd, rm, imm5);
-	return shift_imm(apsr, setflags, rd, rm, shift_t, shift_n);
+	return shift_imm(setflags, rd, rm, shift_t, shift_n);
 }
 
 void shift_reg(uint8_t rd, uint8_t rn, uint8_t rm,
@@ -106,19 +138,13 @@ void shift_reg(uint8_t rd, uint8_t rn, uint8_t rm,
 	uint32_t result;
 	bool carry;
 
-	union apsr_t apsr = CORE_apsr_read();
-
-	Shift_C(CORE_reg_read(rn), 32, shift_t, shift_n, apsr.bits.C,
+	Shift_C(CORE_reg_read(rn), 32, shift_t, shift_n, CORE_apsr_C_read(),
 			&result, &carry);
 
 	CORE_reg_write(rd, result);
 
-	if (setflags) {
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry;
-		CORE_apsr_write(apsr);
-	}
+	if (setflags)
+		CORE_apsr_flags_nzc(result, carry);
 }
 
 void shift_reg_t1(uint16_t inst, enum SRType shift_t) {
@@ -163,18 +189,12 @@ void shift_reg_t2(uint32_t inst, enum SRType shift_t) {
 }
 
 void rrx(uint8_t rm, uint8_t rd, bool setflags) {
-	union apsr_t apsr = CORE_apsr_read();
-
 	uint32_t result;
 	bool carry_out;
-	Shift_C(CORE_reg_read(rm), 32, SRType_RRX, 1, apsr.bits.C,
+	Shift_C(CORE_reg_read(rm), 32, SRType_RRX, 1, CORE_apsr_C_read(),
 			&result, &carry_out);
 
 	CORE_reg_write(rd, result);
-	if (setflags) {
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry_out;
-		CORE_apsr_write(apsr);
-	}
+	if (setflags)
+		CORE_apsr_flags_nzc(result, carry_out);
 }
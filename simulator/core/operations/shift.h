@@ -17,9 +17,12 @@
  * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-void shift_imm(union apsr_t apsr, uint8_t setflags, uint8_t rd, uint8_t rm,
+void shift_imm(uint8_t setflags, uint8_t rd, uint8_t rm,
 		enum SRType shift_t, uint8_t shift_n);
 void shift_imm_t1(uint16_t inst, enum SRType shift_t);
+void asr_imm_t1_lo(uint16_t inst);
+void lsl_imm_t1_lo(uint16_t inst);
+void lsr_imm_t1_lo(uint16_t inst);
 void shift_imm_t2(uint32_t inst, enum SRType shift_t);
 void shift_reg(uint8_t rd, uint8_t rn, uint8_t rm,
 		enum SRType shift_t, bool setflags);
@@ -21,6 +21,7 @@
 
 #include "cpu/registers.h"
 #include "cpu/core.h"
+#include "core/timing.h"
 
 void str_imm(uint8_t rt, uint8_t rn, uint32_t imm32,
 		bool index, bool add, bool wback) {
@@ -39,6 +40,7 @@ void str_imm(uint8_t rt, uint8_t rn, uint32_t imm32,
 		address = rn_val;
 
 	uint32_t rt_val = CORE_reg_read(rt);
+	timing_store(address);
 	write_word_unaligned(address, rt_val);
 
 	if (wback)
@@ -56,6 +58,7 @@ void str_reg(uint8_t rt, uint8_t rn, uint8_t rm,
 	uint32_t offset = Shift(rm_val, 32, shift_t, shift_n, apsr.bits.C);
 	uint32_t address = rn_val + offset;
 	uint32_t data = rt_val;
+	timing_store(address);
 	write_word_unaligned(address, data);
 }
 
@@ -82,6 +85,7 @@ void strb_imm(uint8_t rt, uint8_t rn, uint32_t imm32,
 
 	DBG2("address: %08x\n", address);
 
+	timing_store(address);
 	write_byte(address, rt_val & 0xff);
 
 	if (wback) {
@@ -100,6 +104,7 @@ void strb_reg(uint8_t rt, uint8_t rn, uint8_t rm,
 	uint32_t address;
 	address = CORE_reg_read(rn) + offset;
 
+	timing_store(address);
 	write_byte(address, CORE_reg_read(rt) & 0xff);
 }
 
@@ -119,6 +124,7 @@ void strd_imm(uint8_t rt, uint8_t rt2, uint8_t rn, uint32_t imm32,
 		address = CORE_reg_read(rn);
 	}
 
+	timing_store_multiple(address, 2);
 	write_word_aligned(address, CORE_reg_read(rt));
 	write_word_aligned(address + 4, CORE_reg_read(rt2));
 
@@ -144,6 +150,7 @@ void strh_imm(uint8_t rt, uint8_t rn, uint32_t imm32,
 	else
 		address = rn_val;
 
+	timing_store(address);
 	write_halfword_unaligned(address, rt_val & 0xffff);
 
 	if (wback)
@@ -159,5 +166,6 @@ void strh_reg(uint8_t rt, uint8_t rn, uint8_t rm,
 	uint32_t address;
 	address = CORE_reg_read(rn) + offset;
 
+	timing_store(address);
 	write_halfword_unaligned(address, CORE_reg_read(rt) & 0xffff);
 }
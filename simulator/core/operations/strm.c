@@ -21,22 +21,22 @@
 
 #include "cpu/registers.h"
 #include "cpu/core.h"
-#include "core/simulator.h"
+#include "core/timing.h"
 
 void stmdb(uint8_t rn, uint16_t registers, bool wback) {
 	uint32_t rn_val = CORE_reg_read(rn);
 
 	uint32_t address = rn_val - 4 * hamming(registers);
 
-	int i;
+	uint32_t vals[15];
+	int i, v = 0;
 	for (i=0; i <= 14; i++) {
 		if (registers & (1 << i)) {
-			write_word(address, CORE_reg_read(i));
-			address += 4;
-			//# cycles of Load Multiple: 1+N
-			cycle++;
+			vals[v++] = CORE_reg_read(i);
 		}
 	}
+	timing_store_multiple(address, v);
+	write_words(address, vals, v);
 
 	if (wback) {
 		CORE_reg_write(rn, rn_val - 4 * hamming(registers));
@@ -48,19 +48,19 @@ void stm(uint8_t rn, uint16_t registers, bool wback) {
 
 	uint32_t address = rn_val;
 
-	int i;
+	uint32_t vals[15];
+	int i, v = 0;
 	for (i = 0; i <= 14; i++) {
 		if (registers & (1 << i)) {
 			if ((i == rn) && wback) {
 				CORE_ERR_not_implemented("complicated case\n");
 			} else {
-				write_word(address, CORE_reg_read(i));
+				vals[v++] = CORE_reg_read(i);
 			}
-			address += 4;
-			//# cycles of Load Multiple: 1+N
-			cycle++;
 		}
 	}
+	timing_store_multiple(address, v);
+	write_words(address, vals, v);
 
 	if (wback)
 		CORE_reg_write(rn, rn_val + 4*hamming(registers));
@@ -27,79 +27,61 @@ void rsb_imm(uint8_t rd, uint8_t rn, uint32_t imm32, bool setflags) {
 	bool carry;
 	bool overflow;
 
-	AddWithCarry(~CORE_reg_read(rn), imm32, 1, &result, &carry, &overflow);
+	uint32_t not_rn_val = ~CORE_reg_read(rn);
+	AddWithCarry(not_rn_val, imm32, 1, &result, &carry, &overflow);
 
 	CORE_reg_write(rd, result);
-	if (setflags) {
-		union apsr_t apsr = CORE_apsr_read();
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry;
-		apsr.bits.V = overflow;
-		CORE_apsr_write(apsr);
-	}
+	if (setflags)
+		CORE_apsr_flags_add(not_rn_val, imm32, result);
 }
 
 void rsb_reg(uint8_t rd, uint8_t rn, uint8_t rm, bool setflags,
 		enum SRType shift_t, uint8_t shift_n) {
-	union apsr_t apsr = CORE_apsr_read();
-	uint32_t rm_val = CORE_reg_read(rm);
-	uint32_t shifted = Shift(rm_val, 32, shift_t, shift_n, apsr.bits.C);
+	uint32_t shifted = shifted_reg(CORE_reg_read(rm), shift_t, shift_n);
 
-	uint32_t result;
-	bool carry;
-	bool overflow;
-	AddWithCarry(~CORE_reg_read(rn), shifted, 1,
-			&result, &carry, &overflow);
+	uint32_t not_rn_val = ~CORE_reg_read(rn);
+	uint32_t result = not_rn_val + shifted + 1;
 
 	CORE_reg_write(rd, result);
-	if (setflags) {
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry;
-		apsr.bits.V = overflow;
-		CORE_apsr_write(apsr);
-	}
+	if (setflags)
+		CORE_apsr_flags_add(not_rn_val, shifted, result);
 }
 
 void sbc_imm(uint8_t rd, uint8_t rn, bool setflags, uint32_t imm32) {
-	union apsr_t apsr = CORE_apsr_read();
+	uint32_t rn_val = CORE_reg_read(rn);
 
 	uint32_t result;
 	bool carry;
 	bool overflow;
-	AddWithCarry(CORE_reg_read(rn), ~imm32, apsr.bits.C,
+	AddWithCarry(rn_val, ~imm32, CORE_apsr_C_read(),
 			&result, &carry, &overflow);
 
 	CORE_reg_write(rd, result);
-	if (setflags) {
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry;
-		apsr.bits.V = overflow;
-		CORE_apsr_write(apsr);
-	}
+	if (setflags)
+		CORE_apsr_flags_add(rn_val, ~imm32, result);
 }
 
-void sbc_reg(uint8_t rd, uint8_t rn, uint8_t rm, bool setflags,
+static inline __attribute__ ((always_inline))
+void sbc_reg_tmpl(uint8_t rd, uint8_t rn, uint8_t rm, bool setflags,
 		enum SRType shift_t, uint8_t shift_n) {
-	union apsr_t apsr = CORE_apsr_read();
-
-	uint32_t shifted = Shift(CORE_reg_read(rm), 32,
-			shift_t, shift_n, apsr.bits.C);
+	bool carry_in = CORE_apsr_C_read();
+	uint32_t rn_val = CORE_reg_read(rn);
 
-	uint32_t result;
-	bool carry;
-	bool overflow;
-	AddWithCarry(CORE_reg_read(rn), ~shifted, apsr.bits.C,
-			&result, &carry, &overflow);
+	uint32_t shifted = shifted_reg(CORE_reg_read(rm), shift_t, shift_n);
+	uint32_t result = rn_val + ~shifted + carry_in;
 
 	CORE_reg_write(rd, result);
-	if (setflags) {
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry;
-		apsr.bits.V = overflow;
-		CORE_apsr_write(apsr);
-	}
+	if (setflags)
+		CORE_apsr_flags_add(rn_val, ~shifted, result);
+}
+
+void sbc_reg(uint8_t rd, uint8_t rn, uint8_t rm, bool setflags,
+		enum SRType shift_t, uint8_t shift_n) {
+	sbc_reg_tmpl(rd, rn, rm, setflags, shift_t, shift_n);
+}
+
+void sbc_reg_lo(uint8_t rd, uint8_t rn, uint8_t rm, bool setflags) {
+	sbc_reg_tmpl(rd & 0x7, rn & 0x7, rm & 0x7, setflags, LSL, 0);
 }
 
 void sub_imm(uint8_t rd, uint8_t rn, uint32_t imm32, bool setflags) {
@@ -107,44 +89,36 @@ void sub_imm(uint8_t rd, uint8_t rn, uint32_t imm32, bool setflags) {
 	bool overflow;
 	uint32_t result;
 
-	AddWithCarry(CORE_reg_read(rn), ~imm32, 1, &result, &carry, &overflow);
+	uint32_t rn_val = CORE_reg_read(rn);
+	AddWithCarry(rn_val, ~imm32, 1, &result, &carry, &overflow);
 	CORE_reg_write(rd, result);
 
-	if (setflags) {
-		union apsr_t apsr = CORE_apsr_read();
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry;
-		apsr.bits.V = overflow;
-		CORE_apsr_write(apsr);
-	}
+	if (setflags)
+		CORE_apsr_flags_add(rn_val, ~imm32, result);
 
 	DBG2("sub_imm ran\n");
 }
 
-void sub_reg(uint8_t rd, uint8_t rn, uint8_t rm,
+static inline __attribute__ ((always_inline))
+void sub_reg_tmpl(uint8_t rd, uint8_t rn, uint8_t rm,
 		enum SRType shift_t, uint8_t shift_n, bool setflags) {
 	uint32_t rn_val = CORE_reg_read(rn);
-	uint32_t rm_val = CORE_reg_read(rm);
-	union apsr_t apsr = CORE_apsr_read();
+	uint32_t shifted = shifted_reg(CORE_reg_read(rm), shift_t, shift_n);
+	uint32_t result = rn_val - shifted;
 
-	uint32_t shifted;
-	shifted = Shift(rm_val, 32, shift_t, shift_n, apsr.bits.C);
+	CORE_reg_write(rd, result);
 
-	uint32_t result;
-	bool carry;
-	bool overflow;
-	AddWithCarry(rn_val, ~shifted, 1, &result, &carry, &overflow);
+	if (setflags)
+		CORE_apsr_flags_add(rn_val, ~shifted, result);
+}
 
-	CORE_reg_write(rd, result);
+void sub_reg(uint8_t rd, uint8_t rn, uint8_t rm,
+		enum SRType shift_t, uint8_t shift_n, bool setflags) {
+	sub_reg_tmpl(rd, rn, rm, shift_t, shift_n, setflags);
+}
 
-	if (setflags) {
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry;
-		apsr.bits.V = overflow;
-		CORE_apsr_write(apsr);
-	}
+void sub_reg_lo(uint8_t rd, uint8_t rn, uint8_t rm, bool setflags) {
+	sub_reg_tmpl(rd & 0x7, rn & 0x7, rm & 0x7, LSL, 0, setflags);
 }
 
 void sub_sp_imm(uint8_t rd, uint32_t imm32, bool setflags) {
@@ -157,34 +131,18 @@ void sub_sp_imm(uint8_t rd, uint32_t imm32, bool setflags) {
 	AddWithCarry(sp_val, ~imm32, 1, &result, &carry, &overflow);
 	CORE_reg_write(rd, result);
 
-	if (setflags) {
-		union apsr_t apsr = CORE_apsr_read();
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry;
-		apsr.bits.V = overflow;
-		CORE_apsr_write(apsr);
-	}
+	if (setflags)
+		CORE_apsr_flags_add(sp_val, ~imm32, result);
 }
 
 void sub_sp_reg(uint8_t rd, uint8_t rm, bool setflags,
 		enum SRType shift_t, uint8_t shift_n) {
-	union apsr_t apsr = CORE_apsr_read();
-
-	uint32_t shifted;
-	shifted = Shift(CORE_reg_read(rm), 32, shift_t, shift_n, apsr.bits.C);
+	uint32_t sp_val = CORE_reg_read(SP_REG);
 
-	uint32_t result;
-	bool carry;
-	bool overflow;
-	AddWithCarry(CORE_reg_read(SP_REG), ~shifted, 1,
-			&result, &carry, &overflow);
+	uint32_t shifted = shifted_reg(CORE_reg_read(rm), shift_t, shift_n);
+	uint32_t result = sp_val - shifted;
 
 	CORE_reg_write(rd, result);
-	if (setflags) {
-		apsr.bits.N = HIGH_BIT(result);
-		apsr.bits.Z = result == 0;
-		apsr.bits.C = carry;
-		apsr.bits.V = overflow;
-	}
+	if (setflags)
+		CORE_apsr_flags_add(sp_val, ~shifted, result);
 }
@@ -23,6 +23,12 @@
 #include "state_sync.h"
 #include "opcodes.h"
 
+#if !defined(NO_PIPELINE) && !defined(COOPERATIVE_PIPELINE) && defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
 /* This file defines all of the gloabl state shared across the various
  * stages in the ARM pipeline; this simulator assumes the standard ARMv7
  * three stage pipeline (IF|ID|EX)
@@ -42,6 +48,22 @@ uint32_t id_ex_inst;
 
 #define MAX_PIPELINE_STAGES 8
 
+/* Pipeline engines:
+ *
+ * NO_PIPELINE            Stages run back-to-back on the main thread, each
+ *                        committing its writes before the next one runs
+ * COOPERATIVE_PIPELINE   Stages run in a fixed order on the main thread,
+ *                        sharing one state journal that is committed once
+ *                        per cycle, so each stage still only sees the state
+ *                        latched at the end of the previous cycle
+ * (default)              Each stage is its own thread, released and
+ *                        collected by the main thread through a barrier
+ *                        (or semaphores with PIPELINE_SEMAPHORES)
+ */
+#if defined(NO_PIPELINE) && defined(COOPERATIVE_PIPELINE)
+#error "NO_PIPELINE and COOPERATIVE_PIPELINE are mutually exclusive"
+#endif
+
 static struct pipeline_stage {
 	struct pipeline_stage *next;
 
@@ -55,8 +77,12 @@ static struct pipeline_stage {
 	int ret;
 
 	pthread_t pthread;
+#ifdef PIPELINE_SEMAPHORES
 	sem_t *start;
 	sem_t *done;
+#else
+	uint32_t gen;
+#endif
 } stages[MAX_PIPELINE_STAGES];
 static int num_stages;
 
@@ -82,33 +108,41 @@ EXPORT void register_pipeline_stage(int idx, const char* name, void (*fn) (void)
 	num_stages = MAX(num_stages, idx+1);
 }
 
-#ifndef NO_PIPELINE
-static void* ticker(void *idx_void) {
-	int idx = *((int *) idx_void);
+#if !defined(NO_PIPELINE) && !defined(COOPERATIVE_PIPELINE)
+/* Stage synchronization
+ *
+ * Several times a cycle the main thread releases every stage at once and
+ * then waits for all of them to finish. The default barrier does this with a
+ * generation counter: the main thread bumps start_gen to release the stages,
+ * each stage bumps done_cnt when it is finished. Waiters spin for a bounded
+ * time and then sleep on a futex, so idle stages (a sleeping core, a paused
+ * debugger) do not burn a host CPU. Spinning is skipped entirely when there
+ * are not enough host CPUs for every thread to have its own.
+ *
+ * PIPELINE_SEMAPHORES keeps the original handshake, one start and one done
+ * semaphore per stage, for comparison.
+ */
 
-#ifdef __APPLE__
-	if (0 != pthread_setname_np(stages[idx].name))
-#else
-	if (0 != prctl(PR_SET_NAME, stages[idx].name, 0, 0, 0))
-#endif // __APPLE__
-		ERR(E_UNKNOWN, "Unexpected error setting thread name: %s", strerror(errno));
+#ifdef PIPELINE_SEMAPHORES
+static void stage_wait_start(struct pipeline_stage *s) {
+	sem_wait(s->start);
+}
 
-	sem_post(stages[idx].done);
+static void stage_signal_done(struct pipeline_stage *s) {
+	sem_post(s->done);
+}
 
-	while (1) {
-		sem_wait(stages[idx].start);
-		if (stages[idx].run_fn_void)
-			stages[idx].run_fn_void();
-		else if (stages[idx].run_fn_args)
-			stages[idx].ret = stages[idx].run_fn_args(stages[idx].args);
-		sem_post(stages[idx].done);
-	}
+static void stages_start(void) {
+	for (int i=0; i < num_stages; i++)
+		sem_post(stages[i].start);
 }
-#endif
 
-EXPORT void pipeline_init(void) {
-#ifdef NO_PIPELINE
-#else
+static void stages_wait_done(void) {
+	for (int i=0; i < num_stages; i++)
+		sem_wait(stages[i].done);
+}
+
+static void stages_sync_init(void) {
 	for (int idx = 0; idx < num_stages ; idx++) {
 		// OS X requires named semaphores
 		char name_buf[32];
@@ -117,21 +151,188 @@ EXPORT void pipeline_init(void) {
 		stages[idx].start = sem_open(name_buf, O_CREAT|O_EXCL, 0600, 0);
 		if (stages[idx].start == SEM_FAILED)
 			ERR(E_UNKNOWN, "%s\n", strerror(errno));
+		// Only the handle is needed, drop the name so it is not left in /dev/shm
+		sem_unlink(name_buf);
 
 		snprintf(name_buf, 32, "/%d-%s.done", getpid(), stages[idx].name);
 		stages[idx].done = sem_open(name_buf, O_CREAT|O_EXCL, 0600, 0);
 		if (stages[idx].done == SEM_FAILED)
 			ERR(E_UNKNOWN, "%s\n", strerror(errno));
+		sem_unlink(name_buf);
+	}
+}
+#else // barrier
+
+#ifndef PIPELINE_SPIN_LIMIT
+#define PIPELINE_SPIN_LIMIT 4096
+#endif
+
+static int spin_limit;
+
+static uint32_t start_gen;
+static uint32_t done_cnt;
+static uint32_t stages_sleeping;
+static uint32_t main_sleeping;
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+	__asm__ __volatile__ ("yield");
+#endif
+}
+
+static void futex_wait(uint32_t *addr, uint32_t val) {
+#ifdef __linux__
+	syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+#else
+	(void) addr;
+	(void) val;
+	sched_yield();
+#endif
+}
+
+static void futex_wake(uint32_t *addr) {
+#ifdef __linux__
+	syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#else
+	(void) addr;
+#endif
+}
+
+// Returns once *addr != val. Whoever changes *addr must check sleepers
+// afterwards and wake the futex if it is non-zero.
+static void barrier_wait(uint32_t *addr, uint32_t val, uint32_t *sleepers) {
+	for (int i = 0; i < spin_limit; i++) {
+		if (__atomic_load_n(addr, __ATOMIC_ACQUIRE) != val)
+			return;
+		cpu_relax();
+	}
+
+	__atomic_add_fetch(sleepers, 1, __ATOMIC_SEQ_CST);
+	while (__atomic_load_n(addr, __ATOMIC_SEQ_CST) == val)
+		futex_wait(addr, val);
+	__atomic_sub_fetch(sleepers, 1, __ATOMIC_SEQ_CST);
+}
+
+static void stage_wait_start(struct pipeline_stage *s) {
+	barrier_wait(&start_gen, s->gen, &stages_sleeping);
+	s->gen++;
+}
+
+static void stage_signal_done(struct pipeline_stage *s __attribute__ ((unused))) {
+	uint32_t done = __atomic_add_fetch(&done_cnt, 1, __ATOMIC_SEQ_CST);
+	if ((done == (uint32_t) num_stages) &&
+			__atomic_load_n(&main_sleeping, __ATOMIC_SEQ_CST))
+		futex_wake(&done_cnt);
+}
+
+static void stages_start(void) {
+	// Nobody touches done_cnt until they see the new generation
+	__atomic_store_n(&done_cnt, 0, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&start_gen, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&stages_sleeping, __ATOMIC_SEQ_CST))
+		futex_wake(&start_gen);
+}
+
+static void stages_wait_done(void) {
+	uint32_t done;
+	while ((done = __atomic_load_n(&done_cnt, __ATOMIC_ACQUIRE)) != (uint32_t) num_stages)
+		barrier_wait(&done_cnt, done, &main_sleeping);
+}
+
+static void stages_sync_init(void) {
+	int ncpus;
+#ifdef __linux__
+	cpu_set_t set;
+	if (0 != sched_getaffinity(0, sizeof(set), &set))
+		ERR(E_UNKNOWN, "sched_getaffinity: %s\n", strerror(errno));
+	ncpus = CPU_COUNT(&set);
+#else
+	ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+	// With fewer cores than threads a spinning waiter only delays the
+	// thread it is waiting for
+	spin_limit = (ncpus > num_stages) ? PIPELINE_SPIN_LIMIT : 0;
+	DBG1("%d host cpus, pipeline barrier spin limit %d\n", ncpus, spin_limit);
+}
+#endif // PIPELINE_SEMAPHORES
+
+static void stages_pin(void) {
+#ifdef __linux__
+	cpu_set_t allowed;
+	int cpus[CPU_SETSIZE];
+	int ncpus = 0;
+
+	if (0 != sched_getaffinity(0, sizeof(allowed), &allowed))
+		ERR(E_UNKNOWN, "sched_getaffinity: %s\n", strerror(errno));
+	for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+		if (CPU_ISSET(cpu, &allowed))
+			cpus[ncpus++] = cpu;
+
+	if (ncpus <= num_stages)
+		WARN("Only %d cpus for %d pipeline threads, some will share\n",
+				ncpus, num_stages + 1);
+
+	// The main thread keeps the first cpu, stages take the following ones
+	for (int idx = -1; idx < num_stages; idx++) {
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(cpus[(idx + 1) % ncpus], &set);
+
+		pthread_t thread = (idx < 0) ? pthread_self() : stages[idx].pthread;
+		int ret = pthread_setaffinity_np(thread, sizeof(set), &set);
+		if (ret != 0)
+			ERR(E_UNKNOWN, "Pinning %s: %s\n",
+					(idx < 0) ? "main thread" : stages[idx].name,
+					strerror(ret));
+	}
+#else
+	WARN("Pinning pipeline threads is not supported on this platform\n");
+#endif
+}
+
+static void* ticker(void *stage_void) {
+	struct pipeline_stage *s = stage_void;
+
+#ifdef __APPLE__
+	if (0 != pthread_setname_np(s->name))
+#else
+	if (0 != prctl(PR_SET_NAME, s->name, 0, 0, 0))
+#endif // __APPLE__
+		ERR(E_UNKNOWN, "Unexpected error setting thread name: %s", strerror(errno));
 
-		pthread_create(&stages[idx].pthread, NULL, ticker, &idx);
-		sem_wait(stages[idx].done);
+	stage_signal_done(s);
+
+	while (1) {
+		stage_wait_start(s);
+		if (s->run_fn_void)
+			s->run_fn_void();
+		else if (s->run_fn_args)
+			s->ret = s->run_fn_args(s->args);
+		stage_signal_done(s);
 	}
+}
+#endif
+
+EXPORT void pipeline_init(void) {
+#if defined(NO_PIPELINE) || defined(COOPERATIVE_PIPELINE)
+#else
+	stages_sync_init();
+
+	for (int idx = 0; idx < num_stages ; idx++)
+		pthread_create(&stages[idx].pthread, NULL, ticker, &stages[idx]);
+	stages_wait_done();
+
+	if (CONF_pin_stages)
+		stages_pin();
 #endif
 }
 
 EXPORT void pipeline_flush_exception_handler(uint32_t new_pc) {
 	DBG2("Pipeline Flush. new_PC: %08x\n", new_pc);
-#ifdef NO_PIPELINE
+#if defined(NO_PIPELINE) || defined(COOPERATIVE_PIPELINE)
 	for (int i=0; i < num_stages; i++) {
 		stages[i].pipeline_flush_fn(&new_pc);
 	}
@@ -139,10 +340,10 @@ EXPORT void pipeline_flush_exception_handler(uint32_t new_pc) {
 	for (int i=0; i < num_stages; i++) {
 		stages[i].args = &new_pc;
 		stages[i].run_fn_args = stages[i].pipeline_flush_fn;
-		sem_post(stages[i].start);
 	}
+	stages_start();
+	stages_wait_done();
 	for (int i=0; i < num_stages; i++) {
-		sem_wait(stages[i].done);
 		stages[i].run_fn_args = NULL;
 	}
 #endif
@@ -156,14 +357,21 @@ EXPORT void pipeline_stages_tick(void) {
 		stages[i].tick_fn();
 		state_tock();
 	}
+#elif defined(COOPERATIVE_PIPELINE)
+	// Writes are only committed by pipeline_stages_tock (and the simulator's
+	// own state_tock), so stage order does not matter for what stages see
+	state_start_tick();
+	for (int i=0; i < num_stages; i++) {
+		stages[i].tick_fn();
+	}
 #else
 	pipeline_thread_run_fn_void(state_start_tick);
 	for (int i=0; i < num_stages; i++) {
 		stages[i].run_fn_void = stages[i].tick_fn;
-		sem_post(stages[i].start);
 	}
+	stages_start();
+	stages_wait_done();
 	for (int i=0; i < num_stages; i++) {
-		sem_wait(stages[i].done);
 		stages[i].run_fn_void = NULL;
 	}
 #endif
@@ -172,31 +380,33 @@ EXPORT void pipeline_stages_tick(void) {
 EXPORT void pipeline_stages_tock() {
 #ifdef NO_PIPELINE
 	return;
+#elif defined(COOPERATIVE_PIPELINE)
+	state_tock();
 #else
 	pipeline_thread_run_fn_void(state_tock);
 #endif
 }
 
 #ifdef HAVE_REPLAY
-#ifndef NO_PIPELINE
+#if !defined(NO_PIPELINE) && !defined(COOPERATIVE_PIPELINE)
 static int state_seek_for_calling_thread_wrapper(void *target_void) {
 	return state_seek_for_calling_thread(*((int *) target_void));
 }
 #endif
 
 EXPORT int pipeline_state_seek(int target) {
-#ifdef NO_PIPELINE
+#if defined(NO_PIPELINE) || defined(COOPERATIVE_PIPELINE)
 	return state_seek_for_calling_thread(target);
 #else
 	for (int i=0; i < num_stages; i++) {
 		stages[i].args = &target;
 		stages[i].run_fn_args = state_seek_for_calling_thread_wrapper;
-		sem_post(stages[i].start);
 	}
+	stages_start();
+	stages_wait_done();
 
 	int ret = INT_MIN;
 	for (int i=0; i < num_stages; i++) {
-		sem_wait(stages[i].done);
 		stages[i].run_fn_args = NULL;
 		if (ret == INT_MIN)
 			ret = stages[i].ret;
@@ -213,13 +423,22 @@ EXPORT int pipeline_state_seek(int target) {
 #endif // HAVE_REPLAY
 
 #ifndef NO_PIPELINE
+#ifdef COOPERATIVE_PIPELINE
+EXPORT void pipeline_thread_run_fn_void(void (*fn) (void)) {
+	fn();
+}
+
+EXPORT int pipeline_thread_run_fn_args(int (*fn) (void *), void* args) {
+	return fn(args);
+}
+#else
 EXPORT void pipeline_thread_run_fn_void(void (*fn) (void)) {
 	for (int i=0; i < num_stages; i++) {
 		stages[i].run_fn_void = fn;
-		sem_post(stages[i].start);
 	}
+	stages_start();
+	stages_wait_done();
 	for (int i=0; i < num_stages; i++) {
-		sem_wait(stages[i].done);
 		stages[i].run_fn_void = NULL;
 	}
 }
@@ -228,21 +447,19 @@ EXPORT int pipeline_thread_run_fn_args(int (*fn) (void *), void* args) {
 	int ret = 0;
 
 	for (int i=0; i < num_stages; i++) {
-		if (stages[i].name == NULL)
-			break;
-
 		stages[i].args = args;
 		stages[i].run_fn_args = fn;
-		sem_post(stages[i].start);
 	}
+	stages_start();
+	stages_wait_done();
 	for (int i=0; i < num_stages; i++) {
-		sem_wait(stages[i].done);
 		stages[i].run_fn_args = NULL;
 		ret |= stages[i].ret;
 	}
 
 	return ret;
 }
+#endif // COOPERATIVE_PIPELINE
 
 EXPORT void pipeline_exception(uint16_t inst __attribute__ ((unused))) {
 	CORE_ERR_not_implemented("Pipeline excpetion!\n");
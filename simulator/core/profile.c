@@ -0,0 +1,355 @@
+/* Mulator - An extensible {ARM} {e,si}mulator
+ * Copyright 2011-2016  Pat Pannuto <pat.pannuto@gmail.com>
+ *
+ * This file is part of Mulator.
+ *
+ * Mulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "profile.h"
+#include "simulator.h"
+#include "symbols.h"
+
+/* PC profiling
+ *
+ * EX reports each instruction it is about to execute. By default every one is
+ * counted: the cycles until the next instruction reaches EX are charged to
+ * it, so multi-cycle instructions and exception entry are weighed correctly.
+ * With profile_interval N > 1, only the instruction in EX when a multiple of
+ * N cycles has passed is counted, as standing for N cycles.
+ *
+ * Counting every instruction also finds basic blocks: an instruction reached
+ * by anything other than falling through from the one before it starts a
+ * block, and one left the same way ends one.
+ *
+ * Reports are grouped by the ELF symbols loaded with --symbols, if any.
+ */
+
+#define PROFILE_EMPTY		0xffffffff	// Never a (Thumb) PC
+#define PROFILE_TOP_N		20
+
+EXPORT const char *profile_file = NULL;
+EXPORT const char *profile_callgrind_file = NULL;
+EXPORT int profile_interval = 1;
+
+struct profile_pc {
+	uint32_t pc;		// PROFILE_EMPTY for a free slot
+	bool is16;
+	bool leader;		// Reached other than by falling through
+	bool ender;		// Left other than by falling through
+	uint64_t count;		// Executions, or samples
+	uint64_t cycles;
+};
+
+// By PC, open addressing, never more than half full
+static struct profile_pc *pcs;
+static unsigned pcs_bits;
+static unsigned pcs_count;
+
+static struct profile_pc *last;
+static int64_t last_cycle;
+static int64_t next_sample;
+
+static inline unsigned pc_hash(uint32_t pc) {
+	return ((pc >> 1) * 0x9e3779b1u) >> (32 - pcs_bits);
+}
+
+static void pcs_grow(void) {
+	struct profile_pc *old = pcs;
+	unsigned old_size = (old) ? 1u << pcs_bits : 0;
+	unsigned i;
+
+	pcs_bits = (pcs_bits) ? pcs_bits + 1 : 12;
+	pcs = malloc(sizeof(struct profile_pc) << pcs_bits);
+	if (pcs == NULL)
+		ERR(E_UNKNOWN, "Out of memory for profile\n");
+	for (i = 0; i < (1u << pcs_bits); i++)
+		pcs[i].pc = PROFILE_EMPTY;
+
+	for (i = 0; i < old_size; i++) {
+		if (old[i].pc != PROFILE_EMPTY) {
+			unsigned j = pc_hash(old[i].pc);
+			while (pcs[j].pc != PROFILE_EMPTY)
+				j = (j + 1) & ((1u << pcs_bits) - 1);
+			pcs[j] = old[i];
+		}
+	}
+	free(old);
+}
+
+static struct profile_pc *pc_lookup(uint32_t pc) {
+	unsigned i;
+
+	if ((pcs == NULL) || ((pcs_count * 2) >= (1u << pcs_bits)))
+		pcs_grow();
+
+	i = pc_hash(pc);
+	while (pcs[i].pc != pc) {
+		if (pcs[i].pc == PROFILE_EMPTY) {
+			memset(&pcs[i], 0, sizeof(pcs[i]));
+			pcs[i].pc = pc;
+			pcs_count++;
+			break;
+		}
+		i = (i + 1) & ((1u << pcs_bits) - 1);
+	}
+	return &pcs[i];
+}
+
+EXPORT void profile_count(uint32_t pc, bool is16) {
+	struct profile_pc *e;
+
+	if (profile_interval > 1) {
+		if (cycle < next_sample)
+			return;
+		next_sample = cycle - (cycle % profile_interval) + profile_interval;
+		e = pc_lookup(pc);
+		e->is16 = is16;
+		e->count++;
+		e->cycles += profile_interval;
+		return;
+	}
+
+	// Settle the previous instruction before an insert can move it
+	bool leader = true;
+	if (last) {
+		last->cycles += cycle - last_cycle;
+		if (pc == last->pc + ((last->is16) ? 2 : 4))
+			leader = false;
+		else
+			last->ender = true;
+	}
+
+	e = pc_lookup(pc);
+	e->is16 = is16;
+	e->leader |= leader;
+	e->count++;
+	last = e;
+	last_cycle = cycle;
+}
+
+struct profile_range {
+	const struct symbol *sym;	// Function, NULL outside any
+	uint32_t start;
+	uint32_t end;			// Address of the last instruction
+	uint64_t count;
+	uint64_t cycles;
+};
+
+static int cmp_pc(const void *a, const void *b) {
+	uint32_t pa = ((const struct profile_pc *) a)->pc;
+	uint32_t pb = ((const struct profile_pc *) b)->pc;
+	return (pa > pb) - (pa < pb);
+}
+
+static int cmp_pc_cycles(const void *a, const void *b) {
+	uint64_t ca = ((const struct profile_pc *) a)->cycles;
+	uint64_t cb = ((const struct profile_pc *) b)->cycles;
+	return (ca < cb) - (ca > cb);
+}
+
+static int cmp_range_cycles(const void *a, const void *b) {
+	uint64_t ca = ((const struct profile_range *) a)->cycles;
+	uint64_t cb = ((const struct profile_range *) b)->cycles;
+	return (ca < cb) - (ca > cb);
+}
+
+static const char *fn_name(const struct symbol *sym) {
+	return (sym) ? sym->name : "(unknown)";
+}
+
+static double pct(uint64_t part, uint64_t total) {
+	return (total) ? 100.0 * part / total : 0.0;
+}
+
+static void write_report(FILE *fp, const char *image,
+		const struct profile_pc *by_pc, unsigned n,
+		uint64_t total_cycles, uint64_t total_count) {
+	struct profile_range *ranges = calloc(n + 1, sizeof(*ranges));
+	struct profile_pc *hot = malloc((n + 1) * sizeof(*hot));
+	unsigned i, nr;
+	bool sampled = profile_interval > 1;
+	char name[96];
+
+	if ((ranges == NULL) || (hot == NULL))
+		ERR(E_UNKNOWN, "Out of memory for profile report\n");
+
+	fprintf(fp, "Profile of %s: %" PRIu64 " cycles", image, total_cycles);
+	if (sampled)
+		fprintf(fp, " (%" PRIu64 " samples, one every %d cycles)\n",
+				total_count, profile_interval);
+	else
+		fprintf(fp, ", %" PRIu64 " instructions\n", total_count);
+	fprintf(fp, "Symbols: %s\n\n", (symbols_file) ? symbols_file : "none");
+
+	// Flat profile, by function. Code outside every symbol is one entry
+	struct profile_range unknown = {NULL, 0, 0, 0, 0};
+	nr = 0;
+	for (i = 0; i < n; i++) {
+		const struct symbol *sym = symbols_lookup(by_pc[i].pc);
+		struct profile_range *r;
+		if (sym == NULL) {
+			r = &unknown;
+		} else {
+			if ((nr == 0) || (ranges[nr - 1].sym != sym))
+				ranges[nr++].sym = sym;
+			r = &ranges[nr - 1];
+		}
+		r->count += by_pc[i].count;
+		r->cycles += by_pc[i].cycles;
+	}
+	if (unknown.cycles)
+		ranges[nr++] = unknown;
+	qsort(ranges, nr, sizeof(*ranges), cmp_range_cycles);
+
+	uint64_t cumulative = 0;
+	fprintf(fp, "Flat profile:\n\n");
+	fprintf(fp, "  %%time  cumul%%        cycles  %12s  function\n",
+			(sampled) ? "samples" : "instructions");
+	for (i = 0; i < nr; i++) {
+		cumulative += ranges[i].cycles;
+		fprintf(fp, "%7.2f %7.2f %13" PRIu64 " %13" PRIu64 "  %s\n",
+				pct(ranges[i].cycles, total_cycles),
+				pct(cumulative, total_cycles),
+				ranges[i].cycles, ranges[i].count,
+				fn_name(ranges[i].sym));
+	}
+
+	// Hottest basic blocks, which sampling cannot find
+	if (!sampled) {
+		nr = 0;
+		for (i = 0; i < n; i++) {
+			const struct profile_pc *e = &by_pc[i];
+			const struct profile_pc *prev = (i) ? &by_pc[i - 1] : NULL;
+			if ((prev == NULL) || e->leader || prev->ender ||
+					(e->pc != prev->pc + ((prev->is16) ? 2 : 4))) {
+				ranges[nr].start = e->pc;
+				ranges[nr].count = e->count;
+				ranges[nr].cycles = 0;
+				nr++;
+			}
+			ranges[nr - 1].end = e->pc;
+			ranges[nr - 1].cycles += e->cycles;
+		}
+		qsort(ranges, nr, sizeof(*ranges), cmp_range_cycles);
+
+		fprintf(fp, "\nHottest basic blocks:\n\n");
+		fprintf(fp, "  %%time        cycles         execs  "
+				"start       end         function\n");
+		for (i = 0; i < nr && i < PROFILE_TOP_N; i++) {
+			symbols_name(ranges[i].start, name, sizeof(name));
+			fprintf(fp, "%7.2f %13" PRIu64 " %13" PRIu64
+					"  0x%08x  0x%08x  %s\n",
+					pct(ranges[i].cycles, total_cycles),
+					ranges[i].cycles, ranges[i].count,
+					ranges[i].start, ranges[i].end, name);
+		}
+	}
+
+	// Hottest instructions
+	memcpy(hot, by_pc, n * sizeof(*hot));
+	qsort(hot, n, sizeof(*hot), cmp_pc_cycles);
+	fprintf(fp, "\nHottest instructions:\n\n");
+	fprintf(fp, "  %%time        cycles  %12s  pc          function\n",
+			(sampled) ? "samples" : "execs");
+	for (i = 0; i < n && i < PROFILE_TOP_N; i++) {
+		symbols_name(hot[i].pc, name, sizeof(name));
+		fprintf(fp, "%7.2f %13" PRIu64 " %13" PRIu64 "  0x%08x  %s\n",
+				pct(hot[i].cycles, total_cycles),
+				hot[i].cycles, hot[i].count, hot[i].pc, name);
+	}
+
+	free(hot);
+	free(ranges);
+}
+
+// Callgrind format, one cost line per instruction, for kcachegrind
+static void write_callgrind(FILE *fp, const char *image,
+		const struct profile_pc *by_pc, unsigned n,
+		uint64_t total_cycles, uint64_t total_count) {
+	bool sampled = profile_interval > 1;
+	const struct symbol *cur = NULL;
+	unsigned i;
+
+	fprintf(fp, "# callgrind format\n");
+	fprintf(fp, "version: 1\n");
+	fprintf(fp, "creator: mulator\n");
+	fprintf(fp, "cmd: %s\n", image);
+	fprintf(fp, "positions: instr\n");
+	fprintf(fp, "events: Cycles %s\n", (sampled) ? "Samples" : "Instructions");
+	fprintf(fp, "summary: %" PRIu64 " %" PRIu64 "\n\n",
+			total_cycles, total_count);
+	fprintf(fp, "ob=%s\n", image);
+	fprintf(fp, "fl=???\n");
+
+	for (i = 0; i < n; i++) {
+		const struct symbol *sym = symbols_lookup(by_pc[i].pc);
+		if ((i == 0) || (sym != cur)) {
+			cur = sym;
+			fprintf(fp, "fn=%s\n", fn_name(sym));
+		}
+		fprintf(fp, "0x%x %" PRIu64 " %" PRIu64 "\n", by_pc[i].pc,
+				by_pc[i].cycles, by_pc[i].count);
+	}
+}
+
+static FILE *open_report(const char *file) {
+	FILE *fp = fopen(file, "w");
+	if (fp == NULL)
+		WARN("Could not open %s: %s\n", file, strerror(errno));
+	return fp;
+}
+
+static void close_report(FILE *fp, const char *file, unsigned n) {
+	fclose(fp);
+	INFO("Wrote profile of %u instructions to %s\n", n, file);
+}
+
+EXPORT void profile_report(const char *image) {
+	struct profile_pc *by_pc;
+	uint64_t total_cycles = 0, total_count = 0;
+	unsigned i, n;
+
+	if (last)
+		last->cycles += cycle - last_cycle;
+	last = NULL;
+
+	by_pc = malloc((pcs_count + 1) * sizeof(*by_pc));
+	if (by_pc == NULL)
+		ERR(E_UNKNOWN, "Out of memory for profile report\n");
+	n = 0;
+	for (i = 0; (pcs != NULL) && (i < (1u << pcs_bits)); i++) {
+		if (pcs[i].pc != PROFILE_EMPTY) {
+			by_pc[n++] = pcs[i];
+			total_cycles += pcs[i].cycles;
+			total_count += pcs[i].count;
+		}
+	}
+	qsort(by_pc, n, sizeof(*by_pc), cmp_pc);
+
+	if (image == NULL)
+		image = "(test flash)";
+
+	FILE *fp;
+	if (profile_file && (fp = open_report(profile_file))) {
+		write_report(fp, image, by_pc, n, total_cycles, total_count);
+		close_report(fp, profile_file, n);
+	}
+	if (profile_callgrind_file && (fp = open_report(profile_callgrind_file))) {
+		write_callgrind(fp, image, by_pc, n, total_cycles, total_count);
+		close_report(fp, profile_callgrind_file, n);
+	}
+
+	free(by_pc);
+}
@@ -0,0 +1,43 @@
+/* Mulator - An extensible {ARM} {e,si}mulator
+ * Copyright 2011-2016  Pat Pannuto <pat.pannuto@gmail.com>
+ *
+ * This file is part of Mulator.
+ *
+ * Mulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "common.h"
+
+#ifndef PP_STRING
+#define PP_STRING "PRF"
+#include "pretty_print.h"
+#endif
+
+// Reports to write on exit, either enables profiling
+extern const char *profile_file;
+extern const char *profile_callgrind_file;
+
+// Sample the PC every N cycles instead of counting every instruction
+extern int profile_interval;
+
+// Called from EX for each instruction executed, before it executes
+void profile_count(uint32_t pc, bool is16);
+
+// Writes the requested reports
+void profile_report(const char *image);
+
+#endif // PROFILE_H
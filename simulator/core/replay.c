@@ -0,0 +1,808 @@
+/* Mulator - An extensible {ARM} {e,si}mulator
+ * Copyright 2011-2012  Pat Pannuto <pat.pannuto@gmail.com>
+ *
+ * This file is part of Mulator.
+ *
+ * Mulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "replay.h"
+#include "simulator.h"
+
+#include "cpu/periph.h"
+
+#include <stddef.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef HAVE_REPLAY
+
+/* Replay history
+ *
+ * Each thread appends the state changes it commits to its own journal. The
+ * journal is a list of fixed-size chunks holding variable-length records:
+ *
+ *   int64_t cycle, uint32_t len, uint32_t span | len bytes of entries | len
+ *
+ * The trailing len lets the journal be walked backwards. An entry is the
+ * target address with its kind in the (always zero) low two bits, followed
+ * by the XOR of the old and new contents: one word, one pointer, or a word
+ * count and that many words. XOR deltas make undo and redo the same
+ * operation, and writes that do not change anything are not recorded at all.
+ *
+ * A record holds everything a thread changed in one tick, tagged with the
+ * cycle the tick started in. Instructions that take more than one cycle
+ * advance the cycle count as they execute, so span is how many further cycles
+ * the tick covered. Seeks only stop between ticks. A tick with no changes has
+ * no record, unless it spans cycles, in which case an empty record keeps the
+ * tick boundaries the same in every thread's journal.
+ *
+ * Tick boundaries come from the main thread: every thread's ticks are tagged
+ * with the cycle the main thread last started, and end when it starts the
+ * next one. The pipeline stage threads start their ticks after the main
+ * thread, so a seek can find them a tick behind (e.g. gdb stopped the main
+ * thread as it began a cycle). Their open tick then ends the cycle before the
+ * main thread's, not at the cycle count the main thread has since advanced.
+ *
+ * Once a thread holds more than replay_mem_limit bytes of chunks, the oldest
+ * are written to an unlinked temporary file and freed. Seeking into them maps
+ * them back one at a time.
+ *
+ * Every replay_checkpoint_interval cycles a ticking thread marks a checkpoint
+ * and folds the records since the previous one into a summary: one entry per
+ * location changed, holding the XOR of all its deltas. Applying a summary
+ * moves the thread's whole state between two checkpoints at once, so a long
+ * seek crosses whole intervals by summary and only walks records inside the
+ * first and last. Summaries stay in memory; each is at most one entry per
+ * location the thread touched in its interval.
+ *
+ * Threads that never tick (async peripherals) tag changes with the global
+ * cycle at the time. Their journals are seeked by the main thread, through
+ * the peripheral's periph_time_travel hooks.
+ */
+
+#define REPLAY_CHUNK_SIZE	(1 << 20)
+// Block entries are split so any single entry is small next to a chunk
+#define REPLAY_BLOCK_MAX	64
+
+enum replay_kind {
+	REPLAY_WORD = 0,
+	REPLAY_PTR = 1,
+	REPLAY_BLOCK = 2,
+};
+#define REPLAY_KIND_MASK	0x3
+
+struct replay_rec {
+	int64_t cycle;
+	uint32_t len;
+	uint32_t span;
+};
+#define REPLAY_REC_OVERHEAD	(sizeof(struct replay_rec) + sizeof(uint32_t))
+
+struct replay_chunk {
+	uint8_t *mem;		// NULL while spilled and not mapped
+	size_t used;
+	bool mapped;		// mem is a read-only mapping of the spill file
+};
+
+struct replay_checkpoint {
+	// Journal position, state here is the state at the end of cycle
+	int chunk;
+	size_t pos;
+	int64_t cycle;
+
+	// Deltas from here to the next checkpoint, NULL until it is taken
+	uint8_t *summary;
+	size_t summary_len;
+};
+
+struct replay_journal {
+	struct replay_chunk *chunks;
+	int count;
+	int alloc;
+	int resident;		// chunks below this index are spilled
+	int mapped;		// the spilled chunk currently mapped, or -1
+	int fd;			// spill file, opened on first spill
+
+	// Current position, the end of the last record applied
+	int pos_chunk;
+	size_t pos;
+
+	// Whether the last record may still be extended (with rec_cycle writes)
+	bool rec_open;
+	int64_t rec_cycle;
+
+	// Threads that tick tag their changes with the cycle the tick started
+	bool tick_open;
+	int64_t tick_cycle;
+
+	int64_t end_cycle;	// latest cycle this thread executed
+
+	struct replay_checkpoint *cps;
+	int cp_count;
+	int cp_alloc;
+};
+
+// Every thread's journal, so async peripheral history can be found
+struct replay_thread {
+	struct replay_thread *next;
+	pthread_t thread;
+	struct replay_journal *journal;
+};
+static struct replay_thread *replay_threads;
+static pthread_mutex_t replay_threads_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+EXPORT size_t replay_mem_limit = 64 << 20;
+EXPORT int replay_checkpoint_interval = 1 << 16;
+
+static thread_local struct replay_journal *j;
+
+// Cycle the main thread's current tick started in
+static int64_t replay_cycle;
+
+// Set while seeking a peripheral's journal
+static thread_local const struct periph_time_travel *replay_tt;
+
+static void replay_init_thread(void) {
+	j = calloc(1, sizeof(struct replay_journal));
+	struct replay_thread *t = malloc(sizeof(struct replay_thread));
+	if ((j == NULL) || (t == NULL))
+		ERR(E_UNKNOWN, "Allocating replay journal\n");
+	j->mapped = -1;
+	j->fd = -1;
+
+	t->thread = pthread_self();
+	t->journal = j;
+	pthread_mutex_lock(&replay_threads_mutex);
+	t->next = replay_threads;
+	replay_threads = t;
+	pthread_mutex_unlock(&replay_threads_mutex);
+}
+
+static void replay_unmap(void) {
+	struct replay_chunk *ch = &j->chunks[j->mapped];
+	munmap(ch->mem, REPLAY_CHUNK_SIZE);
+	ch->mem = NULL;
+	ch->mapped = false;
+	j->mapped = -1;
+}
+
+static uint8_t* replay_chunk_mem(int c) {
+	struct replay_chunk *ch = &j->chunks[c];
+	if (ch->mem != NULL)
+		return ch->mem;
+
+	if (j->mapped >= 0)
+		replay_unmap();
+	void *m = mmap(NULL, REPLAY_CHUNK_SIZE, PROT_READ, MAP_PRIVATE,
+			j->fd, (off_t) c * REPLAY_CHUNK_SIZE);
+	if (m == MAP_FAILED)
+		ERR(E_UNKNOWN, "Mapping replay history: %s\n", strerror(errno));
+	ch->mem = m;
+	ch->mapped = true;
+	j->mapped = c;
+	return ch->mem;
+}
+
+static void replay_spill_oldest(void) {
+	if (j->fd < 0) {
+		const char *dir = getenv("TMPDIR");
+		char path[PATH_MAX];
+		snprintf(path, PATH_MAX, "%s/mulator-replay-XXXXXX",
+				dir ? dir : "/tmp");
+		j->fd = mkstemp(path);
+		if (j->fd < 0)
+			ERR(E_UNKNOWN, "Creating replay spill file: %s\n",
+					strerror(errno));
+		// Only the descriptor is needed, nothing is left behind on exit
+		unlink(path);
+		INFO("Replay history over %zu MB, spilling to disk\n",
+				replay_mem_limit >> 20);
+	}
+
+	int c = j->resident++;
+	struct replay_chunk *ch = &j->chunks[c];
+	const uint8_t *p = ch->mem;
+	size_t left = ch->used;
+	off_t off = (off_t) c * REPLAY_CHUNK_SIZE;
+	while (left) {
+		ssize_t ret = pwrite(j->fd, p, left, off);
+		if (ret < 0)
+			ERR(E_UNKNOWN, "Writing replay spill file: %s\n",
+					strerror(errno));
+		p += ret;
+		off += ret;
+		left -= ret;
+	}
+	free(ch->mem);
+	ch->mem = NULL;
+}
+
+static void replay_new_chunk(void) {
+	if (j->count == j->alloc) {
+		j->alloc = (j->alloc) ? j->alloc * 2 : 64;
+		j->chunks = realloc(j->chunks, j->alloc * sizeof(struct replay_chunk));
+		if (j->chunks == NULL)
+			ERR(E_UNKNOWN, "Allocating replay chunk list\n");
+	}
+	struct replay_chunk *ch = &j->chunks[j->count++];
+	ch->mem = malloc(REPLAY_CHUNK_SIZE);
+	if (ch->mem == NULL)
+		ERR(E_UNKNOWN, "Allocating replay history\n");
+	ch->used = 0;
+	ch->mapped = false;
+
+	while ((j->resident < j->count - 1) &&
+			((size_t) (j->count - j->resident) * REPLAY_CHUNK_SIZE >
+			 replay_mem_limit))
+		replay_spill_oldest();
+}
+
+// Drops everything past the current position
+static void replay_truncate(void) {
+	DBG1("Re-executing at cycle %"PRId64", discarding later history\n", cycle);
+
+	int c = j->pos_chunk;
+	for (int i = c + 1; i < j->count; i++) {
+		if (j->chunks[i].mapped)
+			replay_unmap();
+		else
+			free(j->chunks[i].mem);
+	}
+	j->count = c + 1;
+
+	struct replay_chunk *ch = &j->chunks[c];
+	if (c < j->resident) {
+		// Appending continues in this chunk, bring it back into memory
+		uint8_t *mem = malloc(REPLAY_CHUNK_SIZE);
+		if (mem == NULL)
+			ERR(E_UNKNOWN, "Allocating replay history\n");
+		memcpy(mem, replay_chunk_mem(c), j->pos);
+		replay_unmap();
+		ch->mem = mem;
+		j->resident = c;
+	}
+	if ((j->fd >= 0) && ftruncate(j->fd, (off_t) j->resident * REPLAY_CHUNK_SIZE))
+		WARN("Truncating replay spill file: %s\n", strerror(errno));
+
+	ch->used = j->pos;
+	j->rec_open = false;
+
+	// Checkpoints past here are gone, and the last one's interval is open again
+	while (j->cp_count) {
+		struct replay_checkpoint *cp = &j->cps[j->cp_count - 1];
+		if ((cp->chunk < c) || ((cp->chunk == c) && (cp->pos <= j->pos)))
+			break;
+		free(cp->summary);
+		j->cp_count--;
+	}
+	if (j->cp_count) {
+		struct replay_checkpoint *cp = &j->cps[j->cp_count - 1];
+		free(cp->summary);
+		cp->summary = NULL;
+	}
+}
+
+static inline bool replay_at_end(void) {
+	return (j->count == 0) ||
+		((j->pos_chunk == j->count - 1) && (j->pos == j->chunks[j->pos_chunk].used));
+}
+
+// Offset of the header of the last record in a chunk
+static size_t replay_last_rec(const struct replay_chunk *ch) {
+	uint32_t len;
+	memcpy(&len, ch->mem + ch->used - sizeof(len), sizeof(len));
+	return ch->used - sizeof(len) - len - sizeof(struct replay_rec);
+}
+
+static void replay_new_rec(int64_t start, const void *entry, uint32_t n) {
+	struct replay_chunk *ch = (j->count) ? &j->chunks[j->count - 1] : NULL;
+	if ((ch == NULL) ||
+			(ch->used + REPLAY_REC_OVERHEAD + n > REPLAY_CHUNK_SIZE)) {
+		replay_new_chunk();
+		ch = &j->chunks[j->count - 1];
+	}
+	struct replay_rec hdr = {
+		.cycle = start,
+		.len = n,
+		.span = 0,
+	};
+	memcpy(ch->mem + ch->used, &hdr, sizeof(hdr));
+	ch->used += sizeof(hdr);
+	if (n)
+		memcpy(ch->mem + ch->used, entry, n);
+	ch->used += n;
+	memcpy(ch->mem + ch->used, &n, sizeof(n));
+	ch->used += sizeof(n);
+
+	j->rec_open = true;
+	j->rec_cycle = start;
+	j->pos_chunk = j->count - 1;
+	j->pos = ch->used;
+}
+
+static void replay_append(const void *entry, uint32_t n) {
+	if (unlikely(j == NULL))
+		replay_init_thread();
+	if (!replay_at_end())
+		replay_truncate();
+
+	int64_t start = (j->tick_open) ? j->tick_cycle : cycle;
+	struct replay_chunk *ch = (j->count) ? &j->chunks[j->count - 1] : NULL;
+	if (j->rec_open && (j->rec_cycle == start) &&
+			(ch->used + n <= REPLAY_CHUNK_SIZE)) {
+		// Grow the open record in place, moving its trailing length
+		size_t rec = replay_last_rec(ch);
+		uint32_t len;
+		memcpy(&len, ch->mem + ch->used - sizeof(len), sizeof(len));
+		memcpy(ch->mem + ch->used - sizeof(len), entry, n);
+		len += n;
+		memcpy(ch->mem + rec + offsetof(struct replay_rec, len),
+				&len, sizeof(len));
+		ch->used += n;
+		memcpy(ch->mem + ch->used - sizeof(len), &len, sizeof(len));
+		j->pos = ch->used;
+	} else {
+		replay_new_rec(start, entry, n);
+	}
+}
+
+// The tick that started at tick_cycle finished at the end of cycle end
+static void replay_close_tick(int64_t end) {
+	if (!j->tick_open)
+		return;
+	j->tick_open = false;
+
+	uint32_t span = end - j->tick_cycle;
+	if (!(j->rec_open && (j->rec_cycle == j->tick_cycle))) {
+		if (span == 0)
+			goto done;
+		replay_new_rec(j->tick_cycle, NULL, 0);
+	}
+	struct replay_chunk *ch = &j->chunks[j->count - 1];
+	memcpy(ch->mem + replay_last_rec(ch) + offsetof(struct replay_rec, span),
+			&span, sizeof(span));
+done:
+	j->rec_open = false;
+	j->end_cycle = end;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Entries
+////////////////////////////////////////////////////////////////////////////////
+
+// Calls fn for every word or pointer an entry list changes
+static void replay_walk(const uint8_t *p, const uint8_t *end,
+		void (*fn)(uintptr_t tag, uintptr_t delta)) {
+	while (p < end) {
+		uintptr_t tag;
+		memcpy(&tag, p, sizeof(tag));
+		p += sizeof(tag);
+
+		switch (tag & REPLAY_KIND_MASK) {
+			case REPLAY_WORD:
+			{
+				uint32_t d;
+				memcpy(&d, p, sizeof(d));
+				p += sizeof(d);
+				fn(tag, d);
+				break;
+			}
+			case REPLAY_PTR:
+			{
+				uintptr_t d;
+				memcpy(&d, p, sizeof(d));
+				p += sizeof(d);
+				fn(tag, d);
+				break;
+			}
+			case REPLAY_BLOCK:
+			{
+				uint32_t n;
+				memcpy(&n, p, sizeof(n));
+				p += sizeof(n);
+				tag &= ~(uintptr_t) REPLAY_KIND_MASK;
+				for (uint32_t i = 0; i < n; i++) {
+					uint32_t d;
+					memcpy(&d, p, sizeof(d));
+					p += sizeof(d);
+					fn((tag + i * sizeof(uint32_t)) | REPLAY_WORD, d);
+				}
+				break;
+			}
+			default:
+				ERR(E_UNKNOWN, "Corrupt replay history entry\n");
+		}
+	}
+}
+
+// XORing a delta back in both undoes and redoes it
+static void replay_xor(uintptr_t tag, uintptr_t delta) {
+	void *target = (void *) (tag & ~(uintptr_t) REPLAY_KIND_MASK);
+	if ((tag & REPLAY_KIND_MASK) == REPLAY_WORD) {
+		*(uint32_t *) target ^= delta;
+	} else {
+		uintptr_t v;
+		memcpy(&v, target, sizeof(v));
+		v ^= delta;
+		memcpy(target, &v, sizeof(v));
+	}
+}
+
+static void replay_tt_rewind(uintptr_t tag, uintptr_t delta) {
+	void *target = (void *) (tag & ~(uintptr_t) REPLAY_KIND_MASK);
+	if ((tag & REPLAY_KIND_MASK) == REPLAY_WORD)
+		replay_tt->rewind(target, *(uint32_t *) target ^ delta);
+	else
+		replay_tt->rewind_p(target,
+				(uint32_t *) ((uintptr_t) *(uint32_t **) target ^ delta));
+}
+
+static void replay_tt_replay(uintptr_t tag, uintptr_t delta) {
+	void *target = (void *) (tag & ~(uintptr_t) REPLAY_KIND_MASK);
+	if ((tag & REPLAY_KIND_MASK) == REPLAY_WORD)
+		replay_tt->replay(target, *(uint32_t *) target ^ delta);
+	else
+		replay_tt->replay_p(target,
+				(uint32_t *) ((uintptr_t) *(uint32_t **) target ^ delta));
+}
+
+static void replay_apply(const uint8_t *p, const uint8_t *end, bool undo) {
+	if (replay_tt == NULL)
+		replay_walk(p, end, replay_xor);
+	else
+		replay_walk(p, end, undo ? replay_tt_rewind : replay_tt_replay);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Checkpoints
+////////////////////////////////////////////////////////////////////////////////
+
+// Open-addressed table of the deltas folded into the summary being built
+static thread_local uintptr_t *fold_tags;
+static thread_local uintptr_t *fold_deltas;
+static thread_local size_t fold_size;
+static thread_local size_t fold_count;
+
+static void replay_fold(uintptr_t tag, uintptr_t delta) {
+	if (2 * (fold_count + 1) > fold_size) {
+		uintptr_t *tags = fold_tags;
+		uintptr_t *deltas = fold_deltas;
+		size_t size = fold_size;
+
+		fold_size = (size) ? size * 2 : 1024;
+		fold_tags = calloc(fold_size, sizeof(uintptr_t));
+		fold_deltas = malloc(fold_size * sizeof(uintptr_t));
+		if ((fold_tags == NULL) || (fold_deltas == NULL))
+			ERR(E_UNKNOWN, "Allocating replay checkpoint\n");
+		fold_count = 0;
+		for (size_t i = 0; i < size; i++)
+			if (tags[i])
+				replay_fold(tags[i], deltas[i]);
+		free(tags);
+		free(deltas);
+	}
+
+	size_t mask = fold_size - 1;
+	size_t i = (((tag >> 2) * 0x9e3779b97f4a7c15ULL) >> 32) & mask;
+	while (fold_tags[i] && (fold_tags[i] != tag))
+		i = (i + 1) & mask;
+	if (fold_tags[i]) {
+		fold_deltas[i] ^= delta;
+	} else {
+		fold_tags[i] = tag;
+		fold_deltas[i] = delta;
+		fold_count++;
+	}
+}
+
+// Folds everything from the last checkpoint to the end of the journal
+static void replay_summarize(struct replay_checkpoint *cp) {
+	int c = cp->chunk;
+	size_t pos = cp->pos;
+	while (c < j->count) {
+		if (pos == j->chunks[c].used) {
+			c++;
+			pos = 0;
+			continue;
+		}
+		const uint8_t *m = replay_chunk_mem(c);
+		struct replay_rec hdr;
+		memcpy(&hdr, m + pos, sizeof(hdr));
+		replay_walk(m + pos + sizeof(hdr), m + pos + sizeof(hdr) + hdr.len,
+				replay_fold);
+		pos += REPLAY_REC_OVERHEAD + hdr.len;
+	}
+
+	uint8_t *summary = malloc(fold_count * 2 * sizeof(uintptr_t));
+	if ((summary == NULL) && fold_count)
+		ERR(E_UNKNOWN, "Allocating replay checkpoint\n");
+	uint8_t *p = summary;
+	for (size_t i = 0; i < fold_size; i++) {
+		if (fold_tags[i] == 0)
+			continue;
+		if (fold_deltas[i]) {
+			memcpy(p, &fold_tags[i], sizeof(uintptr_t));
+			p += sizeof(uintptr_t);
+			if ((fold_tags[i] & REPLAY_KIND_MASK) == REPLAY_WORD) {
+				uint32_t d = fold_deltas[i];
+				memcpy(p, &d, sizeof(d));
+				p += sizeof(d);
+			} else {
+				memcpy(p, &fold_deltas[i], sizeof(uintptr_t));
+				p += sizeof(uintptr_t);
+			}
+		}
+		fold_tags[i] = 0;
+	}
+	fold_count = 0;
+
+	cp->summary = summary;
+	cp->summary_len = p - summary;
+	DBG1("Checkpoint at cycle %"PRId64", %zu bytes of summary\n",
+			cp->cycle, cp->summary_len);
+}
+
+static void replay_checkpoint(int64_t at_cycle) {
+	if (j->cp_count == j->cp_alloc) {
+		j->cp_alloc = (j->cp_alloc) ? j->cp_alloc * 2 : 64;
+		j->cps = realloc(j->cps, j->cp_alloc * sizeof(struct replay_checkpoint));
+		if (j->cps == NULL)
+			ERR(E_UNKNOWN, "Allocating replay checkpoint\n");
+	}
+	if (j->cp_count)
+		replay_summarize(&j->cps[j->cp_count - 1]);
+
+	struct replay_checkpoint *cp = &j->cps[j->cp_count++];
+	cp->chunk = (j->count) ? j->count - 1 : 0;
+	cp->pos = (j->count) ? j->chunks[j->count - 1].used : 0;
+	cp->cycle = at_cycle;
+	cp->summary = NULL;
+	cp->summary_len = 0;
+}
+
+EXPORT void replay_start_cycle(void) {
+	replay_cycle = cycle;
+}
+
+EXPORT void replay_start_tick(void) {
+	if (unlikely(j == NULL))
+		replay_init_thread();
+
+	// The main thread starts a tick more than once a cycle
+	if (j->tick_open && (j->tick_cycle == replay_cycle))
+		return;
+
+	replay_close_tick(replay_cycle - 1);
+	if (!replay_at_end())
+		replay_truncate();
+	if ((j->cp_count == 0) ||
+			(replay_cycle - 1 >= j->cps[j->cp_count - 1].cycle + replay_checkpoint_interval))
+		replay_checkpoint(replay_cycle - 1);
+	j->tick_open = true;
+	j->tick_cycle = replay_cycle;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Recording
+////////////////////////////////////////////////////////////////////////////////
+
+EXPORT void replay_write(uint32_t *loc, uint32_t val) {
+	assert(((uintptr_t) loc & REPLAY_KIND_MASK) == 0);
+	uint32_t delta = *loc ^ val;
+	if (delta) {
+		uint8_t e[sizeof(uintptr_t) + sizeof(uint32_t)];
+		uintptr_t tag = (uintptr_t) loc | REPLAY_WORD;
+		memcpy(e, &tag, sizeof(tag));
+		memcpy(e + sizeof(tag), &delta, sizeof(delta));
+		replay_append(e, sizeof(e));
+	}
+	*loc = val;
+}
+
+EXPORT void replay_write_p(uint32_t **ploc, uint32_t *pval) {
+	assert(((uintptr_t) ploc & REPLAY_KIND_MASK) == 0);
+	uintptr_t delta = (uintptr_t) *ploc ^ (uintptr_t) pval;
+	if (delta) {
+		uint8_t e[2 * sizeof(uintptr_t)];
+		uintptr_t tag = (uintptr_t) ploc | REPLAY_PTR;
+		memcpy(e, &tag, sizeof(tag));
+		memcpy(e + sizeof(tag), &delta, sizeof(delta));
+		replay_append(e, sizeof(e));
+	}
+	*ploc = pval;
+}
+
+EXPORT void replay_write_block(uint32_t *loc, const uint32_t *vals, int count) {
+	assert(((uintptr_t) loc & REPLAY_KIND_MASK) == 0);
+	while (count > 0) {
+		uint32_t n = (count > REPLAY_BLOCK_MAX) ? REPLAY_BLOCK_MAX : count;
+		uint8_t e[sizeof(uintptr_t) + (1 + REPLAY_BLOCK_MAX) * sizeof(uint32_t)];
+		uint8_t *deltas = e + sizeof(uintptr_t) + sizeof(uint32_t);
+		uint32_t changed = 0;
+		for (uint32_t i = 0; i < n; i++) {
+			uint32_t d = loc[i] ^ vals[i];
+			memcpy(deltas + i * sizeof(d), &d, sizeof(d));
+			changed |= d;
+		}
+		if (changed) {
+			uintptr_t tag = (uintptr_t) loc | REPLAY_BLOCK;
+			memcpy(e, &tag, sizeof(tag));
+			memcpy(e + sizeof(tag), &n, sizeof(n));
+			replay_append(e, sizeof(uintptr_t) + (1 + n) * sizeof(uint32_t));
+		}
+		memcpy(loc, vals, n * sizeof(uint32_t));
+		loc += n;
+		vals += n;
+		count -= n;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Seeking
+////////////////////////////////////////////////////////////////////////////////
+
+static inline bool replay_pos_before(int chunk, size_t pos) {
+	return (j->pos_chunk < chunk) ||
+		((j->pos_chunk == chunk) && (j->pos < pos));
+}
+
+// Moves the start of a chunk to the end of the one before
+static void replay_pos_back(void) {
+	while ((j->pos == 0) && (j->pos_chunk > 0)) {
+		j->pos_chunk--;
+		j->pos = j->chunks[j->pos_chunk].used;
+	}
+}
+
+// Undoes the record before the current position, if it ends past target
+static bool replay_undo_rec(int64_t target_cycle) {
+	replay_pos_back();
+	if (j->pos == 0)
+		return false;
+	const uint8_t *m = replay_chunk_mem(j->pos_chunk);
+	uint32_t len;
+	memcpy(&len, m + j->pos - sizeof(len), sizeof(len));
+	size_t start = j->pos - sizeof(len) - len - sizeof(struct replay_rec);
+	struct replay_rec hdr;
+	memcpy(&hdr, m + start, sizeof(hdr));
+	if (hdr.cycle + hdr.span <= target_cycle)
+		return false;
+	replay_apply(m + start + sizeof(hdr), m + start + sizeof(hdr) + len, true);
+	j->pos = start;
+	return true;
+}
+
+// Redoes the record at the current position, if it ends by target. Otherwise
+// *next is the cycle it starts in
+static bool replay_redo_rec(int64_t target_cycle, int64_t *next) {
+	while (j->pos == j->chunks[j->pos_chunk].used) {
+		if (j->pos_chunk == j->count - 1)
+			return false;
+		j->pos_chunk++;
+		j->pos = 0;
+	}
+	const uint8_t *m = replay_chunk_mem(j->pos_chunk);
+	struct replay_rec hdr;
+	memcpy(&hdr, m + j->pos, sizeof(hdr));
+	if (hdr.cycle + hdr.span > target_cycle) {
+		*next = hdr.cycle;
+		return false;
+	}
+	const uint8_t *entries = m + j->pos + sizeof(hdr);
+	replay_apply(entries, entries + hdr.len, false);
+	j->pos += REPLAY_REC_OVERHEAD + hdr.len;
+	return true;
+}
+
+// Crosses whole checkpoint intervals by summary, leaving the position at
+// the checkpoint nearest the target
+static void replay_seek_checkpoints(int64_t target_cycle) {
+	int cur = j->cp_count - 1;
+	while ((cur > 0) && replay_pos_before(j->cps[cur].chunk, j->cps[cur].pos))
+		cur--;
+	int dst = j->cp_count - 1;
+	while ((dst > 0) && (j->cps[dst].cycle > target_cycle))
+		dst--;
+
+	int64_t next;
+	if (dst < cur) {
+		// Back to the start of this interval, then one summary per interval
+		while (true) {
+			replay_pos_back();
+			if ((j->pos_chunk == j->cps[cur].chunk) &&
+					(j->pos == j->cps[cur].pos))
+				break;
+			if (!replay_undo_rec(INT64_MIN))
+				break;
+		}
+		for (int k = cur - 1; k > dst; k--) {
+			const uint8_t *s = j->cps[k].summary;
+			replay_apply(s, s + j->cps[k].summary_len, true);
+		}
+		j->pos_chunk = j->cps[dst + 1].chunk;
+		j->pos = j->cps[dst + 1].pos;
+	} else if (dst > cur + 1) {
+		while ((j->pos_chunk != j->cps[cur + 1].chunk) ||
+				(j->pos != j->cps[cur + 1].pos))
+			if (!replay_redo_rec(INT64_MAX, &next))
+				break;
+		for (int k = cur + 1; k < dst; k++) {
+			const uint8_t *s = j->cps[k].summary;
+			replay_apply(s, s + j->cps[k].summary_len, false);
+		}
+		j->pos_chunk = j->cps[dst].chunk;
+		j->pos = j->cps[dst].pos;
+	}
+}
+
+static int replay_seek_journal(int target_cycle) {
+	// A thread behind the main thread finished its tick the cycle before,
+	// and has nothing in the main thread's tick but the cycles it spans
+	if (j->tick_open && (j->tick_cycle < replay_cycle)) {
+		replay_close_tick(replay_cycle - 1);
+		j->tick_open = true;
+		j->tick_cycle = replay_cycle;
+	}
+	replay_close_tick(cycle);
+	if (j->count == 0)
+		return (target_cycle < j->end_cycle) ? target_cycle : j->end_cycle;
+
+	if (j->cp_count > 1)
+		replay_seek_checkpoints(target_cycle);
+
+	// Undo ticks that end past the target
+	while (replay_undo_rec(target_cycle))
+		;
+
+	// Redo ticks that end by the target. Nothing changes between the last
+	// tick applied and the next one
+	int64_t reached = j->end_cycle;
+	int64_t next = INT64_MAX;
+	while (replay_redo_rec(target_cycle, &next))
+		;
+	if (next != INT64_MAX)
+		reached = next - 1;
+
+	return (target_cycle < reached) ? target_cycle : reached;
+}
+
+EXPORT int replay_seek(int target_cycle) {
+	if (unlikely(j == NULL))
+		replay_init_thread();
+	return replay_seek_journal(target_cycle);
+}
+
+EXPORT void replay_seek_thread(pthread_t thread, int target_cycle,
+		const struct periph_time_travel *tt) {
+	struct replay_journal *journal = NULL;
+	pthread_mutex_lock(&replay_threads_mutex);
+	for (struct replay_thread *t = replay_threads; t != NULL; t = t->next)
+		if (pthread_equal(t->thread, thread))
+			journal = t->journal;
+	pthread_mutex_unlock(&replay_threads_mutex);
+
+	// Nothing recorded yet
+	if (journal == NULL)
+		return;
+
+	struct replay_journal *self = j;
+	j = journal;
+	replay_tt = tt;
+	replay_seek_journal(target_cycle);
+	replay_tt = NULL;
+	j = self;
+}
+
+#endif // HAVE_REPLAY
@@ -0,0 +1,63 @@
+/* Mulator - An extensible {ARM} {e,si}mulator
+ * Copyright 2011-2012  Pat Pannuto <pat.pannuto@gmail.com>
+ *
+ * This file is part of Mulator.
+ *
+ * Mulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "common.h"
+
+#ifndef PP_STRING
+#define PP_STRING "RPL"
+#include "pretty_print.h"
+#endif
+
+#ifdef HAVE_REPLAY
+
+// Bytes of history each thread keeps in memory before spilling to disk
+extern size_t replay_mem_limit;
+
+// Cycles between checkpoints, which long seeks jump between
+extern int replay_checkpoint_interval;
+
+// Called by the main thread as it starts each cycle, before any thread starts
+// its tick. Every thread's ticks are tagged with this cycle
+void replay_start_cycle(void);
+
+// Called before a thread's writes for a cycle, drops any history past the
+// current position (i.e. re-executing after a seek backwards)
+void replay_start_tick(void);
+
+// Store val at loc, recording the change for the current cycle
+void replay_write(uint32_t *loc, uint32_t val);
+void replay_write_p(uint32_t **ploc, uint32_t *pval);
+void replay_write_block(uint32_t *loc, const uint32_t *vals, int count);
+
+// Moves the calling thread's state to the end of target_cycle, as far as the
+// recorded history allows. Returns the cycle reached
+int replay_seek(int target_cycle);
+
+// Moves another thread's (async peripheral's) history to target_cycle,
+// making each change through tt's rewind / replay hooks
+struct periph_time_travel;
+void replay_seek_thread(pthread_t thread, int target_cycle,
+		const struct periph_time_travel *tt);
+
+#endif // HAVE_REPLAY
+
+#endif // REPLAY_H
@@ -36,6 +36,15 @@
 #include "if_stage.h"
 #include "id_stage.h"
 #include "ex_stage.h"
+#include "blocks.h"
+#include "replay.h"
+#include "energy.h"
+#include "profile.h"
+#include "callstack.h"
+#include "trace.h"
+#include "memdump.h"
+#include "dirty.h"
+#include "symbols.h"
 #include "cpu/core.h"
 #include "cpu/periph.h"
 #include "cpu/registers.h"
@@ -78,6 +87,7 @@ EXPORT int dumpatcycle = -1;
 EXPORT int dumpallcycles = 0;
 EXPORT int returnr0 = 0;
 EXPORT int usetestflash = 0;
+EXPORT const char *pairstats_file = NULL;
 
 /*terminate */
 int64_t cycle_terminate = 0;
@@ -194,36 +204,30 @@ static void print_full_state(void) {
 
 	{
 		const char *file;
-		size_t ret;
+		ssize_t ret;
 
 #if defined (HAVE_ROM) && defined (PRINT_ROM_ENABLE)
 		file = get_dump_name('o');
-		FILE* romfp = fopen(file, "w");
-		if (romfp) {
-			ret = dump_ROM(romfp);
+		ret = dump_ROM(file);
+		if (ret >= 0)
 			printf("Wrote %8zu bytes to %-29s "\
 					"(Use 'hexdump -C' to view)\n",
-					ret*ROMSIZE, file);
-			fclose(romfp);
-		} else {
+					(size_t) ROMSIZE, file);
+		else
 			perror("No ROM dump");
-		}
 #endif
 
 		// rom --> ram
 		file = get_dump_name('a');
 
 #if defined (HAVE_RAM)
-		FILE* ramfp = fopen(file, "w");
-		if (ramfp) {
-			ret = dump_RAM(ramfp);
+		ret = dump_RAM(file);
+		if (ret >= 0)
 			printf("Wrote %8zu bytes to %-29s "\
 					"(Use 'hexdump -C' to view)\n",
-					ret*RAMSIZE, file);
-			fclose(ramfp);
-		} else {
+					(size_t) RAMSIZE, file);
+		else
 			perror("No RAM dump");
-		}
 #endif
 	}
 
@@ -281,38 +285,20 @@ static void _shell(void) {
 			sim_terminate(true);
 
 		case 'r':
-		{
-			const char *file;
-
 #if defined (HAVE_ROM) && defined (PRINT_ROM_ENABLE)
 			if (buf[1] == 'o') {
-				file = get_dump_name('o');
-			} else
+				print_ROM(stdout);
+				return _shell();
+			}
 #endif
+#if defined (HAVE_RAM)
 			if (buf[1] == 'a') {
-				file = get_dump_name('a');
-			} else {
-				file = NULL;
-				buf[1] = '\0';
-				// now fall through 'c' to help
-			}
-
-			if (file) {
-				char *cmd;
-				if (-1 == asprintf(&cmd, "hexdump -C %s", file))
-					ERR(E_UNKNOWN, "Failure allocating cmd string\n");
-				FILE *out = popen(cmd, "r");
-
-				char hex_buf[100];
-				while ( fgets(hex_buf, 99, out) ) {
-					printf("%s", hex_buf);
-				}
-
-				pclose(out);
-
+				print_RAM(stdout);
 				return _shell();
 			}
-		}
+#endif
+			buf[1] = '\0';
+			// now fall through 'c' to help
 
 		case '\n':
 			//sprintf(buf, "cycle %d\n", cycle+1);
@@ -333,7 +319,7 @@ static void _shell(void) {
 					return;
 				}
 			} else if (buf[1] == 'o') {
-				dumpatcycle = 0;
+				dumpatcycle = -1;
 				dumpatpc = 0;
 				return;
 			}
@@ -465,10 +451,20 @@ static mach_timebase_info_data_t sTimebaseInfo;
 #endif
 
 #ifdef HAVE_REPLAY
+static void periph_time_travel_start(bool rewind);
+static void periph_time_travel_end(bool rewind);
+static void periph_state_seek(int target, bool rewind);
+
 EXPORT bool simulator_state_seek(int target) {
-	WARN("Async peripheral state not changed\n");
+	bool rewind = target < cycle;
+
+	// Peripherals are held for the whole seek, the core's history has its
+	// own writes to their state (e.g. reading out a UART buffer)
+	periph_time_travel_start(rewind);
 	int pipeline_cycle = pipeline_state_seek(target);
 	int simulator_cycle = state_seek_for_calling_thread(target);
+	periph_state_seek(target, rewind);
+	periph_time_travel_end(rewind);
 	if (pipeline_cycle != simulator_cycle) {
 		WARN("Pipeline and simulator core out of sync after seek\n");
 		ERR(E_UNKNOWN, "Pipeline cycle %d. Simulator cycle %d\n",
@@ -485,6 +481,9 @@ EXPORT bool simulator_state_seek(int target) {
 }
 #endif
 
+// The image run, for reports
+static const char *sim_flash_file;
+
 static struct timeval sim_execute_time_start = {0, 0};
 static bool sim_awake = true;
 static double sim_elapsed;
@@ -589,7 +588,7 @@ static void sim_delay(void) {
 #endif
 }
 
-static int sim_execute(void) {
+EXPORT void sim_cycle_begin(void) {
 	// XXX: What if the debugger wants to execute the same instruction two
 	// cycles in a row? How do we allow this?
 	static uint32_t prev_pc = STALL_PC;
@@ -597,6 +596,11 @@ static int sim_execute(void) {
 	cycle++;
 	DBG2("Begin cycle %d.............................cycle %d\n", cycle, cycle);
 
+#ifdef HAVE_REPLAY
+	replay_start_cycle();
+	const int64_t this_cycle = cycle;
+#endif
+
 	// Simulator main thread ticks and tocks so that branch-to-self logic resets
 	state_start_tick();
 
@@ -614,6 +618,12 @@ static int sim_execute(void) {
 			if (GDB_ATTACHED) {
 				INFO("Simulator determined PC 0x%08x is branch to self, breaking for gdb.\n", cur_pc);
 				shell();
+#ifdef HAVE_REPLAY
+				// gdb seeked, the core is now at the end of another
+				// cycle and the next one starts over from there
+				if (cycle != this_cycle)
+					return sim_cycle_begin();
+#endif
 			} else {
 				cycle_terminate++;
 				if(cycle_terminate == TERMINATE_CNT) {
@@ -628,6 +638,36 @@ static int sim_execute(void) {
 	}
 
 	state_tock();
+}
+
+// Whether the main loop has anything to do before the next cycle
+EXPORT bool sim_break_pending(void) {
+	return sigint ||
+		((limitcycles != -1) && limitcycles <= cycle) ||
+		((dumpatcycle != -1) && (dumpatcycle <= cycle)) ||
+		((dumpatpc & 0xfffffffe) == (CORE_reg_read(PC_REG) & 0xfffffffe)) ||
+		dumpallcycles;
+}
+
+#ifdef BLOCK_ENGINE
+// Anything that has to observe every cycle keeps the stage-by-stage path
+static bool sim_blocks_allowed(void) {
+	return !GDB_ATTACHED && !printcycles && !dumpallcycles && !pairstats_file &&
+		!profile_file && !profile_callgrind_file && !trace_flag &&
+#ifdef HAVE_DECOMPILE
+		!decompile_flag &&
+#endif
+		!cycle_time.tv_nsec;
+}
+#endif
+
+static int sim_execute(void) {
+#ifdef BLOCK_ENGINE
+	if (sim_blocks_allowed() && blocks_run())
+		return SUCCESS;
+#endif
+
+	sim_cycle_begin();
 
 	// Start a clock tick
 	pipeline_stages_tick();
@@ -679,7 +719,10 @@ static void sim_reset(void) {
 		if ((limitcycles != -1) && limitcycles <= cycle) {
 			ERR(E_UNKNOWN, "Cycle limit (%d) reached.\n", limitcycles);
 		} else
-		if (dumpatcycle == cycle) {
+		if ((dumpatcycle != -1) && (dumpatcycle <= cycle)) {
+			// Instructions that take more than one cycle can step past
+			// the requested cycle, stop at the first one after it
+			dumpatcycle = -1;
 			shell();
 		} else
 		if ((dumpatpc & 0xfffffffe) == (CORE_reg_read(PC_REG) & 0xfffffffe)) {
@@ -698,6 +741,7 @@ static void sim_reset(void) {
 
 EXPORT void sim_terminate(bool should_exit) {
 	static bool terminating = false;
+	int ram_differs = 0;
 	if (terminating) {
 		WARN("Nested calls to terminate. Dying\n");
 		exit(EXIT_FAILURE);
@@ -718,10 +762,42 @@ EXPORT void sim_terminate(bool should_exit) {
 		WARN("Wasted %u cycle(s) to unaligned memory accesses\n",
 				core_stats_unaligned_cycle_penalty);
 	}
+#ifdef HAVE_ENERGY
+	if (energy_flag)
+		energy_report();
+#endif
+	if (callstack_report_file || callstack_folded_file)
+		callstack_report();
+	if (profile_file || profile_callgrind_file)
+		profile_report((usetestflash) ? NULL : sim_flash_file);
+	if (trace_flag)
+		trace_close();
+	if (pairstats_file) {
+		FILE *fp = fopen(pairstats_file, "w");
+		if (fp == NULL) {
+			WARN("Could not open %s: %s\n", pairstats_file,
+					strerror(errno));
+		} else {
+			unsigned n = opcode_pairs_dump(fp);
+			fclose(fp);
+			INFO("Wrote %u op pairs to %s\n", n, pairstats_file);
+		}
+	}
+	if (dirty_report_file)
+		dirty_report();
+	if (compare_ram_file) {
+#ifdef HAVE_RAM
+		ram_differs = compare_RAM(compare_ram_file);
+#else
+		WARN("There is no RAM to compare with %s\n", compare_ram_file);
+#endif
+	}
 	join_periph_threads();
 	INFO("Simulator shutdown successfully.\n");
 	if (!should_exit)
 		return;
+	if (ram_differs)
+		exit(EXIT_FAILURE);
 	if (returnr0) {
 		uint32_t r0 = CORE_reg_read(0);
 		DBG2("Return code is r0: %08x\n", r0);
@@ -843,6 +919,43 @@ EXPORT void register_periph_thread(
 	}
 }
 
+#ifdef HAVE_REPLAY
+static void periph_time_travel_start(bool rewind) {
+	if (periph_threads.fn == NULL)
+		return;
+	for (struct periph_thread *cur = &periph_threads; cur != NULL; cur = cur->next) {
+		int (*fn)(void) = (rewind) ? cur->tt.rewind_start_fn : cur->tt.replay_start_fn;
+		if (cur->active && fn)
+			fn();
+	}
+}
+
+static void periph_time_travel_end(bool rewind) {
+	if (periph_threads.fn == NULL)
+		return;
+	for (struct periph_thread *cur = &periph_threads; cur != NULL; cur = cur->next) {
+		int (*fn)(void) = (rewind) ? cur->tt.rewind_end_fn : cur->tt.replay_end_fn;
+		if (cur->active && fn)
+			fn();
+	}
+}
+
+static void periph_state_seek(int target, bool rewind) {
+	if (periph_threads.fn == NULL)
+		return;
+	for (struct periph_thread *cur = &periph_threads; cur != NULL; cur = cur->next) {
+		if (!cur->active)
+			continue;
+		if (((rewind) ? cur->tt.rewind : cur->tt.replay) == NULL) {
+			WARN("%s cannot time travel, its state was not changed\n",
+					cur->name);
+			continue;
+		}
+		replay_seek_thread(cur->pthread, target, &cur->tt);
+	}
+}
+#endif
+
 EXPORT void simulator(const char *flash_file) {
 	const char thread_name[16] = "Simulator main";
 #ifdef __APPLE__
@@ -865,8 +978,12 @@ EXPORT void simulator(const char *flash_file) {
 			}
 		} else {
 			load_file(flash_file);
+			if ((profile_file || profile_callgrind_file ||
+						callstack_flag) && (symbols_file == NULL))
+				symbols_load_beside(flash_file);
 		}
 	}
+	sim_flash_file = flash_file;
 
 	load_opcodes();
 
@@ -882,6 +999,10 @@ EXPORT void simulator(const char *flash_file) {
 			ERR(E_UNKNOWN, "pthread_sigmask: %s", strerror(ret));
 	}
 
+	// After the mask, so the flusher leaves SIGINT to sig_thread too
+	if (trace_file)
+		trace_open(trace_file);
+
 	// Spawn signal handling thread
 	pthread_t sig_pthread;
 	pthread_create(&sig_pthread, NULL, &sig_thread, (void *) &set);
@@ -48,6 +48,9 @@
 // The simulator core
 void simulator(const char* flash_file);
 void sim_terminate(bool should_exit);
+// Per-cycle bookkeeping, for engines that run cycles outside sim_execute
+void sim_cycle_begin(void);
+bool sim_break_pending(void);
 bool state_handle_exceptions(void);
 
 // Simulator config
@@ -66,6 +69,7 @@ extern int dumpallcycles;
 extern int limitcycles;
 extern int returnr0;
 extern int usetestflash;
+extern const char *pairstats_file;
 
 // Simulator state
 //extern int cycle;
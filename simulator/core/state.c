@@ -26,6 +26,8 @@
 #include "simulator.h"
 #include "opcodes.h"
 #include "pipeline.h"
+#include "replay.h"
+#include "energy.h"
 
 #include "cpu/core.h"
 #include "cpu/exception.h"
@@ -35,15 +37,30 @@ static uint32_t state_pipeline_new_pc = -1;
 static thread_local struct op* state_next_id_ex_o = NULL;
 #endif
 
+/* Direct state:
+ *
+ * With NO_PIPELINE every stage commits its writes before the next stage runs
+ * and, without HAVE_REPLAY, the journal is never looked at again. DIRECT_STATE
+ * drops it and SW() stores straight to its target. The PC is the exception:
+ * handlers still read it as the address of the executing instruction after
+ * they branch, so state_write_pc holds the new PC until the stage's tock.
+ */
+#ifdef DIRECT_STATE
+#if !defined(NO_PIPELINE) || defined(HAVE_REPLAY)
+#error "DIRECT_STATE requires NO_PIPELINE and cannot be used with HAVE_REPLAY"
+#endif
+static bool state_pc_pending = false;
+static uint32_t state_pending_pc;
+#endif
+
 struct state_change {
 	uint32_t *loc;
 	uint32_t val;
 	uint32_t **ploc;
 	uint32_t *pval;
-#ifdef HAVE_REPLAY
-	uint32_t prev_val;
-	uint32_t *prev_pval;
-#endif
+	// Block writes: count words from block to loc[0..count)
+	int count;
+	uint32_t *block;
 #ifdef DEBUG1
 	const char* file;
 	const char* func;
@@ -54,29 +71,22 @@ struct state_change {
 
 
 ////
+#ifdef COOPERATIVE_PIPELINE
+// All pipeline stages share the main thread's journal
+#define STATE_MAX_WRITES 64
+#else
 #define STATE_MAX_WRITES 32
+#endif
 static thread_local int state_tls_count = 0;
 
-#ifdef HAVE_REPLAY
-struct state_change_list {
-	int cycle;
-	struct state_change_list *next;
-	struct state_change_list *prev;
-
-	int write_count;
-	struct state_change writes[STATE_MAX_WRITES];
-};
+// Word storage shared by all block writes in a cycle
+#define STATE_MAX_BLOCK_WORDS 64
+static thread_local int state_tls_block_count = 0;
 
-static thread_local struct state_change_list write_root = {
-	.cycle = 0,
-	.next = NULL,
-	.prev = NULL,
-	.write_count = 0,
-};
-static thread_local struct state_change_list* write_cur;
-#else
+// Writes are held here until the stage's tock, replay history (replay.c)
+// records them as they are committed
 static thread_local struct state_change writes[STATE_MAX_WRITES];
-#endif // HAVE_REPLAY
+static thread_local uint32_t block_vals[STATE_MAX_BLOCK_WORDS];
 ////
 
 #ifdef HAVE_STDATOMIC
@@ -125,11 +135,14 @@ static void async_exception_sems_init(void) {
 	set_pending_async_exception_sem = sem_open(name_buf, O_CREAT|O_EXCL, 0600, 1);
 	if (set_pending_async_exception_sem == SEM_FAILED)
 		ERR(E_UNKNOWN, "Creating pending async sem: %s\n", strerror(errno));
+	// Only the handle is needed, drop the name so it is not left in /dev/shm
+	sem_unlink(name_buf);
 
 	snprintf(name_buf, 32, "/%d-pending-sem", getpid());
 	pending_exception_sem = sem_open(name_buf, O_CREAT|O_EXCL, 0600, 0);
 	if (pending_exception_sem == SEM_FAILED)
 		ERR(E_UNKNOWN, "Creating pending exc sem: %s\n", strerror(errno));
+	sem_unlink(name_buf);
 }
 
 ///////
@@ -196,10 +209,12 @@ EXPORT void state_assert_interrupt_async(unsigned interrupt) {
 
 	if (unlikely(atomic_load(&wfi_bool))) {
 		sim_sleep();
+		ENERGY_SLEEP();
 		ret = sem_wait(pending_exception_sem);
 		if (ret == 0) {
 			atomic_store(&wfi_bool, false);
 			sim_wakeup();
+			ENERGY_WAKEUP();
 		}
 	} else {
 		ret = sem_trywait(pending_exception_sem);
@@ -230,37 +245,10 @@ EXPORT void state_wait_for_interrupt(void) {
 
 EXPORT void state_start_tick(void) {
 	state_tls_count = 0;
+	state_tls_block_count = 0;
 
 #ifdef HAVE_REPLAY
-	if (unlikely(NULL == write_cur))
-		write_cur = &write_root;
-
-	if (write_cur->cycle != (cycle - 1)) {
-		WARN("Local cycle does not match global cycle?\n");
-		ERR(E_UNKNOWN, "write_cur->cycle: %d, cycle - 1: %d\n",
-				write_cur->cycle, cycle - 1);
-	}
-
-	if (NULL != write_cur->next) {
-		DBG1("Simulator re-excuting at cycle %d\n", cycle);
-		DBG1("Discarding all future state\n");
-
-		struct state_change_list* l = write_cur->next;
-		while (l->next != NULL) {
-			l = l->next;
-			free(l->prev);
-		}
-		free(l);
-		write_cur->next = NULL;
-	}
-
-	write_cur->next = malloc(sizeof(struct state_change_list));
-	assert(write_cur->next && "Allocating state history memory");
-	write_cur->next->prev = write_cur;
-	write_cur = write_cur->next;
-	write_cur->cycle = cycle;
-	write_cur->next = NULL;
-	write_cur->write_count = 0;
+	replay_start_tick();
 #endif
 }
 
@@ -291,17 +279,23 @@ EXPORT bool state_handle_exceptions(void) {
 }
 
 EXPORT void state_tock(void) {
-#ifdef HAVE_REPLAY
-#define W write_cur->writes
-	write_cur->write_count = state_tls_count;
-#else
 #define W writes
-#endif
 	for (int i = 0; i < state_tls_count; i++) {
-		if (W[i].loc != NULL)
+#ifdef HAVE_REPLAY
+		if (W[i].count)
+			replay_write_block(W[i].loc, W[i].block, W[i].count);
+		else if (W[i].loc != NULL)
+			replay_write(W[i].loc, W[i].val);
+		else
+			replay_write_p(W[i].ploc, W[i].pval);
+#else
+		if (W[i].count)
+			memcpy(W[i].loc, W[i].block, W[i].count * sizeof(uint32_t));
+		else if (W[i].loc != NULL)
 			*(W[i].loc) = W[i].val;
 		else
 			*(W[i].ploc) = W[i].pval;
+#endif
 	}
 #ifndef NO_PIPELINE
 	if (state_next_id_ex_o != NULL) {
@@ -309,9 +303,36 @@ EXPORT void state_tock(void) {
 		state_next_id_ex_o = NULL;
 	}
 #endif // NO_PIPELINE
+#ifdef DIRECT_STATE
+	if (state_pc_pending) {
+		state_pc_pending = false;
+		pipeline_flush_exception_handler(state_pending_pc);
+	}
+#endif
 #undef W
 }
 
+#ifdef DIRECT_STATE
+EXPORT void state_write_pc(uint32_t new_pc) {
+	if (state_is_debugging()) {
+		pipeline_flush_exception_handler(new_pc);
+		return;
+	}
+	state_pending_pc = new_pc;
+	state_pc_pending = true;
+}
+#endif
+
+// With DIRECT_STATE only DEBUG1 builds get to the out-of-line writers, they
+// keep their call-site tracking but never journal
+static inline bool state_write_is_direct(void) {
+#ifdef DIRECT_STATE
+	return true;
+#else
+	return state_is_debugging();
+#endif
+}
+
 #ifdef DEBUG1
 static void _state_write_dbg(uint32_t *loc, uint32_t val,
 		uint32_t** ploc, uint32_t* pval,
@@ -328,7 +349,7 @@ static void _state_write(uint32_t *loc, uint32_t val,
 	//
 	// This mechanism is also leveraged to write directly to memory when the
 	// simulator is first starting up (flashing the program image).
-	if (state_is_debugging()) {
+	if (state_write_is_direct()) {
 		if (loc)
 			*loc = val;
 		else
@@ -344,11 +365,7 @@ static void _state_write(uint32_t *loc, uint32_t val,
 		WARN("Maximum write location count exceeded\n");
 		ERR(E_UNKNOWN, "Need to increment state.c::STATE_MAX_WRITES\n");
 	}
-#ifdef HAVE_REPLAY
-#define S write_cur->writes[s_c].
-#else
 #define S writes[s_c].
-#endif
 
 	DBG2("cycle: %08d\t(%s): loc %p val %08x\n",
 			cycle, target, loc, val);
@@ -357,10 +374,7 @@ static void _state_write(uint32_t *loc, uint32_t val,
 	S val = val;
 	S ploc = ploc;
 	S pval = pval;
-#ifdef HAVE_REPLAY
-	S prev_val = (loc) ? *loc : 0;
-	S prev_pval = (ploc) ? *ploc : NULL;
-#endif
+	S count = 0;
 #ifdef DEBUG1
 	S file = file;
 	S func = func;
@@ -380,23 +394,6 @@ static void _state_write_async(uint32_t *loc, uint32_t val,
 		uint32_t** ploc, uint32_t* pval) {
 #endif
 
-#ifdef HAVE_REPLAY
-	if (unlikely(NULL == write_cur))
-		write_cur = &write_root;
-
-	// XXX: There are races / issues here if anything async happens
-	//      while seeking through state
-
-	if (write_cur->cycle < cycle)
-		state_start_tick();
-
-#ifdef DEBUG1
-	_state_write_dbg(loc, val, ploc, pval, file, func, line, target);
-#else
-	_state_write(loc, val, ploc, pval);
-#endif
-
-#else // !HAVE_REPLAY
 #ifdef DEBUG1
 	// Suppress unused warnings in this compile option path
 	(void) file;
@@ -404,8 +401,17 @@ static void _state_write_async(uint32_t *loc, uint32_t val,
 	(void) line;
 	(void) target;
 #endif
-#endif // HAVE_REPLAY
 
+#ifdef HAVE_REPLAY
+	// XXX: There are races / issues here if anything async happens
+	//      while seeking through state
+	if (loc) {
+		replay_write(loc, val);
+	} else {
+		assert(NULL != ploc);
+		replay_write_p(ploc, pval);
+	}
+#else
 	// "state tock"
 	if (loc) {
 		*loc = val;
@@ -413,6 +419,7 @@ static void _state_write_async(uint32_t *loc, uint32_t val,
 		assert(NULL != ploc);
 		*ploc = pval;
 	}
+#endif // HAVE_REPLAY
 }
 
 #ifdef DEBUG1
@@ -457,6 +464,49 @@ EXPORT void state_write_p_async(uint32_t **ploc, uint32_t *pval) {
 }
 #endif
 
+// Latches count consecutive words as a single journal entry
+#ifdef DEBUG1
+EXPORT void state_write_block_dbg(uint32_t *loc, const uint32_t *vals, int count,
+		const char *file, const char* func,
+		const int line, const char *target) {
+#else
+EXPORT void state_write_block(uint32_t *loc, const uint32_t *vals, int count) {
+#endif
+	if (state_write_is_direct()) {
+		memcpy(loc, vals, count * sizeof(uint32_t));
+		return;
+	}
+
+	int s_c = state_tls_count++;
+	if (unlikely(s_c == STATE_MAX_WRITES)) {
+		WARN("Maximum write location count exceeded\n");
+		ERR(E_UNKNOWN, "Need to increment state.c::STATE_MAX_WRITES\n");
+	}
+	int b_c = state_tls_block_count;
+	state_tls_block_count += count;
+	if (unlikely(state_tls_block_count > STATE_MAX_BLOCK_WORDS)) {
+		WARN("Maximum block write words exceeded\n");
+		ERR(E_UNKNOWN, "Need to increment state.c::STATE_MAX_BLOCK_WORDS\n");
+	}
+#define S writes[s_c].
+	S block = &block_vals[b_c];
+
+	DBG2("cycle: %08d\t(%s): loc %p count %d\n",
+			cycle, target, loc, count);
+
+	memcpy(S block, vals, count * sizeof(uint32_t));
+	S loc = loc;
+	S count = count;
+	S ploc = NULL;
+#ifdef DEBUG1
+	S file = file;
+	S func = func;
+	S line = line;
+	S target = target;
+#endif
+#undef S
+}
+
 // Lazy hack since every other bit of preserved state is a uint32_t[*]
 // At some point in time state saving will likely have to be generalized,
 // until then, however, this will suffice
@@ -495,63 +545,14 @@ EXPORT void state_pipeline_flush(uint32_t new_pc) {
 // Returns >0 on tolerable error (e.g. seek past end)
 // Returns <0 on catastrophic error
 EXPORT int state_seek_for_calling_thread(int target_cycle) {
-	int current_cycle = cycle;
-
-	if (write_cur == NULL) {
-		DBG1("Seek request before any cycle executed. Ignored\n");
-		return current_cycle;
-	}
-
-#ifdef NO_PIPELINE
-	WARN("TODO: Cycle seek logic in NO_PIPELINE doesn't account multiple links / cycle\n");
-#endif
-
-	if (target_cycle > current_cycle) {
-		DBG1("seeking forward from %d to %d\n", current_cycle, target_cycle);
-		while (target_cycle > current_cycle) {
-			if (write_cur->next == NULL) {
-				break;
-			}
-
-			for (int i=0; i < write_cur->write_count; i++) {
-				if (write_cur->writes[i].loc) {
-					*(write_cur->writes[i].loc) = write_cur->writes[i].val;
-				} else {
-					*(write_cur->writes[i].ploc) = write_cur->writes[i].pval;
-				}
-			}
-
-			write_cur = write_cur->next;
-			current_cycle = write_cur->cycle;
-		}
-	} else if (target_cycle == current_cycle) {
-		DBG1("Request to seek to current cycle ignored\n");
-	} else {
-		DBG1("seeking backward from %d to %d\n", current_cycle, target_cycle);
-		while (write_cur->cycle > target_cycle) {
-			if (write_cur->prev == NULL) {
-				assert(current_cycle == 0);
-				break;
-			}
-
-			for (int i=0; i < write_cur->write_count; i++) {
-				if (write_cur->writes[i].loc) {
-					*(write_cur->writes[i].loc) = write_cur->writes[i].prev_val;
-				} else {
-					*(write_cur->writes[i].ploc) = write_cur->writes[i].prev_pval;
-				}
-			}
-			write_cur = write_cur->prev;
-			current_cycle = write_cur->cycle;
-		}
-	}
+	int ret = replay_seek(target_cycle);
 
 	// One last bit of fixup since we don't actually track
 	// the op pointer
 	// XXX: threads
 	id_ex_o = find_op(id_ex_inst);
 
-	return current_cycle;
+	return ret;
 }
 #else
 EXPORT int state_seek(int target_cycle __attribute__ ((unused))) {
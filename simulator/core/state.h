@@ -37,6 +37,9 @@ void state_tock(void);
 #ifndef NO_PIPELINE
 void state_pipeline_flush(uint32_t new_pc);
 #endif
+#ifdef DIRECT_STATE
+void state_write_pc(uint32_t new_pc);
+#endif
 
 void state_async_block_start(void);
 void state_async_block_end(void);
@@ -52,12 +52,31 @@ void state_write_p_dbg(uint32_t **ploc, uint32_t *pval,
 		const char *file, const char* func,
 		const int line, const char *target)
 			__attribute__ ((nonnull (1, 3, 4, 6)));
+#define SWB(_l, _v, _n) state_write_block_dbg((_l), (_v), (_n),\
+		__FILE__, __func__, __LINE__, VAL2STR(_l))
+void state_write_block_dbg(uint32_t *loc, const uint32_t *vals, int count,
+		const char *file, const char *func,
+		const int line, const char *target) __attribute__ ((nonnull));
+#elif defined(DIRECT_STATE)
+// Nothing is journaled, writes land immediately (see state.c)
+#define SW(_l, _v) state_write_direct((_l), (_v))
+export_inline void state_write_direct(uint32_t *loc, uint32_t val) {
+	*loc = val;
+}
+#define SWP(_l, _v) state_write_p_direct((_l), (_v))
+export_inline void state_write_p_direct(uint32_t **ploc, uint32_t *pval) {
+	*ploc = pval;
+}
+#define SWB(_l, _v, _n) memcpy((_l), (_v), (_n) * sizeof(uint32_t))
 #else
 #define SW(_l, _v) state_write((_l), (_v))
 void state_write(uint32_t *loc, uint32_t val)
 	__attribute__ ((nonnull));
 #define SWP(_l, _v) state_write_p((_l), (_v))
 void state_write_p(uint32_t **ploc, uint32_t *pval) __attribute__ ((nonnull (1)));
+#define SWB(_l, _v, _n) state_write_block((_l), (_v), (_n))
+void state_write_block(uint32_t *loc, const uint32_t *vals, int count)
+	__attribute__ ((nonnull));
 #endif
 
 void state_wait_for_interrupt(void);
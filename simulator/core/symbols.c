@@ -0,0 +1,196 @@
+/* Mulator - An extensible {ARM} {e,si}mulator
+ * Copyright 2011-2016  Pat Pannuto <pat.pannuto@gmail.com>
+ *
+ * This file is part of Mulator.
+ *
+ * Mulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "symbols.h"
+
+#include <sys/stat.h>
+
+/* Code symbols
+ *
+ * Images are flashed from raw .bin files, so names for reports come from the
+ * ELF the image was made from. Only the section and symbol tables are read,
+ * by hand, so this works without libelf (see loader.c). Kept are functions,
+ * and untyped labels in executable sections (assembly entry points), but not
+ * the $t/$d mapping symbols.
+ */
+
+// ELF32 layout, little-endian (ARM EABI)
+#define SHT_SYMTAB	2
+#define SHF_EXECINSTR	0x4
+#define STT_NOTYPE	0
+#define STT_FUNC	2
+#define SHN_UNDEF	0
+#define SHN_LORESERVE	0xff00
+
+EXPORT const char *symbols_file = NULL;
+
+static struct symbol *syms;
+static unsigned nsyms;
+static char *strtab;
+
+static uint16_t rd16(const uint8_t *p) {
+	return p[0] | (p[1] << 8);
+}
+
+static uint32_t rd32(const uint8_t *p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static int cmp_sym(const void *a, const void *b) {
+	const struct symbol *sa = a;
+	const struct symbol *sb = b;
+	if (sa->addr != sb->addr)
+		return (sa->addr < sb->addr) ? -1 : 1;
+	// Sized (FUNC) symbols before labels at the same address
+	return (sa->size < sb->size) - (sa->size > sb->size);
+}
+
+EXPORT void symbols_load(const char *file) {
+	FILE *fp = fopen(file, "rb");
+	struct stat st;
+	uint8_t *elf;
+
+	if ((fp == NULL) || (0 != fstat(fileno(fp), &st)))
+		ERR(E_UNKNOWN, "Could not open symbol file %s: %s\n",
+				file, strerror(errno));
+	elf = malloc(st.st_size);
+	if ((elf == NULL) || (1 != fread(elf, st.st_size, 1, fp)))
+		ERR(E_UNKNOWN, "Could not read symbol file %s\n", file);
+	fclose(fp);
+
+	if ((st.st_size < 0x34) || (0 != memcmp(elf, "\177ELF", 4)) ||
+			(elf[4] != 1) || (elf[5] != 1))
+		ERR(E_UNKNOWN, "%s is not a little-endian ELF32 file\n", file);
+
+	uint32_t shoff = rd32(elf + 0x20);
+	uint16_t shentsize = rd16(elf + 0x2e);
+	uint16_t shnum = rd16(elf + 0x30);
+	if ((shoff + (uint64_t) shnum * shentsize) > (uint64_t) st.st_size)
+		ERR(E_UNKNOWN, "%s: section headers past end of file\n", file);
+#define SH(_i)	(elf + shoff + (_i) * shentsize)
+
+	unsigned i;
+	for (i = 0; i < shnum; i++) {
+		const uint8_t *sh = SH(i);
+		if (rd32(sh + 4) != SHT_SYMTAB)
+			continue;
+
+		uint32_t off = rd32(sh + 16);
+		uint32_t size = rd32(sh + 20);
+		uint32_t link = rd32(sh + 24);
+		uint32_t entsize = rd32(sh + 36);
+		if ((link >= shnum) || (entsize < 16) ||
+				(off + (uint64_t) size > (uint64_t) st.st_size))
+			ERR(E_UNKNOWN, "%s: malformed symbol table\n", file);
+
+		uint32_t str_off = rd32(SH(link) + 16);
+		uint32_t str_size = rd32(SH(link) + 20);
+		if ((str_off + (uint64_t) str_size > (uint64_t) st.st_size) ||
+				(str_size == 0))
+			ERR(E_UNKNOWN, "%s: malformed string table\n", file);
+		strtab = malloc(str_size);
+		memcpy(strtab, elf + str_off, str_size);
+		strtab[str_size - 1] = '\0';
+
+		syms = calloc(size / entsize, sizeof(struct symbol));
+		uint32_t s;
+		for (s = 0; s < size / entsize; s++) {
+			const uint8_t *sym = elf + off + s * entsize;
+			uint32_t name = rd32(sym);
+			uint8_t type = sym[12] & 0xf;
+			uint16_t shndx = rd16(sym + 14);
+
+			if ((name == 0) || (name >= str_size) ||
+					(strtab[name] == '$'))
+				continue;
+			if ((shndx == SHN_UNDEF) || (shndx >= SHN_LORESERVE) ||
+					(shndx >= shnum))
+				continue;
+			if (type == STT_NOTYPE) {
+				if (!(rd32(SH(shndx) + 8) & SHF_EXECINSTR))
+					continue;
+			} else if (type != STT_FUNC) {
+				continue;
+			}
+
+			syms[nsyms].addr = rd32(sym + 4) & 0xfffffffe;
+			syms[nsyms].size = rd32(sym + 8);
+			syms[nsyms].name = strtab + name;
+			nsyms++;
+		}
+		break;
+	}
+#undef SH
+	free(elf);
+
+	if (nsyms == 0)
+		WARN("No code symbols in %s (stripped?)\n", file);
+
+	qsort(syms, nsyms, sizeof(struct symbol), cmp_sym);
+	symbols_file = file;
+	INFO("Loaded %u symbols from %s\n", nsyms, file);
+}
+
+EXPORT void symbols_load_beside(const char *image) {
+	const char *dot = strrchr(image, '.');
+	size_t base = (dot) ? (size_t) (dot - image) : strlen(image);
+	char *elf = malloc(base + sizeof(".elf"));
+
+	if (elf == NULL)
+		ERR(E_UNKNOWN, "Out of memory for symbol file name\n");
+	memcpy(elf, image, base);
+	strcpy(elf + base, ".elf");
+	if ((0 != strcmp(elf, image)) && (0 == access(elf, R_OK)))
+		symbols_load(elf);
+	else
+		free(elf);
+}
+
+EXPORT const struct symbol *symbols_lookup(uint32_t addr) {
+	unsigned lo = 0, hi = nsyms;
+
+	// Last symbol at or below addr
+	while (lo < hi) {
+		unsigned mid = (lo + hi) / 2;
+		if (syms[mid].addr <= addr)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo == 0)
+		return NULL;
+
+	// Of several at one address, the first is the sized one
+	const struct symbol *sym = &syms[lo - 1];
+	while ((sym > syms) && ((sym - 1)->addr == sym->addr))
+		sym--;
+	if ((sym->size != 0) && (addr >= sym->addr + sym->size))
+		return NULL;
+	return sym;
+}
+
+EXPORT void symbols_name(uint32_t addr, char *buf, size_t len) {
+	const struct symbol *sym = symbols_lookup(addr);
+	if (sym == NULL)
+		snprintf(buf, len, "0x%08x", addr);
+	else if (sym->addr == addr)
+		snprintf(buf, len, "%s", sym->name);
+	else
+		snprintf(buf, len, "%s+0x%x", sym->name, addr - sym->addr);
+}
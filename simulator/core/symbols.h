@@ -0,0 +1,51 @@
+/* Mulator - An extensible {ARM} {e,si}mulator
+ * Copyright 2011-2016  Pat Pannuto <pat.pannuto@gmail.com>
+ *
+ * This file is part of Mulator.
+ *
+ * Mulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SYMBOLS_H
+#define SYMBOLS_H
+
+#include "common.h"
+
+#ifndef PP_STRING
+#define PP_STRING "SYM"
+#include "pretty_print.h"
+#endif
+
+struct symbol {
+	uint32_t addr;		// Without the Thumb bit
+	uint32_t size;		// 0 if the ELF did not say, runs to the next symbol
+	const char *name;
+};
+
+// The ELF file symbols were loaded from, or NULL
+extern const char *symbols_file;
+
+// Loads the code symbols of an ELF image (the one a .bin was made from)
+void symbols_load(const char *file);
+
+// Loads symbols from the ELF beside image (foo.bin -> foo.elf), if there is one
+void symbols_load_beside(const char *image);
+
+// The symbol addr falls in, or NULL if none does or none are loaded
+const struct symbol *symbols_lookup(uint32_t addr);
+
+// Writes "name+0xoff" (or the bare address without symbols) to buf
+void symbols_name(uint32_t addr, char *buf, size_t len);
+
+#endif // SYMBOLS_H
@@ -0,0 +1,236 @@
+/* Mulator - An extensible {ARM} {e,si}mulator
+ * Copyright 2011-2016  Pat Pannuto <pat.pannuto@gmail.com>
+ *
+ * This file is part of Mulator.
+ *
+ * Mulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "timing.h"
+#include "state_sync.h"
+#include "simulator.h"
+#include "pipeline.h"
+#include "energy.h"
+
+/* Instruction timing
+ *
+ * Every instruction takes the one cycle sim_cycle_begin starts for it. The
+ * operations charge anything beyond that here, by adding to `cycle` while
+ * they execute, so `cycle` counts core clock cycles rather than instructions.
+ *
+ * Costs are per class of instruction, not per encoding: the 16- and 32-bit
+ * encodings of an instruction share an operation and take the same time.
+ * Branch refill is charged wherever the PC is branched to (BranchTo and
+ * exception return), which covers B, BL, BX, BLX, CBZ, TBB, POP {PC} and
+ * LDR PC alike.
+ *
+ * The threaded pipeline already spends real cycles on a refill: a target IF
+ * did not predict flushes it, and the bubbles behind the flush are cycles of
+ * their own. Only what the bubbles do not cover is charged then, so pipelined
+ * and unpipelined builds count the same cycles.
+ *
+ * Wait states are charged per data access, from the MEMMAP_WAIT_STATES
+ * regions each platform declares in its memmap.h. Instruction fetch is
+ * assumed to keep up with execution and is not charged.
+ */
+
+#ifndef MEMMAP_WAIT_STATES
+#error "memmap.h must declare MEMMAP_WAIT_STATES, even if every region is 0"
+#endif
+
+#ifndef NO_PIPELINE
+// Cycles between a flush and the first instruction from the new PC
+#define PIPELINE_FLUSH_BUBBLES 2
+#endif
+
+// ARM DDI 0432C, Table 3-1. Assumes the fast (single-cycle) multiplier
+static const struct timing_model cortex_m0 = {
+	.cpu = "cortex-m0",
+	.load = 1,
+	.store = 1,
+	.ls_pipeline = false,
+	.per_reg = 1,
+	.load_pc = 1,
+	.refill = 2,
+	.bl = 1,
+	.mul = 0,
+	.mla = 0,
+	.mull_min = 0,
+	.mull_max = 0,
+	.div_min = 0,
+	.div_max = 0,
+};
+
+// ARM DDI 0337, Table 18-1. P is 1-3 by target alignment, 2 is charged
+static const struct timing_model cortex_m3 = {
+	.cpu = "cortex-m3",
+	.load = 1,
+	.store = 1,
+	.ls_pipeline = true,
+	.per_reg = 1,
+	.load_pc = 0,
+	.refill = 2,
+	.bl = 0,
+	.mul = 0,
+	.mla = 1,
+	.mull_min = 2,
+	.mull_max = 4,
+	.div_min = 1,
+	.div_max = 11,
+};
+
+// ARM DDI 0439, Table 3-1
+static const struct timing_model cortex_m4 = {
+	.cpu = "cortex-m4",
+	.load = 1,
+	.store = 1,
+	.ls_pipeline = true,
+	.per_reg = 1,
+	.load_pc = 0,
+	.refill = 2,
+	.bl = 0,
+	.mul = 0,
+	.mla = 0,
+	.mull_min = 0,
+	.mull_max = 0,
+	.div_min = 1,
+	.div_max = 11,
+};
+
+static const struct timing_model *models[] = {
+	&cortex_m0,
+	&cortex_m3,
+	&cortex_m4,
+};
+
+EXPORT const struct timing_model *timing;
+
+static const struct {
+	uint32_t bot;
+	uint32_t top;
+	int wait;
+} wait_states[] = { MEMMAP_WAIT_STATES };
+
+// Cycle the last load/store single ended on, for ls_pipeline
+static uint32_t ls_end_cycle;
+
+static inline int wait_for(uint32_t addr) {
+	unsigned i;
+	for (i = 0; i < sizeof(wait_states) / sizeof(wait_states[0]); i++)
+		if ((addr >= wait_states[i].bot) && (addr < wait_states[i].top))
+			return wait_states[i].wait;
+	return 0;
+}
+
+static void load_store(uint32_t addr, int cost) {
+	if (timing->ls_pipeline) {
+		// The address phase overlapped the previous load/store's data
+		if (SR(&ls_end_cycle) == (uint32_t) (cycle - 1))
+			cost--;
+		cycle += cost + wait_for(addr);
+		SW(&ls_end_cycle, (uint32_t) cycle);
+	} else {
+		cycle += cost + wait_for(addr);
+	}
+}
+
+EXPORT void timing_load(uint32_t addr) {
+	load_store(addr, timing->load);
+	ENERGY_EVENT(ENERGY_LOAD, 1);
+	ENERGY_READ(addr, 1);
+}
+
+EXPORT void timing_store(uint32_t addr) {
+	load_store(addr, timing->store);
+	ENERGY_EVENT(ENERGY_STORE, 1);
+	ENERGY_WRITE(addr, 1);
+}
+
+EXPORT void timing_load_multiple(uint32_t addr, int count) {
+	cycle += count * (timing->per_reg + wait_for(addr));
+	ENERGY_EVENT(ENERGY_MULTIPLE, count);
+	ENERGY_READ(addr, count);
+}
+
+EXPORT void timing_store_multiple(uint32_t addr, int count) {
+	cycle += count * (timing->per_reg + wait_for(addr));
+	ENERGY_EVENT(ENERGY_MULTIPLE, count);
+	ENERGY_WRITE(addr, count);
+}
+
+EXPORT void timing_load_pc(void) {
+	cycle += timing->load_pc;
+}
+
+EXPORT void timing_branch(uint32_t target) {
+	int cost = timing->refill;
+#ifndef NO_PIPELINE
+	// Mirrors the flush decision in CORE_pc_write
+	if (state_is_debugging() ||
+			(((SR(&if_id_PC) & 0xfffffffe) - 4) != target))
+		cost = MAX(0, cost - PIPELINE_FLUSH_BUBBLES);
+#else
+	(void) target;
+#endif
+	cycle += cost;
+	ENERGY_EVENT(ENERGY_BRANCH, 1);
+}
+
+EXPORT void timing_bl(void) {
+	cycle += timing->bl;
+}
+
+EXPORT void timing_mul(void) {
+	cycle += timing->mul;
+	ENERGY_EVENT(ENERGY_MUL, 1);
+}
+
+EXPORT void timing_mla(void) {
+	cycle += timing->mla;
+	ENERGY_EVENT(ENERGY_MLA, 1);
+}
+
+// Spreads min..max over the significant bits of val, as early termination does
+static int early_terminate(uint32_t val, bool is_signed, int min, int max) {
+	int bits;
+	if (is_signed)
+		bits = 32 - __builtin_clrsb((int32_t) val);
+	else
+		bits = (val) ? 32 - __builtin_clz(val) : 0;
+	return min + (bits * (max - min) + 31) / 32;
+}
+
+EXPORT void timing_mull(uint32_t rm_val, bool is_signed) {
+	cycle += early_terminate(rm_val, is_signed,
+			timing->mull_min, timing->mull_max);
+	ENERGY_EVENT(ENERGY_MULL, 1);
+}
+
+EXPORT void timing_div(uint32_t quotient, bool is_signed) {
+	cycle += early_terminate(quotient, is_signed,
+			timing->div_min, timing->div_max);
+	ENERGY_EVENT(ENERGY_DIV, 1);
+}
+
+__attribute__ ((constructor))
+void register_timing_model(void) {
+	unsigned i;
+	for (i = 0; i < sizeof(models) / sizeof(models[0]); i++) {
+		if (0 == strcmp(models[i]->cpu, CPU)) {
+			timing = models[i];
+			return;
+		}
+	}
+	ERR(E_NOT_IMPLEMENTED, "No timing model for CPU %s\n", CPU);
+}
@@ -0,0 +1,66 @@
+/* Mulator - An extensible {ARM} {e,si}mulator
+ * Copyright 2011-2016  Pat Pannuto <pat.pannuto@gmail.com>
+ *
+ * This file is part of Mulator.
+ *
+ * Mulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#include "common.h"
+
+#ifndef PP_STRING
+#define PP_STRING "TIM"
+#include "pretty_print.h"
+#endif
+
+// Cycle costs of one core, as cycles beyond the one every instruction takes.
+// Numbers are from the instruction timing table of each core's TRM
+struct timing_model {
+	const char *cpu;
+	int load;		// LDR{,B,H,SB,SH}, TBB/TBH table read
+	int store;		// STR{,B,H}
+	bool ls_pipeline;	// Back-to-back loads/stores overlap, dropping load/store
+	int per_reg;		// Each register of LDM/STM/PUSH/POP/LDRD/STRD
+	int load_pc;		// Loading the PC, before the refill
+	int refill;		// P, refilling the pipeline after a taken branch
+	int bl;			// BL, before the refill
+	int mul;		// MUL
+	int mla;		// MLA/MLS
+	int mull_min;		// {S,U}MULL, which terminate early on small operands
+	int mull_max;
+	int div_min;		// {S,U}DIV, which terminate early on small quotients
+	int div_max;
+};
+
+// The model for CPU, chosen at startup
+extern const struct timing_model *timing;
+
+// Each charges the cycles of one instruction (or part of one) to `cycle`.
+// Memory accesses also pay the wait states of the region addr falls in
+void timing_load(uint32_t addr);
+void timing_store(uint32_t addr);
+void timing_load_multiple(uint32_t addr, int count);
+void timing_store_multiple(uint32_t addr, int count);
+void timing_load_pc(void);
+void timing_branch(uint32_t target);
+void timing_bl(void);
+void timing_mul(void);
+void timing_mla(void);
+void timing_mull(uint32_t rm_val, bool is_signed);
+void timing_div(uint32_t quotient, bool is_signed);
+
+#endif // TIMING_H
@@ -0,0 +1,330 @@
+/* Mulator - An extensible {ARM} {e,si}mulator
+ * Copyright 2011-2016  Pat Pannuto <pat.pannuto@gmail.com>
+ *
+ * This file is part of Mulator.
+ *
+ * Mulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "trace.h"
+#include "simulator.h"
+#include "opcodes.h"
+
+#include <pthread.h>
+
+/* Binary execution trace
+ *
+ * The text traces (--printcycles, --decompile, --memtrace) printf from the
+ * stage threads, which leaves traced runs waiting on the terminal. Here each
+ * thread fills a buffer of its own without taking any lock, and hands it to
+ * a flusher thread when it is full. The flusher writes buffers out in the
+ * order they come and recycles them; if it falls more than TRACE_MAX_QUEUED
+ * buffers behind, writers wait for it rather than eat memory.
+ *
+ * The file format is in trace_format.h; tools/trace_decode turns a trace
+ * back into the text formats.
+ */
+
+#define TRACE_CHUNK_RECORDS	4096
+#define TRACE_MAX_QUEUED	64
+#define TRACE_MAX_OPS		1024	// Power of two, ops are only ~250
+
+EXPORT int trace_flag = 0;
+EXPORT int trace_fetch_flag = 0;
+EXPORT const char *trace_file = NULL;
+
+struct trace_buf {
+	struct trace_buf *next;
+	struct trace_chunk_header hdr;
+	struct trace_record recs[TRACE_CHUNK_RECORDS];
+};
+
+struct trace_writer {
+	struct trace_writer *next;
+	struct trace_buf *buf;
+	int64_t last_cycle;
+	uint32_t last_pc;
+	uint32_t stream;
+	uint32_t thread;
+};
+
+static FILE *trace_fp;
+static pthread_t flusher;
+
+// Everything below is under lock
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queued_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t drained_cond = PTHREAD_COND_INITIALIZER;
+static struct trace_buf *queue_head;
+static struct trace_buf *queue_tail;
+static unsigned queued;
+static struct trace_buf *free_bufs;
+static struct trace_writer *writers;
+static uint32_t streams;
+static bool closing;
+static struct trace_buf discard;	// For stragglers after closing
+
+static __thread struct trace_writer *self;
+
+// Op ids, assigned by the executing thread as ops first run
+static const struct op *op_ids[TRACE_MAX_OPS];
+static uint16_t op_id_of[TRACE_MAX_OPS];
+static uint16_t ops_named;
+
+static void *flush_thread(void *unused __attribute__ ((unused))) {
+	pthread_mutex_lock(&lock);
+	while (1) {
+		while ((queue_head == NULL) && !closing)
+			pthread_cond_wait(&queued_cond, &lock);
+		if (queue_head == NULL)
+			break;
+
+		struct trace_buf *b = queue_head;
+		queue_head = b->next;
+		if (queue_head == NULL)
+			queue_tail = NULL;
+		pthread_mutex_unlock(&lock);
+
+		size_t n = b->hdr.count;
+		if ((1 != fwrite(&b->hdr, sizeof(b->hdr), 1, trace_fp)) ||
+				(n != fwrite(b->recs, sizeof(b->recs[0]), n, trace_fp)))
+			WARN("Writing %s: %s\n", trace_file, strerror(errno));
+
+		pthread_mutex_lock(&lock);
+		b->next = free_bufs;
+		free_bufs = b;
+		queued--;
+		pthread_cond_broadcast(&drained_cond);
+	}
+	pthread_mutex_unlock(&lock);
+	return NULL;
+}
+
+// Call with lock held
+static void enqueue(struct trace_buf *b) {
+	b->next = NULL;
+	if (queue_tail)
+		queue_tail->next = b;
+	else
+		queue_head = b;
+	queue_tail = b;
+	queued++;
+	pthread_cond_signal(&queued_cond);
+}
+
+// Call with lock held
+static struct trace_buf *buf_get(void) {
+	struct trace_buf *b = free_bufs;
+	if (b) {
+		free_bufs = b->next;
+	} else {
+		b = malloc(sizeof(struct trace_buf));
+		if (b == NULL)
+			ERR(E_UNKNOWN, "Out of memory for trace buffers\n");
+	}
+	return b;
+}
+
+static void buf_start(struct trace_writer *w, struct trace_buf *b) {
+	b->hdr.stream = w->stream;
+	b->hdr.count = 0;
+	b->hdr.base_cycle = w->last_cycle;
+	b->hdr.base_pc = w->last_pc;
+	b->hdr.thread = w->thread;
+	w->buf = b;
+}
+
+static struct trace_writer *writer_new(void) {
+	struct trace_writer *w = calloc(1, sizeof(struct trace_writer));
+	char name[16] = "";
+	const char *c;
+
+	if (w == NULL)
+		ERR(E_UNKNOWN, "Out of memory for trace writer\n");
+
+	// FNV-1a
+	pthread_getname_np(pthread_self(), name, sizeof(name));
+	w->thread = 2166136261u;
+	for (c = name; *c; c++)
+		w->thread = (w->thread ^ (uint8_t) *c) * 16777619u;
+
+	pthread_mutex_lock(&lock);
+	w->stream = streams++;
+	w->next = writers;
+	writers = w;
+	buf_start(w, buf_get());
+	pthread_mutex_unlock(&lock);
+
+	self = w;
+	return w;
+}
+
+static void writer_full(struct trace_writer *w) {
+	pthread_mutex_lock(&lock);
+	if (closing) {
+		w->buf->hdr.count = 0;
+		pthread_mutex_unlock(&lock);
+		return;
+	}
+	enqueue(w->buf);
+	while ((queued > TRACE_MAX_QUEUED) && !closing)
+		pthread_cond_wait(&drained_cond, &lock);
+	buf_start(w, buf_get());
+	pthread_mutex_unlock(&lock);
+}
+
+static struct trace_record *record(struct trace_writer *w) {
+	if (w->buf->hdr.count == TRACE_CHUNK_RECORDS)
+		writer_full(w);
+	return &w->buf->recs[w->buf->hdr.count++];
+}
+
+// The next record of this thread's stream, at pc now
+static struct trace_record *emit(enum trace_type type, uint32_t pc) {
+	struct trace_writer *w = (self) ? self : writer_new();
+	struct trace_record *r;
+	int64_t dcycle = cycle - w->last_cycle;
+
+	if ((dcycle < 0) || (dcycle > UINT16_MAX)) {
+		// Backwards only after a replay seek, the decoder handles both
+		r = record(w);
+		r->type = TRACE_CYCLES;
+		r->width = 0;
+		r->dcycle = 0;
+		r->dpc = 0;
+		r->a = (uint32_t) dcycle;
+		r->b = (uint32_t) ((uint64_t) dcycle >> 32);
+		dcycle = 0;
+	}
+
+	r = record(w);
+	r->type = type;
+	r->width = 0;
+	r->dcycle = dcycle;
+	r->dpc = pc - w->last_pc;
+	w->last_cycle = cycle;
+	w->last_pc = pc;
+	return r;
+}
+
+static uint16_t op_id(const struct op *o) {
+	unsigned i = ((uintptr_t) o >> 4) & (TRACE_MAX_OPS - 1);
+
+	while (op_ids[i] != NULL) {
+		if (op_ids[i] == o)
+			return op_id_of[i];
+		i = (i + 1) & (TRACE_MAX_OPS - 1);
+	}
+	if (ops_named == TRACE_MAX_OPS - 1)
+		ERR(E_UNKNOWN, "More than %d ops to trace\n", TRACE_MAX_OPS - 1);
+	op_ids[i] = o;
+	op_id_of[i] = ops_named++;
+
+	// Spelled out in pieces, up to and including the NUL
+	size_t len = strlen(o->name) + 1;
+	size_t off;
+	for (off = 0; off < len; off += TRACE_NAME_CHARS) {
+		struct trace_writer *w = (self) ? self : writer_new();
+		struct trace_record *r = record(w);
+		char piece[TRACE_NAME_CHARS] = {0};
+
+		memcpy(piece, o->name + off, MIN(TRACE_NAME_CHARS, len - off));
+		r->type = TRACE_NAME;
+		r->width = 0;
+		r->dcycle = op_id_of[i];
+		r->dpc = 0;
+		memcpy(&r->a, piece, 4);
+		memcpy(&r->b, piece + 4, 4);
+	}
+	return op_id_of[i];
+}
+
+EXPORT void trace_exec(enum trace_type type, uint32_t pc, uint32_t inst,
+		const struct op *o) {
+	uint16_t id = (o) ? op_id(o) : 0xffff;
+	struct trace_record *r = emit(type, pc);
+	r->width = (inst & 0xffff0000) ? 4 : 2;
+	r->a = inst;
+	r->b = id;
+}
+
+EXPORT void trace_fetch(uint32_t pc, uint32_t inst) {
+	struct trace_record *r = emit(TRACE_FETCH, pc);
+	r->width = (inst & 0xffff0000) ? 4 : 2;
+	r->a = inst;
+	r->b = 0;
+}
+
+EXPORT void trace_mem(enum trace_type type, int width, uint32_t addr,
+		uint32_t val) {
+	struct trace_record *r = emit(type, (self) ? self->last_pc : 0);
+	r->width = width;
+	r->a = addr;
+	r->b = val;
+}
+
+EXPORT void trace_exception(enum trace_type type, int exception, uint32_t pc) {
+	struct trace_record *r = emit(type, pc);
+	r->a = exception;
+	r->b = 0;
+}
+
+EXPORT void trace_open(const char *file) {
+	struct trace_file_header h = {
+		.magic = TRACE_MAGIC,
+		.version = TRACE_VERSION,
+		.record_size = sizeof(struct trace_record),
+	};
+
+	trace_fp = fopen(file, "wb");
+	if (trace_fp == NULL)
+		ERR(E_UNKNOWN, "Could not open trace %s: %s\n", file,
+				strerror(errno));
+	if (1 != fwrite(&h, sizeof(h), 1, trace_fp))
+		ERR(E_UNKNOWN, "Writing %s: %s\n", file, strerror(errno));
+
+	trace_file = file;
+	if (0 != pthread_create(&flusher, NULL, flush_thread, NULL))
+		ERR(E_UNKNOWN, "Could not start trace flusher\n");
+	trace_flag = true;
+}
+
+// Writes out what every thread has buffered. Threads still running when
+// this is called (on an error, say) lose whatever they trace after it
+EXPORT void trace_close(void) {
+	struct trace_writer *w;
+	long bytes;
+
+	trace_flag = false;
+	trace_fetch_flag = false;
+
+	pthread_mutex_lock(&lock);
+	for (w = writers; w; w = w->next) {
+		if (w->buf->hdr.count)
+			enqueue(w->buf);
+		w->buf = &discard;
+	}
+	closing = true;
+	pthread_cond_broadcast(&queued_cond);
+	pthread_cond_broadcast(&drained_cond);
+	pthread_mutex_unlock(&lock);
+
+	pthread_join(flusher, NULL);
+	bytes = ftell(trace_fp);
+	if (0 != fclose(trace_fp))
+		WARN("Closing %s: %s\n", trace_file, strerror(errno));
+	trace_fp = NULL;
+	INFO("Wrote %ld bytes of trace from %u thread%s to %s\n",
+			bytes, streams, (streams == 1) ? "" : "s", trace_file);
+}
@@ -0,0 +1,61 @@
+/* Mulator - An extensible {ARM} {e,si}mulator
+ * Copyright 2011-2016  Pat Pannuto <pat.pannuto@gmail.com>
+ *
+ * This file is part of Mulator.
+ *
+ * Mulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "common.h"
+#include "trace_format.h"
+
+#ifndef PP_STRING
+#define PP_STRING "TRC"
+#include "pretty_print.h"
+#endif
+
+struct op;
+
+// Set by trace_open, the hooks below do nothing until then
+extern int trace_flag;
+extern int trace_fetch_flag;	// Also record instruction fetches
+extern const char *trace_file;
+
+void trace_open(const char *file);
+void trace_close(void);
+
+// Execute records come from one thread only (it numbers the ops)
+void trace_exec(enum trace_type type, uint32_t pc, uint32_t inst,
+		const struct op *o);
+void trace_fetch(uint32_t pc, uint32_t inst);
+void trace_mem(enum trace_type type, int width, uint32_t addr, uint32_t val);
+void trace_exception(enum trace_type type, int exception, uint32_t pc);
+
+#define TRACE_EXEC(_type, _pc, _inst, _o) do {\
+	if (trace_flag) trace_exec(_type, _pc, _inst, _o);\
+} while (0)
+#define TRACE_FETCH(_pc, _inst) do {\
+	if (trace_fetch_flag) trace_fetch(_pc, _inst);\
+} while (0)
+#define TRACE_MEM(_type, _width, _addr, _val) do {\
+	if (trace_flag) trace_mem(_type, _width, _addr, _val);\
+} while (0)
+#define TRACE_EXCEPTION(_type, _exception, _pc) do {\
+	if (trace_flag) trace_exception(_type, _exception, _pc);\
+} while (0)
+
+#endif // TRACE_H
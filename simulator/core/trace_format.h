@@ -0,0 +1,81 @@
+/* Mulator - An extensible {ARM} {e,si}mulator
+ * Copyright 2011-2016  Pat Pannuto <pat.pannuto@gmail.com>
+ *
+ * This file is part of Mulator.
+ *
+ * Mulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACE_FORMAT_H
+#define TRACE_FORMAT_H
+
+// The binary trace file, shared by the simulator (core/trace.c) and the
+// decoder (tools/trace_decode.c). Only fixed-width types, all little-endian.
+
+#include <stdint.h>
+
+/* A trace is a file header followed by chunks. Each thread that traces
+ * anything writes its own stream of chunks, and the chunks of different
+ * streams are interleaved in the order they filled up. Within a stream,
+ * every record holds the cycle and PC as deltas from the record before it,
+ * starting from the base the chunk header carries, so any chunk decodes on
+ * its own. Readers merge streams by cycle, and within a cycle by the hash of
+ * the thread name, since stream numbers depend on which thread traced first.
+ */
+
+#define TRACE_MAGIC		"MULTRACE"
+#define TRACE_VERSION		1
+
+struct trace_file_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t record_size;	// sizeof(struct trace_record)
+};
+
+struct trace_chunk_header {
+	uint32_t stream;
+	uint32_t count;		// Records that follow
+	int64_t base_cycle;
+	uint32_t base_pc;
+	uint32_t thread;	// Hash of the writing thread's name, see below
+};
+
+enum trace_type {
+	TRACE_EXEC = 1,		// a: instruction, b: op id
+	TRACE_EXEC_IT,		// Executed inside an IT block
+	TRACE_SKIP_IT,		// Skipped inside an IT block
+	TRACE_STALL,		// A pipeline bubble reached execute
+	TRACE_FETCH,		// a: instruction
+	TRACE_READ,		// a: address, b: value
+	TRACE_READ_ERR,		// a: address
+	TRACE_WRITE,		// a: address, b: value
+	TRACE_WRITE_ERR,	// a: address, b: value
+	TRACE_EXC_ENTER,	// a: exception number, pc: handler
+	TRACE_EXC_RETURN,	// a: exception number, pc: return address
+	TRACE_CYCLES,		// a, b: low, high word of a long cycle gap
+	TRACE_NAME,		// a, b: next 8 characters of the name of op id dcycle
+};
+
+struct trace_record {
+	uint8_t type;
+	uint8_t width;		// Bytes accessed or fetched, or 0
+	uint16_t dcycle;	// Cycles since the record before (not for NAME)
+	uint32_t dpc;		// PC minus the PC of the record before, mod 2^32
+	uint32_t a;
+	uint32_t b;
+};
+
+#define TRACE_NAME_CHARS	8
+
+#endif // TRACE_FORMAT_H
@@ -26,6 +26,16 @@
 #define RAMBOT 0x20000000
 #define RAMTOP 0x20008000
 
+// Wait states of each data access to a region, as {bot, top, wait states}
+#define MEMMAP_WAIT_STATES \
+	{ROMBOT, ROMTOP, 0}, \
+	{RAMBOT, RAMTOP, 0},
+
+// Regions the energy model tells apart, as {name, bot, top, read pJ, write pJ}
+#define MEMMAP_ENERGY_REGIONS \
+	{"ROM",  ROMBOT, ROMTOP, 1.5, 1.5}, \
+	{"SRAM", RAMBOT, RAMTOP, 2.0, 2.5},
+
 #define REDLED 0x40001000
 #define GRNLED 0x40001004
 #define BLULED 0x40001008
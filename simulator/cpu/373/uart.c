@@ -355,6 +355,30 @@ static void uart_write_data(
 	poll_uart_txdata_write(val);
 }
 
+#ifdef HAVE_REPLAY
+// Time travel holds the write lock while the simulator seeks, so neither the
+// uart thread nor the core can touch the buffer until it is consistent again
+static int poll_uart_tt_lock(void) {
+	pthread_rwlock_wrlock(&poll_uart_rwlock);
+	return 0;
+}
+
+static int poll_uart_tt_unlock(void) {
+	pthread_rwlock_unlock(&poll_uart_rwlock);
+	return 0;
+}
+
+static int poll_uart_tt_write(uint32_t *addr, uint32_t val) {
+	*addr = val;
+	return 0;
+}
+
+static int poll_uart_tt_write_p(uint32_t **addr, uint32_t *val) {
+	*addr = val;
+	return 0;
+}
+#endif
+
 static pthread_t start_poll_uart(void *unused __attribute__ ((unused))) {
 	// Spawn uart thread, waits until spawned to return
 	pthread_mutex_lock(&poll_uart_mutex);
@@ -383,7 +407,20 @@ void register_memmap_uart(void) {
 	register_memmap("Poll UART", true, 1, mem_fn,
 			POLL_UART_TXDATA, POLL_UART_TXDATA+1);
 
+#ifdef HAVE_REPLAY
+	struct periph_time_travel tt = {
+		.rewind_start_fn = poll_uart_tt_lock,
+		.rewind_end_fn = poll_uart_tt_unlock,
+		.rewind = poll_uart_tt_write,
+		.rewind_p = poll_uart_tt_write_p,
+		.replay_start_fn = poll_uart_tt_lock,
+		.replay_end_fn = poll_uart_tt_unlock,
+		.replay = poll_uart_tt_write,
+		.replay_p = poll_uart_tt_write_p,
+	};
+#else
 	struct periph_time_travel tt = PERIPH_TIME_TRAVEL_NONE;
+#endif
 	register_periph_thread(start_poll_uart, THREAD_NAME,
 			tt, &poll_uart_enabled, 0, NULL);
 }
@@ -27,9 +27,14 @@
 #include "cpu/core.h"
 
 #include "core/state_sync.h"
+#include "core/id_stage.h"
+#include "core/memdump.h"
+#include "core/dirty.h"
 
 #define ADDR_TO_IDX(_addr, _bot) ((_addr - _bot) >> 2)
 static uint32_t ram[RAMSIZE >> 2] = {0};
+static struct dirty_map ram_dirty = {
+	.name = "RAM", .bot = RAMBOT, .size = RAMSIZE};
 
 #ifndef FAVOR_SPEED
 // Detect attempts to overwrite flashed code (most likely an error)
@@ -43,11 +48,20 @@ EXPORT void flash_RAM(const uint8_t *image, int offset, uint32_t nbytes) {
 	code_bot = offset;
 	code_top = offset+nbytes;
 #endif
+	decode_cache_flush();
 	INFO("Flashed %d bytes to RAM\n", nbytes);
 }
 
-EXPORT size_t dump_RAM(FILE *fp) {
-	return fwrite(ram, RAMSIZE, 1, fp);
+EXPORT ssize_t dump_RAM(const char *file) {
+	return memdump_write(file, ram, RAMSIZE);
+}
+
+EXPORT void print_RAM(FILE *fp) {
+	memdump_hex(fp, ram, RAMSIZE);
+}
+
+EXPORT int compare_RAM(const char *file) {
+	return memdump_compare("RAM", ram, RAMSIZE, RAMBOT, file);
 }
 
 static bool ram_read(uint32_t addr, uint32_t *val,
@@ -81,6 +95,8 @@ static void ram_write(uint32_t addr, uint32_t val,
 #endif
 	if ((addr >= RAMBOT) && (addr < RAMTOP) && (0 == (addr & 0x3))) {
 		SW(&ram[ADDR_TO_IDX(addr, RAMBOT)],val);
+		decode_cache_invalidate(addr);
+		dirty_mark(&ram_dirty, addr);
 	} else {
 		CORE_ERR_invalid_addr(true, addr);
 	}
@@ -95,11 +111,17 @@ void register_memmap_ram(void) {
 #else
 	union memmap_fn mem_fn;
 
+	dirty_register(&ram_dirty);
 	mem_fn.R_fn32 = ram_read;
-	register_memmap("RAM", false, 4, mem_fn, RAMBOT, RAMTOP);
+	register_memmap_host("RAM", false, mem_fn, ram, RAMBOT, RAMTOP);
 	mem_fn.W_fn32 = ram_write;
+#ifdef FAVOR_SPEED
+	register_memmap_host("RAM", true, mem_fn, ram, RAMBOT, RAMTOP);
+#else
+	// Writes go through ram_write to catch stores into flashed code
 	register_memmap("RAM", true, 4, mem_fn, RAMBOT, RAMTOP);
 #endif
+#endif
 }
 
 #endif // HAVE_RAM
@@ -30,7 +30,9 @@
 #define RAMSIZE (RAMTOP - RAMBOT) // In bytes
 
 void flash_RAM(const uint8_t *image, int offset, uint32_t nbytes);
-size_t dump_RAM(FILE *fp);
+ssize_t dump_RAM(const char *file);
+void print_RAM(FILE *fp);
+int compare_RAM(const char *file);
 
 #endif //RAMBOT
 // Only include this peripheral if requested in the platform memmap.h //
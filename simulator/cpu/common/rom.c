@@ -27,9 +27,14 @@
 #include "cpu/core.h"
 
 #include "core/state_sync.h"
+#include "core/id_stage.h"
+#include "core/memdump.h"
+#include "core/dirty.h"
 
 #define ADDR_TO_IDX(_addr, _bot) ((_addr - _bot) >> 2)
 static uint32_t rom[ROMSIZE >> 2] = {0};
+static struct dirty_map rom_dirty = {
+	.name = "ROM", .bot = ROMBOT, .size = ROMSIZE};
 
 #ifndef FAVOR_SPEED
 // Detect attempts to overwrite flashed code (most likely an error)
@@ -47,12 +52,17 @@ EXPORT void flash_ROM(const uint8_t *image, int offset, uint32_t nbytes) {
 	code_bot = offset;
 	code_top = offset+nbytes;
 #endif
+	decode_cache_flush();
 	INFO("Flashed %d bytes to ROM\n", nbytes);
 }
 
 #ifdef PRINT_ROM_ENABLE
-EXPORT size_t dump_ROM(FILE *fp) {
-	return fwrite(rom, ROMSIZE, 1, fp);
+EXPORT ssize_t dump_ROM(const char *file) {
+	return memdump_write(file, rom, ROMSIZE);
+}
+
+EXPORT void print_ROM(FILE *fp) {
+	memdump_hex(fp, rom, ROMSIZE);
 }
 #endif
 
@@ -107,6 +117,8 @@ static void rom_write(uint32_t addr, uint32_t val, bool debugger) {
 #endif
 	if ((addr >= ROMBOT) && (addr < ROMTOP) && (0 == (addr & 0x3))) {
 		SW(&rom[ADDR_TO_IDX(addr, ROMBOT)],val);
+		decode_cache_invalidate(addr);
+		dirty_mark(&rom_dirty, addr);
 	} else {
 		CORE_ERR_invalid_addr(true, addr);
 	}
@@ -121,8 +133,14 @@ void register_memmap_rom(void) {
 #else
 	union memmap_fn mem_fn;
 
+	dirty_register(&rom_dirty);
 	mem_fn.R_fn32 = rom_read;
+#ifdef BOOTLOADER_BOT
+	// Reads go through rom_read to guard the bootloader region
 	register_memmap("ROM", false, 4, mem_fn, ROMBOT, ROMTOP);
+#else
+	register_memmap_host("ROM", false, mem_fn, rom, ROMBOT, ROMTOP);
+#endif
 	mem_fn.W_fn32 = rom_write;
 	register_memmap("ROM", true, 4, mem_fn, ROMBOT, ROMTOP);
 #endif
@@ -36,7 +36,8 @@
 
 void flash_ROM(const uint8_t *image, int offset, uint32_t nbytes);
 #ifdef PRINT_ROM_ENABLE
-size_t dump_ROM(FILE *fp);
+ssize_t dump_ROM(const char *file);
+void print_ROM(FILE *fp);
 #endif
 
 #endif // ROMBOT
@@ -23,6 +23,9 @@
 
 #include "common/private_peripheral_bus/ppb.h"
 
+#include "core/id_stage.h"
+#include "core/dirty.h"
+
 //#define TRAP_ALIGNMENT (read_word(CONFIGURATION_CONTROL) & CONFIGURATION_CONTROL_UNALIGN_TRP_MASK)
 #define TRAP_ALIGNMENT false
 
@@ -73,7 +76,6 @@ EXPORT void reset(void) {
 
 ////////////////////
 
-// XXX: Build efficient structure with masks
 struct memmap {
 	struct memmap *next;
 	struct memmap *prev;
@@ -82,11 +84,113 @@ struct memmap {
 	uint32_t bot;
 	uint32_t top;
 	char alignment;
+	uint32_t *host;
 };
 
 struct memmap *reads = NULL;
 struct memmap *writes = NULL;
 
+/* Registrations are kept in sorted lists for overlap checking and printing,
+ * lookups go through a two-level page table over the address space instead.
+ * Each 4 KB page points at the first registration (of either alignment) that
+ * intersects it. Registrations never overlap, so a lookup only walks from
+ * there while cur->bot <= addr, which is a single node for any page that one
+ * region covers entirely.
+ */
+#define MEMMAP_L1_SHIFT 20
+#define MEMMAP_L2_SHIFT 12
+#define MEMMAP_L2_ENTRIES (1 << (MEMMAP_L1_SHIFT - MEMMAP_L2_SHIFT))
+#define MEMMAP_L2_MASK (MEMMAP_L2_ENTRIES - 1)
+
+static struct memmap **read_pages[1 << (32 - MEMMAP_L1_SHIFT)];
+static struct memmap **write_pages[1 << (32 - MEMMAP_L1_SHIFT)];
+
+static void memmap_pages_insert(struct memmap ***pages, struct memmap *newmap) {
+	uint32_t first = newmap->bot >> MEMMAP_L2_SHIFT;
+	uint32_t last = (newmap->top - 1) >> MEMMAP_L2_SHIFT;
+
+	for (uint64_t page = first; page <= last; page++) {
+		struct memmap ***l1 = &pages[page >> (MEMMAP_L1_SHIFT - MEMMAP_L2_SHIFT)];
+		if (*l1 == NULL) {
+			*l1 = calloc(MEMMAP_L2_ENTRIES, sizeof(struct memmap *));
+			assert(*l1 && "calloc memmap page table");
+		}
+
+		struct memmap **entry = &(*l1)[page & MEMMAP_L2_MASK];
+		if ((*entry == NULL) || (newmap->bot < (*entry)->bot))
+			*entry = newmap;
+	}
+}
+
+static inline struct memmap *memmap_find(struct memmap ***pages, uint32_t addr) {
+	struct memmap **l2 = pages[addr >> MEMMAP_L1_SHIFT];
+	if (l2 == NULL)
+		return NULL;
+
+	struct memmap *cur = l2[(addr >> MEMMAP_L2_SHIFT) & MEMMAP_L2_MASK];
+	while ((cur != NULL) && (cur->bot <= addr)) {
+		if (addr < cur->top)
+			return cur;
+		cur = cur->next;
+	}
+	return NULL;
+}
+
+/* Plain memory (RAM, ROM) can register the host array backing it. Accesses
+ * to it then skip the page table walk and the handler: a small per-thread
+ * TLB maps each page to a host pointer, or to NULL if the page has to go
+ * through its handler (MMIO, partially covered pages, guarded regions).
+ * Memory tracing always takes the handler path, and so do stores while
+ * dirty pages are tracked.
+ */
+#define MEMMAP_TLB_ENTRIES 64
+
+struct memmap_tlb_entry {
+	uint32_t tag;	// page + 1, so that 0 (the initial value) never matches
+	uint32_t *host;
+};
+
+static thread_local struct memmap_tlb_entry read_tlb[MEMMAP_TLB_ENTRIES];
+static thread_local struct memmap_tlb_entry write_tlb[MEMMAP_TLB_ENTRIES];
+
+static void memmap_tlb_fill(struct memmap_tlb_entry *e,
+		struct memmap ***pages, uint32_t addr) {
+	uint32_t page_bot = addr & ~((1U << MEMMAP_L2_SHIFT) - 1);
+	uint64_t page_top = (uint64_t) page_bot + (1U << MEMMAP_L2_SHIFT);
+	struct memmap *cur = memmap_find(pages, addr);
+
+	e->tag = (addr >> MEMMAP_L2_SHIFT) + 1;
+	if ((pages == write_pages) && dirty_tracking)
+		e->host = NULL;		// Stores are marked by the handler
+	else if ((cur != NULL) && (cur->host != NULL) &&
+			(cur->bot <= page_bot) && (page_top <= cur->top))
+		e->host = cur->host + ((page_bot - cur->bot) >> 2);
+	else
+		e->host = NULL;
+}
+
+static inline uint32_t *memmap_host_ptr(struct memmap_tlb_entry *tlb,
+		struct memmap ***pages, uint32_t addr) {
+#ifdef HAVE_MEMTRACE
+	if (memtrace_flag || trace_flag)
+		return NULL;
+#endif
+	struct memmap_tlb_entry *e =
+		&tlb[(addr >> MEMMAP_L2_SHIFT) & (MEMMAP_TLB_ENTRIES - 1)];
+	if (unlikely(e->tag != (addr >> MEMMAP_L2_SHIFT) + 1))
+		memmap_tlb_fill(e, pages, addr);
+	if (e->host == NULL)
+		return NULL;
+	return e->host + ((addr & ((1U << MEMMAP_L2_SHIFT) - 1)) >> 2);
+}
+
+// Replaces the bits of *host selected by mask, as a single latched write
+static inline void host_write_masked(uint32_t *host, uint32_t addr,
+		uint32_t val, uint32_t mask) {
+	SW(host, (SR(host) & ~mask) | (val & mask));
+	decode_cache_invalidate(addr & 0xfffffffc);
+}
+
 static void bad_memmap_reg(struct memmap *newmap, struct memmap *cur) {
 	WARN("Inserting %s at %x--%x, but cur is %s at %x--%x\n",
 			newmap->name, newmap->bot, newmap->top,
@@ -114,11 +218,12 @@ static void insert_memmap_behind(struct memmap **head, struct memmap *newmap,
 	cur->prev = newmap;
 }
 
-EXPORT void register_memmap(
+static void _register_memmap(
 		const char *name,
 		bool write,
 		short alignment,
 		union memmap_fn mem_fn,
+		uint32_t *host,
 		uint32_t bot,
 		uint32_t top
 	) {
@@ -126,7 +231,7 @@ EXPORT void register_memmap(
 
 	struct memmap *newmap = malloc(sizeof(struct memmap));
 	*newmap = (struct memmap){
-		NULL, NULL, strdup(name), mem_fn, bot, top, alignment};
+		NULL, NULL, strdup(name), mem_fn, bot, top, alignment, host};
 	assert(newmap->name);
 
 	struct memmap **head;
@@ -140,14 +245,14 @@ EXPORT void register_memmap(
 
 	if (cur == NULL) {
 		*head = newmap;
-		return;
+		goto insert_pages;
 	}
 
 	while (cur->next != NULL) {
 		// Insert behind cur
 		if (bot < cur->bot) {
 			insert_memmap_behind(head, newmap, cur);
-			return;
+			goto insert_pages;
 		}
 
 		// Overlap check: ensure new range completely exceeds old
@@ -165,6 +270,32 @@ EXPORT void register_memmap(
 		cur->next = newmap;
 		newmap->prev = cur;
 	}
+
+insert_pages:
+	memmap_pages_insert((write) ? write_pages : read_pages, newmap);
+}
+
+EXPORT void register_memmap(
+		const char *name,
+		bool write,
+		short alignment,
+		union memmap_fn mem_fn,
+		uint32_t bot,
+		uint32_t top
+	) {
+	_register_memmap(name, write, alignment, mem_fn, NULL, bot, top);
+}
+
+EXPORT void register_memmap_host(
+		const char *name,
+		bool write,
+		union memmap_fn mem_fn,
+		uint32_t *host,
+		uint32_t bot,
+		uint32_t top
+	) {
+	assert(((bot & 0x3) == 0) && "Host backed memory must be word aligned");
+	_register_memmap(name, write, 4, mem_fn, host, bot, top);
 }
 
 static void print_memmap_line(
@@ -314,14 +445,18 @@ EXPORT void print_memmap(void) {
 }
 
 static bool try_read_word(uint32_t addr, uint32_t *val, bool debugger) {
-	struct memmap *cur = reads;
-	while (cur != NULL) {
-		if (cur->alignment == 4)
-			if ((cur->bot <= addr) && (addr < cur->top))
-				return cur->mem_fn.R_fn32(addr, val, debugger);
-		cur = cur->next;
+	if (likely((addr & 0x3) == 0)) {
+		uint32_t *host = memmap_host_ptr(read_tlb, read_pages, addr);
+		if (host) {
+			*val = SR(host);
+			return true;
+		}
 	}
 
+	struct memmap *cur = memmap_find(read_pages, addr);
+	if ((cur != NULL) && (cur->alignment == 4))
+		return cur->mem_fn.R_fn32(addr, val, debugger);
+
 	if (CONF_rzwi_memory) {
 		WARN("RZWI RD 0x%08x as 0\n", addr);
 		return true;
@@ -362,15 +497,19 @@ EXPORT uint32_t read_word(uint32_t addr) {
 static void try_write_word(uint32_t addr, uint32_t val, bool debugger) {
 	DBG2("addr %08x val %08x\n", addr, val);
 
-	struct memmap *cur = writes;
-	while (cur != NULL) {
-		if (cur->alignment == 4) {
-			if ((cur->bot <= addr) && (addr < cur->top)) {
-				MEMTRACE_WRITE(4, addr, val);
-				return cur->mem_fn.W_fn32(addr, val, debugger);
-			}
+	if (likely((addr & 0x3) == 0)) {
+		uint32_t *host = memmap_host_ptr(write_tlb, write_pages, addr);
+		if (host) {
+			SW(host, val);
+			decode_cache_invalidate(addr);
+			return;
 		}
-		cur = cur->next;
+	}
+
+	struct memmap *cur = memmap_find(write_pages, addr);
+	if ((cur != NULL) && (cur->alignment == 4)) {
+		MEMTRACE_WRITE(4, addr, val);
+		return cur->mem_fn.W_fn32(addr, val, debugger);
 	}
 
 	if (CONF_rzwi_memory) {
@@ -415,11 +554,82 @@ EXPORT void write_word_unaligned(uint32_t addr, uint32_t val) {
 		}
 		core_stats_unaligned_cycle_penalty += 3*2;
 
-		write_byte(addr, val & 0xff);
-		write_byte(addr + 1, (val >> 8) & 0xff);
-		write_byte(addr + 2, (val >> 16) & 0xff);
-		write_byte(addr + 3, (val >> 24) & 0xff);
+		// Plain memory: splice val into the two words it straddles
+		uint32_t lo_addr = addr & 0xfffffffc;
+		unsigned shift = (addr & 0x3) * 8;
+		uint32_t *lo = memmap_host_ptr(write_tlb, write_pages, lo_addr);
+		uint32_t *hi = memmap_host_ptr(write_tlb, write_pages, lo_addr + 4);
+		if (lo && hi) {
+			host_write_masked(lo, lo_addr, val << shift, UINT32_MAX << shift);
+			host_write_masked(hi, lo_addr + 4, val >> (32 - shift),
+					UINT32_MAX >> (32 - shift));
+			return;
+		}
+
+		// Byte registers take the four byte writes the core would issue
+		struct memmap *cur = memmap_find(write_pages, addr);
+		if ((cur != NULL) && (cur->alignment == 1)) {
+			write_byte(addr, val & 0xff);
+			write_byte(addr + 1, (val >> 8) & 0xff);
+			write_byte(addr + 2, (val >> 16) & 0xff);
+			write_byte(addr + 3, (val >> 24) & 0xff);
+			return;
+		}
+
+		// Anything else: one read-modify-write of each word, byte writes
+		// would read back the word from before the previous one latched
+		uint32_t word = read_word(lo_addr);
+		word &= ~(UINT32_MAX << shift);
+		word |= val << shift;
+		try_write_word(lo_addr, word, false);
+
+		word = read_word(lo_addr + 4);
+		word &= ~(UINT32_MAX >> (32 - shift));
+		word |= val >> (32 - shift);
+		try_write_word(lo_addr + 4, word, false);
+	}
+}
+
+// Host pointer for count words at addr if one plain memory region holds them all
+static uint32_t *memmap_host_range(struct memmap ***pages,
+		uint32_t addr, int count) {
+#ifdef HAVE_MEMTRACE
+	if (memtrace_flag || trace_flag)
+		return NULL;
+#endif
+	if ((addr & 0x3) || ((pages == write_pages) && dirty_tracking))
+		return NULL;
+	struct memmap *cur = memmap_find(pages, addr);
+	if ((cur == NULL) || (cur->host == NULL))
+		return NULL;
+	if (((uint64_t) addr + 4 * (uint64_t) count) > cur->top)
+		return NULL;
+	return cur->host + ((addr - cur->bot) >> 2);
+}
+
+EXPORT void read_words(uint32_t addr, uint32_t *vals, int count) {
+	uint32_t *host = memmap_host_range(read_pages, addr, count);
+	if (host) {
+		for (int i = 0; i < count; i++)
+			vals[i] = SR(&host[i]);
+		return;
 	}
+
+	for (int i = 0; i < count; i++)
+		vals[i] = read_word(addr + 4*i);
+}
+
+EXPORT void write_words(uint32_t addr, const uint32_t *vals, int count) {
+	uint32_t *host = memmap_host_range(write_pages, addr, count);
+	if (host) {
+		SWB(host, vals, count);
+		for (int i = 0; i < count; i++)
+			decode_cache_invalidate(addr + 4*i);
+		return;
+	}
+
+	for (int i = 0; i < count; i++)
+		try_write_word(addr + 4*i, vals[i], false);
 }
 
 EXPORT uint16_t read_halfword(uint32_t addr) {
@@ -429,6 +639,18 @@ EXPORT uint16_t read_halfword(uint32_t addr) {
 		assert(false && "Alignment exception");
 	}
 
+	uint32_t *host = memmap_host_ptr(read_tlb, read_pages, addr & 0xfffffffc);
+	if (host) {
+		unsigned shift = (addr & 0x3) * 8;
+		if (likely(shift != 24))
+			return SR(host) >> shift;
+
+		uint32_t *next = memmap_host_ptr(read_tlb, read_pages,
+				(addr & 0xfffffffc) + 4);
+		if (next)
+			return (SR(host) >> 24) | ((SR(next) & 0xff) << 8);
+	}
+
 	uint32_t word = read_word(addr & 0xfffffffc);
 
 	uint16_t ret;
@@ -454,19 +676,41 @@ EXPORT uint16_t read_halfword(uint32_t addr) {
 	return ret;
 }
 
+// Instruction fetch for translation. Only plain memory is read, so the fetch
+// has no side effects and never faults; false means the caller must fetch
+// through read_halfword when the instruction actually executes
+EXPORT bool try_fetch_halfword(uint32_t addr, uint16_t *val) {
+	if (addr & 0x1)
+		return false;
+	uint32_t *host = memmap_host_ptr(read_tlb, read_pages, addr & 0xfffffffc);
+	if (host == NULL)
+		return false;
+	*val = SR(host) >> ((addr & 0x2) * 8);
+	return true;
+}
+
 EXPORT void write_halfword(uint32_t addr, uint16_t val) {
 	DBG2("addr %08x val %04x\n", addr, val);
 
-	// XXX: This doesn't look right, esp w.r.t. alignment stuff
-
 	if ((addr & 0x1) & TRAP_ALIGNMENT) {
 		// misaligned access
 		assert(false && "Alignment exception");
 	}
 
-	uint32_t word = read_word(addr & 0xfffffffc);
 	uint32_t val32 = val;
 
+	if ((addr & 0x3) != 0x3) {
+		uint32_t *host = memmap_host_ptr(write_tlb, write_pages,
+				addr & 0xfffffffc);
+		if (host) {
+			unsigned shift = (addr & 0x3) * 8;
+			host_write_masked(host, addr, val32 << shift, 0xffffU << shift);
+			return;
+		}
+	}
+
+	uint32_t word = read_word(addr & 0xfffffffc);
+
 	switch (addr & 0x3) {
 		case 0x0:
 			word &= 0xffff0000;
@@ -474,7 +718,7 @@ EXPORT void write_halfword(uint32_t addr, uint16_t val) {
 			break;
 		case 0x1:
 			word &= 0xff0000ff;
-			word |= val32;
+			word |= (val32 << 8);
 			break;
 		case 0x2:
 			word &= 0x0000ffff;
@@ -508,20 +752,37 @@ EXPORT void write_halfword_unaligned(uint32_t addr, uint16_t val) {
 		}
 		core_stats_unaligned_cycle_penalty += 1*2;
 
+		// Two byte writes to the same word would lose the first, as the
+		// second reads back the word from before the first was latched
+		if ((addr & 0x3) == 0x1)
+			return write_halfword(addr, val);
+
+		// Plain memory: splice val into the two words it straddles
+		uint32_t lo_addr = addr & 0xfffffffc;
+		uint32_t *lo = memmap_host_ptr(write_tlb, write_pages, lo_addr);
+		uint32_t *hi = memmap_host_ptr(write_tlb, write_pages, lo_addr + 4);
+		if (lo && hi) {
+			host_write_masked(lo, lo_addr, (uint32_t) val << 24, 0xff000000);
+			host_write_masked(hi, lo_addr + 4, val >> 8, 0x000000ff);
+			return;
+		}
+
 		write_byte(addr, val & 0xff);
 		write_byte(addr + 1, (val >> 8) & 0xff);
 	}
 }
 
 static bool try_read_byte(uint32_t addr, uint8_t* val, bool debugger) {
-	struct memmap *cur = reads;
-	while (cur != NULL) {
-		if (cur->alignment == 1)
-			if ((cur->bot <= addr) && (addr < cur->top))
-				return cur->mem_fn.R_fn8(addr, val, debugger);
-		cur = cur->next;
+	uint32_t *host = memmap_host_ptr(read_tlb, read_pages, addr & 0xfffffffc);
+	if (host) {
+		*val = SR(host) >> ((addr & 0x3) * 8);
+		return true;
 	}
 
+	struct memmap *cur = memmap_find(read_pages, addr);
+	if ((cur != NULL) && (cur->alignment == 1))
+		return cur->mem_fn.R_fn8(addr, val, debugger);
+
 	uint32_t word;
 	if (!try_read_word(addr & 0xfffffffc, &word, debugger))
 		return false;
@@ -561,14 +822,17 @@ EXPORT uint8_t read_byte(uint32_t addr) {
 }
 
 static void try_write_byte(uint32_t addr, uint8_t val, bool debugger) {
-	struct memmap *cur = writes;
-	while (cur != NULL) {
-		if (cur->alignment == 1)
-			if ((cur->bot <= addr) && (addr < cur->top))
-				return cur->mem_fn.W_fn8(addr, val, debugger);
-		cur = cur->next;
+	uint32_t *host = memmap_host_ptr(write_tlb, write_pages, addr & 0xfffffffc);
+	if (host) {
+		unsigned shift = (addr & 0x3) * 8;
+		host_write_masked(host, addr, (uint32_t) val << shift, 0xffU << shift);
+		return;
 	}
 
+	struct memmap *cur = memmap_find(write_pages, addr);
+	if ((cur != NULL) && (cur->alignment == 1))
+		return cur->mem_fn.W_fn8(addr, val, debugger);
+
 	uint32_t word = read_word(addr & 0xfffffffc);
 	uint32_t val32 = val;
 
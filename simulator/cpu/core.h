@@ -44,6 +44,16 @@ void register_memmap(
 		uint32_t bot,
 		uint32_t top
 	);
+// Plain memory backed by the word array host. Aligned accesses by the core
+// read and write host directly; mem_fn still serves everything else
+void register_memmap_host(
+		const char *name,
+		bool write,
+		union memmap_fn mem_fn,
+		uint32_t *host,
+		uint32_t bot,
+		uint32_t top
+	);
 
 extern _Atomic _Bool	_CORE_in_reset;
 void		reset(void);
@@ -53,7 +63,12 @@ uint32_t	read_word(uint32_t addr);
 void		write_word(uint32_t addr, uint32_t val);
 void		write_word_aligned(uint32_t addr, uint32_t val);
 void		write_word_unaligned(uint32_t addr, uint32_t val);
+// Consecutive words; plain memory is resolved once and latched as one write
+void		read_words(uint32_t addr, uint32_t *vals, int count);
+void		write_words(uint32_t addr, const uint32_t *vals, int count);
 uint16_t	read_halfword(uint32_t addr);
+bool		try_fetch_halfword(uint32_t addr, uint16_t *val)
+			__attribute__ ((nonnull));
 void		write_halfword(uint32_t addr, uint16_t val);
 void		write_halfword_unaligned(uint32_t addr, uint16_t val);
 uint8_t		read_byte(uint32_t addr);
@@ -64,26 +79,31 @@ bool		gdb_read_byte(uint32_t addr, uint8_t *val)
 void		gdb_write_byte(uint32_t addr, uint8_t val);
 
 #ifdef HAVE_MEMTRACE
+#include "core/trace.h"
 extern int memtrace_flag;
 #define MEMTRACE_READ(_width, _addr, _val) do {\
 	if (memtrace_flag) {\
 		printf("MEMTR:  READ 0x%08x -> 0x%08x, %d\n", _addr, _val, _val);\
 	}\
+	TRACE_MEM(TRACE_READ, _width, _addr, _val);\
 } while (0);
 #define MEMTRACE_READ_ERR(_width, _addr) do {\
 	if (memtrace_flag) {\
 		printf("MEMTR:  READ 0x%08x -> !! ERROR !!\n", _addr);\
 	}\
+	TRACE_MEM(TRACE_READ_ERR, _width, _addr, 0);\
 } while (0);
 #define MEMTRACE_WRITE(_width, _addr, _val) do {\
 	if (memtrace_flag) {\
 		printf("MEMTR: WRITE 0x%08x <- 0x%08x, %d\n", _addr, _val, _val);\
 	}\
+	TRACE_MEM(TRACE_WRITE, _width, _addr, _val);\
 } while (0);
 #define MEMTRACE_WRITE_ERR(_width, _addr, _val) do {\
 	if (memtrace_flag) {\
 		printf("MEMTR: WRITE 0x%08x <- !! ERROR !!\n", _addr);\
 	}\
+	TRACE_MEM(TRACE_WRITE_ERR, _width, _addr, _val);\
 } while (0);
 #else
 #define MEMTRACE_READ(...)
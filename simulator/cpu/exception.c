@@ -21,12 +21,11 @@
 #include "core.h"
 
 #include "features.h"
-// "private" export from registers:
-extern uint32_t sp_process;
-extern uint32_t sp_main;
 #include "registers.h"
 
 #include "core/state_sync.h"
+#include "core/callstack.h"
+#include "core/trace.h"
 
 #include "common/private_peripheral_bus/ppb.h"
 //#define CCR_STKALIGN (read_word(CONFIGURATION_CONTROL) & CONFIGURATION_CONTROL_STKALIGN_MASK)
@@ -95,22 +94,24 @@ static void PushStack(enum ExceptionType type, bool precise,
 	uint32_t *sp;
 
 	if (spsel && (CORE_CurrentMode_read() == Mode_Thread)) {
-		sp = &sp_process;
+		sp = &physical_reg[REG_SP_PROCESS];
 	} else {
-		sp = &sp_main;
+		sp = &physical_reg[REG_SP_MAIN];
 	}
 	frameptralign = (!!(SR(sp) & 0x4)) & forcealign;
 	uint32_t frameptr = (SR(sp) - framesize) & spmask;
 	SW(sp, frameptr);
 
-	write_word(frameptr+0x00, CORE_reg_read(0));
-	write_word(frameptr+0x04, CORE_reg_read(1));
-	write_word(frameptr+0x08, CORE_reg_read(2));
-	write_word(frameptr+0x0c, CORE_reg_read(3));
-	write_word(frameptr+0x10, CORE_reg_read(12));
-	write_word(frameptr+0x14, CORE_reg_read(LR_REG));
-	write_word(frameptr+0x18, ReturnAddress(type, precise, fault_inst, next_inst));
-	write_word(frameptr+0x1c, CORE_xPSR_read() | (frameptralign << 9));
+	uint32_t frame[8];
+	frame[0] = CORE_reg_read(0);
+	frame[1] = CORE_reg_read(1);
+	frame[2] = CORE_reg_read(2);
+	frame[3] = CORE_reg_read(3);
+	frame[4] = CORE_reg_read(12);
+	frame[5] = CORE_reg_read(LR_REG);
+	frame[6] = ReturnAddress(type, precise, fault_inst, next_inst);
+	frame[7] = CORE_xPSR_read() | (frameptralign << 9);
+	write_words(frameptr, frame, 8);
 
 	if (0 /* FP */) {
 	} else {
@@ -131,6 +132,8 @@ static void ExceptionTaken(enum ExceptionType type) {
 	tmp = read_word(vectortable+4*type);
 	DBG1("Exception setting PC to %08x\n", tmp & 0xfffffffe);
 	CORE_reg_write(PC_REG, tmp & 0xfffffffe);
+	CALLSTACK_EXCEPTION_ENTER(type, tmp & 0xfffffffe);
+	TRACE_EXCEPTION(TRACE_EXC_ENTER, type, tmp & 0xfffffffe);
 	tbit = tmp & 0x1;
 	CORE_update_mode_and_SPSEL(Mode_Handler, 0);
 
@@ -180,15 +183,18 @@ static uint32_t PopStack(uint32_t frameptr, uint32_t exc_return) {
 		forcealign = CCR_STKALIGN;
 	}
 
-	CORE_reg_write(0,      read_word(frameptr+0x00));
-	CORE_reg_write(1,      read_word(frameptr+0x04));
-	CORE_reg_write(2,      read_word(frameptr+0x08));
-	CORE_reg_write(3,      read_word(frameptr+0x0c));
-	CORE_reg_write(12,     read_word(frameptr+0x10));
-	CORE_reg_write(LR_REG, read_word(frameptr+0x14));
-	new_pc =               read_word(frameptr+0x18);
+	uint32_t frame[8];
+	read_words(frameptr, frame, 8);
+
+	CORE_reg_write(0,      frame[0]);
+	CORE_reg_write(1,      frame[1]);
+	CORE_reg_write(2,      frame[2]);
+	CORE_reg_write(3,      frame[3]);
+	CORE_reg_write(12,     frame[4]);
+	CORE_reg_write(LR_REG, frame[5]);
+	new_pc =               frame[6];
 	CORE_reg_write(PC_REG, new_pc);
-	uint32_t xPSR =        read_word(frameptr+0x1c);
+	uint32_t xPSR =        frame[7];
 	CORE_xPSR_write(xPSR);
 
 #ifdef HAVE_FP
@@ -201,13 +207,13 @@ static uint32_t PopStack(uint32_t frameptr, uint32_t exc_return) {
 	uint32_t *sp;
 	switch (exc_return & 0xf) {
 		case 0x1:	// returning to Handler
-			sp = &sp_main;
+			sp = &physical_reg[REG_SP_MAIN];
 			break;
 		case 0x9:	// returning to Thread using Main stack
-			sp = &sp_main;
+			sp = &physical_reg[REG_SP_MAIN];
 			break;
 		case 0xd:	// returning to Thread using Process stack
-			sp = &sp_process;
+			sp = &physical_reg[REG_SP_PROCESS];
 			break;
 		default:
 			CORE_ERR_unpredictable("Bad exception return\n");
@@ -255,7 +261,7 @@ void ExceptionReturn(uint32_t exc_return) {
 	} else {
 		switch (exc_return & 0xf) {
 			case 0x1:	// return to Handler
-				frameptr = SR(&sp_main);
+				frameptr = SR(&physical_reg[REG_SP_MAIN]);
 				CORE_update_mode_and_SPSEL(Mode_Handler, 0);
 				break;
 			case 0x9:	// return to Thread using Main stack
@@ -266,7 +272,7 @@ void ExceptionReturn(uint32_t exc_return) {
 					ExceptionTaken(UsageFault); // return to Thread exception mismatch
 					return;
 				} else {
-					frameptr = SR(&sp_main);
+					frameptr = SR(&physical_reg[REG_SP_MAIN]);
 					CORE_update_mode_and_SPSEL(Mode_Thread, 0);
 				}
 				break;
@@ -278,7 +284,7 @@ void ExceptionReturn(uint32_t exc_return) {
 					ExceptionTaken(UsageFault); // return to Thread exception mismatch
 					return;
 				} else {
-					frameptr = SR(&sp_process);
+					frameptr = SR(&physical_reg[REG_SP_PROCESS]);
 					CORE_update_mode_and_SPSEL(Mode_Thread, 1);
 				}
 				break;
@@ -293,6 +299,7 @@ void ExceptionReturn(uint32_t exc_return) {
 		uint32_t new_pc;
 		DeActivate(ReturningExceptionNumber);
 		new_pc = PopStack(frameptr, exc_return);
+		ipsr = CORE_ipsr_read();
 
 		if ((CORE_CurrentMode_read() == Mode_Handler) && (ipsr.bits.exception == 0)) {
 			set_ufsr_invpc(1);
@@ -310,6 +317,9 @@ void ExceptionReturn(uint32_t exc_return) {
 			return;
 		}
 
+		CALLSTACK_EXCEPTION_EXIT();
+		TRACE_EXCEPTION(TRACE_EXC_RETURN, ReturningExceptionNumber, new_pc);
+
 		WARN("Exception return skipped some steps. Not executed:\n");
 		WARN("   ClearExclusievLocal()\n");
 		WARN("   SetEventRegister()\n");
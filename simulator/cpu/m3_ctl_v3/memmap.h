@@ -23,6 +23,14 @@
 #define RAMBOT		0x00000000
 #define RAMTOP		0x00000C00
 
+// Wait states of each data access to a region, as {bot, top, wait states}
+#define MEMMAP_WAIT_STATES \
+	{RAMBOT, RAMTOP, 0},
+
+// Regions the energy model tells apart, as {name, bot, top, read pJ, write pJ}
+#define MEMMAP_ENERGY_REGIONS \
+	{"SRAM", RAMBOT, RAMTOP, 2.0, 2.5},
+
 #define I2C_BOT_WR	0xA0000000
 #define I2C_TOP_WR	0xA0001000
 
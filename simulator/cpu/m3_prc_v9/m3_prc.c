@@ -123,7 +123,7 @@ static void mbus_mmio_wr(uint32_t addr, uint32_t val,
 			SW(&mbus_mmio_data, val);
 			INFO("MBus message: addr %08x, data %08x\n",
 					SR(&mbus_mmio_addr),
-					SR(&mbus_mmio_data)
+					val
 			    );
 			break;
 		default:
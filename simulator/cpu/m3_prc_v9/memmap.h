@@ -23,6 +23,16 @@
 #define RAMBOT		0x00000000
 #define RAMTOP		0x00030000
 
+// Wait states of each data access to a region, as {bot, top, wait states}
+#define MEMMAP_WAIT_STATES \
+	{RAMBOT, RAMTOP, 0},
+
+// Regions the energy model tells apart, as {name, bot, top, read pJ, write pJ}.
+// LIM (the recryptor's compute rows) sits inside SRAM; the first match wins
+#define MEMMAP_ENERGY_REGIONS \
+	{"LIM",  0x00002000, 0x0000A000, 2.5, 3.0}, \
+	{"SRAM", RAMBOT, RAMTOP, 2.0, 2.5},
+
 #define MBUS_MMIO_ADDR	0xA0000000
 #define MBUS_MMIO_DATA	0xA0000004
 
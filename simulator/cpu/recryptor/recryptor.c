@@ -6,11 +6,21 @@
 #include "cpu/m3_prc_v9/memmap.h"
 
 #include "core/simulator.h"
+#include "core/energy.h"
 
 const uint8_t NUM_SUBBANK[] = {8,2,4,2};
 const uint8_t NUM_PREVTOT_SUBBANK[] = {0,8,10,14};
 const char    *OpNames[] = {"AND","OR","XOR","COPY","NOT","SF1","SF4","LS64","RS64","ROTL64","XROTX","KEY","SS","MC","InvalidOp"};
 
+// Words an operation computes, every subbank of each bank it is issued to
+static inline int recryptor_words(int bank) {
+	int b, words = 0;
+	for (b = 0; b < 4; b++)
+		if (bank & (1 << b))
+			words += NUM_SUBBANK[b];
+	return words;
+}
+
 const int LIM_ADDR_OFFSET = 0x2000; // change to 0 for 1_singleEcc_LIM  
 
 int  recryptor_FSM_fin_addr = 0x10000;
@@ -146,6 +156,7 @@ void recryptor_decoder_wr(uint32_t addr, uint32_t val, bool addr_add ) {
 	}
 
 	recryptor_cnt++;
+	ENERGY_RECRYPTOR(op, recryptor_words(bank));
 	// Debug
 	if(REC_DEBUG) printf("Recryptor Count: %d\n",recryptor_cnt);
 	
@@ -156,6 +167,7 @@ void recryptor_mem_rd(uint32_t addr, uint32_t Rshift,
 
 	//Location is different than recryptor_decoder_wr
 	recryptor_mem_rd_data = read_word(addr);
+	ENERGY_READ(addr, 1);
 	recryptor_u = (recryptor_mem_rd_data >> Rshift) & 0xF;
 
     	if(REC_DEBUG) printf("Recyrptor Mem Rd (%#x)! addr = %#x, val = %#x, recryptor_u = %#x\n", Rshift, addr, recryptor_mem_rd_data, recryptor_u);
@@ -166,6 +178,7 @@ void recryptor_mem_wr(uint32_t addr, uint32_t val,
 
 	if(REC_DEBUG) printf("Cycle:%" PRId64 ", Write_word, addr:%#x, val:%#x\n", cycle, addr, val);
 	write_word(addr,val);
+	ENERGY_WRITE(addr, 1);
 
 }
 
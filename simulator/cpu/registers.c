@@ -30,15 +30,13 @@
 #include "cpu/common/private_peripheral_bus/ppb.h"
 
 enum Mode CurrentMode;
-EXPORT uint32_t physical_reg[SP_REG];	// SP,LR,PC not held here, so 13 registers
-       uint32_t sp_process; // "private" export
-       uint32_t sp_main; // "private" export
-EXPORT uint32_t *physical_sp_p = &sp_main;
-EXPORT uint32_t physical_lr;
+EXPORT uint32_t physical_reg[16] __attribute__ ((aligned (64)));
+EXPORT uint32_t *physical_sp_p = &physical_reg[REG_SP_MAIN];
 
 #ifdef M_PROFILE
 
 EXPORT union apsr_t physical_apsr;
+EXPORT struct apsr_flags physical_apsr_flags;
 EXPORT union ipsr_t physical_ipsr;
 EXPORT union epsr_t physical_epsr;
 
@@ -75,54 +73,32 @@ EXPORT union control_t physical_control;
 
 ////////////////////////////////////////////////////////////////////////////////
 
-EXPORT uint32_t CORE_reg_read(int r)
-{
-	extern uint32_t physical_reg[SP_REG];
-	extern uint32_t *physical_sp_p;
-	extern uint32_t physical_lr;
+EXPORT uint32_t CORE_pc_read(void) {
 	extern uint32_t id_ex_PC;
-
-	assert(r >= 0 && r < 16 && "CORE_reg_read");
-	if (r == SP_REG) {
-		return SR(physical_sp_p) & 0xfffffffc;
-	} else if (r == LR_REG) {
-		return SR(&physical_lr);
-	} else if (r == PC_REG) {
-		return SR(&id_ex_PC) & 0xfffffffe;
-	} else {
-		return SR(&physical_reg[r]);
-	}
+	return SR(&id_ex_PC) & 0xfffffffe;
 }
 
-EXPORT void CORE_reg_write(int r, uint32_t val) {
-	assert(r >= 0 && r < 16 && "CORE_reg_write");
-	if (r == SP_REG) {
-		SW(physical_sp_p, val & 0xfffffffc);
-	} else if (r == LR_REG) {
-		SW(&physical_lr, val);
-	} else if (r == PC_REG) {
-		DBG2("Writing %08x to PC\n", val & 0xfffffffe);
-#ifdef NO_PIPELINE
-		pipeline_flush_exception_handler(val & 0xfffffffe);
+EXPORT void CORE_pc_write(uint32_t val) {
+	DBG2("Writing %08x to PC\n", val & 0xfffffffe);
+#ifdef DIRECT_STATE
+	state_write_pc(val & 0xfffffffe);
+#elif defined(NO_PIPELINE)
+	pipeline_flush_exception_handler(val & 0xfffffffe);
 #else
-		if (state_is_debugging()) {
-			DBG1("PC write + debugging --> flush\n");
-			state_pipeline_flush(val & 0xfffffffe);
+	if (state_is_debugging()) {
+		DBG1("PC write + debugging --> flush\n");
+		state_pipeline_flush(val & 0xfffffffe);
+	} else {
+		// Only flush if the new PC differs from predicted in pipeline:
+		if (((SR(&if_id_PC) & 0xfffffffe) - 4) == (val & 0xfffffffe)) {
+			DBG2("Predicted PC correctly (%08x)\n", val);
 		} else {
-			// Only flush if the new PC differs from predicted in pipeline:
-			if (((SR(&if_id_PC) & 0xfffffffe) - 4) == (val & 0xfffffffe)) {
-				DBG2("Predicted PC correctly (%08x)\n", val);
-			} else {
-				state_pipeline_flush(val & 0xfffffffe);
-				DBG2("Predicted PC incorrectly\n");
-				DBG2("Pred: %08x, val: %08x\n", SR(&if_id_PC), val);
-			}
+			state_pipeline_flush(val & 0xfffffffe);
+			DBG2("Predicted PC incorrectly\n");
+			DBG2("Pred: %08x, val: %08x\n", SR(&if_id_PC), val);
 		}
-#endif
-	}
-	else {
-		SW(&(physical_reg[r]), val);
 	}
+#endif
 }
 
 #ifdef M_PROFILE
@@ -178,13 +154,63 @@ EXPORT void CORE_CurrentMode_write(enum Mode mode) {
 	return SW(&CurrentMode, mode);
 }
 
+/* Flag-setting instructions do not compute NZCV. They record what the
+ * flags depend on in physical_apsr_flags and the flags are derived only
+ * when something reads the APSR. While op is APSR_FLAGS_STORED, NZCV is
+ * held in physical_apsr as usual; otherwise physical_apsr's NZCV bits are
+ * stale and only its Q and GE bits are live.
+ */
+static uint32_t apsr_flags_nzcv(void) {
+	uint32_t op = SR(&physical_apsr_flags.op);
+	if (op == APSR_FLAGS_STORED)
+		return SR(&physical_apsr.storage) & 0xf0000000;
+
+	uint32_t result = SR(&physical_apsr_flags.result);
+	uint32_t a = SR(&physical_apsr_flags.a);
+	uint32_t b = SR(&physical_apsr_flags.b);
+	uint32_t c, v;
+
+	if (op == APSR_FLAGS_ADD) {
+		// result = a + b + carry_in, carry_in is already folded in
+		c = ((a & b) | ((a | b) & ~result)) >> 31;
+		v = ((a ^ result) & (b ^ result)) >> 31;
+	} else {
+		c = a;
+		v = b;
+	}
+
+	return (result & 0x80000000) | ((result == 0) << 30) |
+		(c << 29) | (v << 28);
+}
+
+static void apsr_flags_write(uint32_t op, uint32_t result,
+		uint32_t a, uint32_t b) {
+#ifdef DEBUG1
+	if (in_ITblock()) {
+		DBG1("WARN update of apsr in IT block\n");
+	}
+#endif
+	_Static_assert(sizeof(struct apsr_flags) == 4 * sizeof(uint32_t),
+			"apsr_flags must be written as a block of words");
+	const uint32_t f[4] = {op, result, a, b};
+	SWB(&physical_apsr_flags.op, f, 4);
+}
+
 EXPORT union apsr_t CORE_apsr_read(void) {
 	extern union apsr_t physical_apsr;
 	union apsr_t a;
 	a.storage = SR(&physical_apsr.storage);
+	if (SR(&physical_apsr_flags.op) != APSR_FLAGS_STORED) {
+		a.storage &= ~0xf0000000;
+		a.storage |= apsr_flags_nzcv();
+	}
 	return a;
 }
 
+EXPORT bool CORE_apsr_C_read(void) {
+	return (apsr_flags_nzcv() >> 29) & 0x1;
+}
+
 EXPORT void CORE_apsr_write(union apsr_t val) {
 	extern union apsr_t physical_apsr;
 	uint8_t in_ITblock(void);
@@ -198,6 +224,22 @@ EXPORT void CORE_apsr_write(union apsr_t val) {
 	}
 #endif
 	SW(&physical_apsr.storage, val.storage);
+	SW(&physical_apsr_flags.op, APSR_FLAGS_STORED);
+}
+
+EXPORT void CORE_apsr_flags_add(uint32_t a, uint32_t b, uint32_t result) {
+	apsr_flags_write(APSR_FLAGS_ADD, result, a, b);
+}
+
+EXPORT void CORE_apsr_flags_nzc(uint32_t result, bool carry) {
+	uint32_t v = (apsr_flags_nzcv() >> 28) & 0x1;
+	apsr_flags_write(APSR_FLAGS_LOGICAL, result, carry, v);
+}
+
+EXPORT void CORE_apsr_flags_nz(uint32_t result) {
+	uint32_t nzcv = apsr_flags_nzcv();
+	apsr_flags_write(APSR_FLAGS_LOGICAL, result,
+			(nzcv >> 29) & 0x1, (nzcv >> 28) & 0x1);
 }
 
 EXPORT union ipsr_t CORE_ipsr_read(void) {
@@ -258,7 +300,9 @@ static void control_SPSEL_write(bool spsel, bool force, enum Mode forced_mode) {
 
 	// XXX: I'm confused on exactly the semantics here, esp w.r.t. exceptions
 	//if (mode == Mode_Thread) {
-		SWP(&physical_sp_p, (spsel) ? &sp_process : &sp_main);
+		SWP(&physical_sp_p, (spsel) ?
+				&physical_reg[REG_SP_PROCESS] :
+				&physical_reg[REG_SP_MAIN]);
 	//} else {
 	//	CORE_ERR_unpredictable("SPSEL write in Handler mode\n");
 	//}
@@ -328,10 +372,11 @@ static void reset_registers(void) {
 
 	// R[0..12] = bits(32) UNKNOWN {nop}
 
-	SW(&sp_main,read_word(vectortable) & 0xfffffffc);
+	SW(&physical_reg[REG_SP_MAIN], read_word(vectortable) & 0xfffffffc);
 
 	// sp_process = ((bits(30) UNKNOWN):'00')
-	SW(&sp_process, SR(&sp_process) & ~0x3);
+	SW(&physical_reg[REG_SP_PROCESS],
+			SR(&physical_reg[REG_SP_PROCESS]) & ~0x3);
 
 	CORE_reg_write(LR_REG, 0xFFFFFFFF);
 
@@ -80,13 +80,44 @@ union apsr_t {
 
 #ifdef M_PROFILE
 
+/* The register file. R0-R12 and LR are held at their own index. The PC lives
+ * in the pipeline latches, so the SP and PC slots instead bank SP_main and
+ * SP_process, keeping the whole file in one cache line. physical_sp_p points
+ * at the active stack pointer and only moves on a mode or SPSEL change.
+ */
+#define REG_SP_MAIN	SP_REG
+#define REG_SP_PROCESS	PC_REG
+extern uint32_t physical_reg[16];
+extern uint32_t *physical_sp_p;
+
+// The PC keeps its pipeline semantics: reads return the executing
+// instruction's address and writes redirect or flush the pipeline
+uint32_t	CORE_pc_read(void);
+void		CORE_pc_write(uint32_t val);
+
 /* ARMv7-M implementations treat SP bits [1:0] as RAZ/WI.
  * ARM strongly recommends that software treats SP bits [1:0]
  * as SBZP for maximum portability across ARMv7 profiles.
+ *
+ * Inlined so that a register number known to be below SP_REG, e.g. one
+ * masked with 0x7, folds both checks away and leaves a single load or store.
  */
-uint32_t    CORE_reg_read(int r);
-
-void		CORE_reg_write(int r, uint32_t val);
+export_inline uint32_t CORE_reg_read(int r) {
+	if (r == SP_REG)
+		return SR(physical_sp_p) & 0xfffffffc;
+	if (r == PC_REG)
+		return CORE_pc_read();
+	return SR(&physical_reg[r]);
+}
+
+export_inline void CORE_reg_write(int r, uint32_t val) {
+	if (r == SP_REG)
+		SW(physical_sp_p, val & 0xfffffffc);
+	else if (r == PC_REG)
+		CORE_pc_write(val);
+	else
+		SW(&physical_reg[r], val);
+}
 
 uint32_t	CORE_xPSR_read(void);
 void		CORE_xPSR_write(uint32_t);
@@ -122,6 +153,29 @@ union apsr_t CORE_apsr_read(void);
 
 void CORE_apsr_write(union apsr_t val);
 
+// Lazily evaluated NZCV, see CORE_apsr_read
+enum apsr_flags_op {
+	APSR_FLAGS_STORED,	// NZCV held in physical_apsr
+	APSR_FLAGS_ADD,		// result = a + b + carry_in
+	APSR_FLAGS_LOGICAL,	// C = a, V = b
+};
+
+struct apsr_flags {
+	uint32_t op;
+	uint32_t result;
+	uint32_t a;
+	uint32_t b;
+};
+
+bool CORE_apsr_C_read(void);
+
+// N,Z,C,V of result = a + b + carry_in
+void CORE_apsr_flags_add(uint32_t a, uint32_t b, uint32_t result);
+// N,Z of result, C = carry, V unchanged
+void CORE_apsr_flags_nzc(uint32_t result, bool carry);
+// N,Z of result, C and V unchanged
+void CORE_apsr_flags_nz(uint32_t result);
+
 
 //union __attribute__ ((__packed__)) ipsr_t {
 union ipsr_t {
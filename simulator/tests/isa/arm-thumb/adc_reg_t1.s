@@ -67,11 +67,11 @@ test_maxP1:
 
 	ADCS.N R2, R5
 
-	// Expect N=0,Z=1,C=1,V=1
+	// Expect N=0,Z=1,C=1,V=0
 	BMI adcs_reg_t2_fail_maxP1_flags	// N==0
 	BNE adcs_reg_t2_fail_maxP1_flags	// Z==1
 	BCC adcs_reg_t2_fail_maxP1_flags	// C==1
-	BVC adcs_reg_t2_fail_maxP1_flags	// V==1
+	BVS adcs_reg_t2_fail_maxP1_flags	// V==0
 
 	// Expect R2==0
 	CMP R2, 0
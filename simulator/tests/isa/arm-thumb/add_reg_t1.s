@@ -0,0 +1,103 @@
+.syntax unified
+
+.thumb_func
+.global main
+main:
+	MOVS R0, 0
+	MOVS R1, 1
+	MVNS R2, R0	// R2 = 0xffff ffff
+	MOVS R6, 1
+	LSLS R6, R6, 31	// R6 = 0x8000 0000
+	MVNS R7, R6	// R7 = 0x7fff ffff
+
+test_1P1:
+	ADDS.N R3, R1, R1
+
+	// Expect N=0,Z=0,C=0,V=0
+	BMI adds_reg_t1_fail_1P1_flags	// N==0
+	BEQ adds_reg_t1_fail_1P1_flags	// Z==0
+	BCS adds_reg_t1_fail_1P1_flags	// C==0
+	BVS adds_reg_t1_fail_1P1_flags	// V==0
+
+	// Expect R3==2
+	CMP R3, 2
+	BNE adds_reg_t1_fail_1P1_val
+
+
+test_smaxP1:
+	ADDS.N R3, R7, R1
+
+	// Expect N=1,Z=0,C=0,V=1
+	BPL adds_reg_t1_fail_smaxP1_flags	// N==1
+	BEQ adds_reg_t1_fail_smaxP1_flags	// Z==0
+	BCS adds_reg_t1_fail_smaxP1_flags	// C==0
+	BVC adds_reg_t1_fail_smaxP1_flags	// V==1
+
+	// Expect R3==0x8000 0000
+	CMP R3, R6
+	BNE adds_reg_t1_fail_smaxP1_val
+
+
+test_maxP1:
+	ADDS.N R3, R2, R1
+
+	// Expect N=0,Z=1,C=1,V=0
+	BMI adds_reg_t1_fail_maxP1_flags	// N==0
+	BNE adds_reg_t1_fail_maxP1_flags	// Z==1
+	BCC adds_reg_t1_fail_maxP1_flags	// C==1
+	BVS adds_reg_t1_fail_maxP1_flags	// V==0
+
+	// Expect R3==0
+	CMP R3, 0
+	BNE adds_reg_t1_fail_maxP1_val
+
+
+test_sminPsmin:
+	ADDS.N R3, R6, R6
+
+	// Expect N=0,Z=1,C=1,V=1
+	BMI adds_reg_t1_fail_sminPsmin_flags	// N==0
+	BNE adds_reg_t1_fail_sminPsmin_flags	// Z==1
+	BCC adds_reg_t1_fail_sminPsmin_flags	// C==1
+	BVC adds_reg_t1_fail_sminPsmin_flags	// V==1
+
+	// Expect R3==0
+	CMP R3, 0
+	BNE adds_reg_t1_fail_sminPsmin_val
+
+success:
+	// All passed
+	MOVS R0, 0
+	BX LR
+
+adds_reg_t1_fail_1P1_flags:
+	MOVS R0, 1
+	BX LR
+
+adds_reg_t1_fail_1P1_val:
+	MOVS R0, 2
+	BX LR
+
+adds_reg_t1_fail_smaxP1_flags:
+	MOVS R0, 3
+	BX LR
+
+adds_reg_t1_fail_smaxP1_val:
+	MOVS R0, 4
+	BX LR
+
+adds_reg_t1_fail_maxP1_flags:
+	MOVS R0, 5
+	BX LR
+
+adds_reg_t1_fail_maxP1_val:
+	MOVS R0, 6
+	BX LR
+
+adds_reg_t1_fail_sminPsmin_flags:
+	MOVS R0, 7
+	BX LR
+
+adds_reg_t1_fail_sminPsmin_val:
+	MOVS R0, 8
+	BX LR
@@ -0,0 +1,101 @@
+.syntax unified
+
+.thumb_func
+.global main
+main:
+	MOVS R0, 0
+	MOVS R1, 1
+	MVNS R2, R0	// R2 = 0xffff ffff
+	MOVS R6, 1
+	LSLS R6, R6, 31	// R6 = 0x8000 0000
+	MVNS R7, R6	// R7 = 0x7fff ffff
+
+test_3R1:
+	MOVS R4, 3
+	ASRS.N R3, R4, 1
+
+	// Expect N=0,Z=0,C=1
+	BMI asrs_imm_t1_fail_3R1_flags	// N==0
+	BEQ asrs_imm_t1_fail_3R1_flags	// Z==0
+	BCC asrs_imm_t1_fail_3R1_flags	// C==1
+
+	// Expect R3==1
+	CMP R3, 1
+	BNE asrs_imm_t1_fail_3R1_val
+
+
+test_sminR31:
+	ASRS.N R3, R6, 31
+
+	// Expect N=1,Z=0,C=0
+	BPL asrs_imm_t1_fail_sminR31_flags	// N==1
+	BEQ asrs_imm_t1_fail_sminR31_flags	// Z==0
+	BCS asrs_imm_t1_fail_sminR31_flags	// C==0
+
+	// Expect R3==0xffff ffff
+	CMP R3, R2
+	BNE asrs_imm_t1_fail_sminR31_val
+
+
+test_sminR32:
+	// imm5 == 0 encodes a shift of 32
+	ASRS.N R3, R6, 32
+
+	// Expect N=1,Z=0,C=1
+	BPL asrs_imm_t1_fail_sminR32_flags	// N==1
+	BEQ asrs_imm_t1_fail_sminR32_flags	// Z==0
+	BCC asrs_imm_t1_fail_sminR32_flags	// C==1
+
+	// Expect R3==0xffff ffff
+	CMP R3, R2
+	BNE asrs_imm_t1_fail_sminR32_val
+
+
+test_smaxR32:
+	ASRS.N R3, R7, 32
+
+	// Expect N=0,Z=1,C=0
+	BMI asrs_imm_t1_fail_smaxR32_flags	// N==0
+	BNE asrs_imm_t1_fail_smaxR32_flags	// Z==1
+	BCS asrs_imm_t1_fail_smaxR32_flags	// C==0
+
+	// Expect R3==0
+	CMP R3, 0
+	BNE asrs_imm_t1_fail_smaxR32_val
+
+success:
+	// All passed
+	MOVS R0, 0
+	BX LR
+
+asrs_imm_t1_fail_3R1_flags:
+	MOVS R0, 1
+	BX LR
+
+asrs_imm_t1_fail_3R1_val:
+	MOVS R0, 2
+	BX LR
+
+asrs_imm_t1_fail_sminR31_flags:
+	MOVS R0, 3
+	BX LR
+
+asrs_imm_t1_fail_sminR31_val:
+	MOVS R0, 4
+	BX LR
+
+asrs_imm_t1_fail_sminR32_flags:
+	MOVS R0, 5
+	BX LR
+
+asrs_imm_t1_fail_sminR32_val:
+	MOVS R0, 6
+	BX LR
+
+asrs_imm_t1_fail_smaxR32_flags:
+	MOVS R0, 7
+	BX LR
+
+asrs_imm_t1_fail_smaxR32_val:
+	MOVS R0, 8
+	BX LR
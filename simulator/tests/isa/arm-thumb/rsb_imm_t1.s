@@ -0,0 +1,102 @@
+.syntax unified
+
+.thumb_func
+.global main
+main:
+	MOVS R0, 0
+	MOVS R1, 1
+	MVNS R2, R0	// R2 = 0xffff ffff
+	MOVS R6, 1
+	LSLS R6, R6, 31	// R6 = 0x8000 0000
+
+test_N0:
+	RSBS.N R3, R0, 0
+
+	// Expect N=0,Z=1,C=1,V=0
+	BMI rsbs_imm_t1_fail_N0_flags	// N==0
+	BNE rsbs_imm_t1_fail_N0_flags	// Z==1
+	BCC rsbs_imm_t1_fail_N0_flags	// C==1
+	BVS rsbs_imm_t1_fail_N0_flags	// V==0
+
+	// Expect R3==0
+	CMP R3, 0
+	BNE rsbs_imm_t1_fail_N0_val
+
+
+test_N1:
+	RSBS.N R3, R1, 0
+
+	// Expect N=1,Z=0,C=0,V=0
+	BPL rsbs_imm_t1_fail_N1_flags	// N==1
+	BEQ rsbs_imm_t1_fail_N1_flags	// Z==0
+	BCS rsbs_imm_t1_fail_N1_flags	// C==0
+	BVS rsbs_imm_t1_fail_N1_flags	// V==0
+
+	// Expect R3==0xffff ffff
+	CMP R3, R2
+	BNE rsbs_imm_t1_fail_N1_val
+
+
+test_Nmax:
+	RSBS.N R3, R2, 0
+
+	// Expect N=0,Z=0,C=0,V=0
+	BMI rsbs_imm_t1_fail_Nmax_flags	// N==0
+	BEQ rsbs_imm_t1_fail_Nmax_flags	// Z==0
+	BCS rsbs_imm_t1_fail_Nmax_flags	// C==0
+	BVS rsbs_imm_t1_fail_Nmax_flags	// V==0
+
+	// Expect R3==1
+	CMP R3, 1
+	BNE rsbs_imm_t1_fail_Nmax_val
+
+
+test_Nmin:
+	RSBS.N R3, R6, 0
+
+	// Expect N=1,Z=0,C=0,V=1
+	BPL rsbs_imm_t1_fail_Nmin_flags	// N==1
+	BEQ rsbs_imm_t1_fail_Nmin_flags	// Z==0
+	BCS rsbs_imm_t1_fail_Nmin_flags	// C==0
+	BVC rsbs_imm_t1_fail_Nmin_flags	// V==1
+
+	// Expect R3==0x8000 0000
+	CMP R3, R6
+	BNE rsbs_imm_t1_fail_Nmin_val
+
+success:
+	// All passed
+	MOVS R0, 0
+	BX LR
+
+rsbs_imm_t1_fail_N0_flags:
+	MOVS R0, 1
+	BX LR
+
+rsbs_imm_t1_fail_N0_val:
+	MOVS R0, 2
+	BX LR
+
+rsbs_imm_t1_fail_N1_flags:
+	MOVS R0, 3
+	BX LR
+
+rsbs_imm_t1_fail_N1_val:
+	MOVS R0, 4
+	BX LR
+
+rsbs_imm_t1_fail_Nmax_flags:
+	MOVS R0, 5
+	BX LR
+
+rsbs_imm_t1_fail_Nmax_val:
+	MOVS R0, 6
+	BX LR
+
+rsbs_imm_t1_fail_Nmin_flags:
+	MOVS R0, 7
+	BX LR
+
+rsbs_imm_t1_fail_Nmin_val:
+	MOVS R0, 8
+	BX LR
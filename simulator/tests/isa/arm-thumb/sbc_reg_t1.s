@@ -0,0 +1,122 @@
+.syntax unified
+
+.thumb_func
+.global main
+main:
+	MOVS R0, 0
+	MOVS R1, 1
+	MVNS R2, R0	// R2 = 0xffff ffff
+	MOVS R6, 1
+	LSLS R6, R6, 31	// R6 = 0x8000 0000
+	MVNS R7, R6	// R7 = 0x7fff ffff
+
+test_5M3:
+	// Set Carry (no borrow)
+	CMP R0, R0
+
+	MOVS R3, 5
+	MOVS R4, 3
+	SBCS.N R3, R4
+
+	// Expect N=0,Z=0,C=1,V=0
+	BMI sbcs_reg_t1_fail_5M3_flags	// N==0
+	BEQ sbcs_reg_t1_fail_5M3_flags	// Z==0
+	BCC sbcs_reg_t1_fail_5M3_flags	// C==1
+	BVS sbcs_reg_t1_fail_5M3_flags	// V==0
+
+	// Expect R3==2
+	CMP R3, 2
+	BNE sbcs_reg_t1_fail_5M3_val
+
+
+test_3M3B:
+	// Clear Carry (borrow)
+	CMP R0, R2
+
+	MOVS R3, 3
+	MOVS R4, 3
+	SBCS.N R3, R4
+
+	// Expect N=1,Z=0,C=0,V=0
+	BPL sbcs_reg_t1_fail_3M3B_flags	// N==1
+	BEQ sbcs_reg_t1_fail_3M3B_flags	// Z==0
+	BCS sbcs_reg_t1_fail_3M3B_flags	// C==0
+	BVS sbcs_reg_t1_fail_3M3B_flags	// V==0
+
+	// Expect R3==0xffff ffff
+	CMP R3, R2
+	BNE sbcs_reg_t1_fail_3M3B_val
+
+
+test_0M0:
+	// Set Carry (no borrow)
+	CMP R0, R0
+
+	MOVS R3, 0
+	MOVS R4, 0
+	SBCS.N R3, R4
+
+	// Expect N=0,Z=1,C=1,V=0
+	BMI sbcs_reg_t1_fail_0M0_flags	// N==0
+	BNE sbcs_reg_t1_fail_0M0_flags	// Z==1
+	BCC sbcs_reg_t1_fail_0M0_flags	// C==1
+	BVS sbcs_reg_t1_fail_0M0_flags	// V==0
+
+	// Expect R3==0
+	CMP R3, 0
+	BNE sbcs_reg_t1_fail_0M0_val
+
+
+test_minM1:
+	// Set Carry (no borrow)
+	CMP R0, R0
+
+	MOVS R3, R6
+	SBCS.N R3, R1
+
+	// Expect N=0,Z=0,C=1,V=1
+	BMI sbcs_reg_t1_fail_minM1_flags	// N==0
+	BEQ sbcs_reg_t1_fail_minM1_flags	// Z==0
+	BCC sbcs_reg_t1_fail_minM1_flags	// C==1
+	BVC sbcs_reg_t1_fail_minM1_flags	// V==1
+
+	// Expect R3==0x7fff ffff
+	CMP R3, R7
+	BNE sbcs_reg_t1_fail_minM1_val
+
+success:
+	// All passed
+	MOVS R0, 0
+	BX LR
+
+sbcs_reg_t1_fail_5M3_flags:
+	MOVS R0, 1
+	BX LR
+
+sbcs_reg_t1_fail_5M3_val:
+	MOVS R0, 2
+	BX LR
+
+sbcs_reg_t1_fail_3M3B_flags:
+	MOVS R0, 3
+	BX LR
+
+sbcs_reg_t1_fail_3M3B_val:
+	MOVS R0, 4
+	BX LR
+
+sbcs_reg_t1_fail_0M0_flags:
+	MOVS R0, 5
+	BX LR
+
+sbcs_reg_t1_fail_0M0_val:
+	MOVS R0, 6
+	BX LR
+
+sbcs_reg_t1_fail_minM1_flags:
+	MOVS R0, 7
+	BX LR
+
+sbcs_reg_t1_fail_minM1_val:
+	MOVS R0, 8
+	BX LR
@@ -65,11 +65,11 @@ test_maxP1:
 
 	ADCS R3, R2, 1
 
-	// Expect N=0,Z=1,C=1,V=1
+	// Expect N=0,Z=1,C=1,V=0
 	BMI adcs_imm_t1_fail_maxP1_flags	// N==0
 	BNE adcs_imm_t1_fail_maxP1_flags	// Z==1
 	BCC adcs_imm_t1_fail_maxP1_flags	// C==1
-	BVC adcs_imm_t1_fail_maxP1_flags	// V==1
+	BVS adcs_imm_t1_fail_maxP1_flags	// V==0
 
 	// Expect R3==0
 	CMP R3, 0
@@ -0,0 +1,108 @@
+.syntax unified
+
+.thumb_func
+.global main
+main:
+	MOVW R4, 0x0000
+	MOVT R4, 0x2000	// R4 = RAM
+	MOVW R6, 0x3344
+	MOVT R6, 0x1122	// R6 = 0x1122 3344
+	MOVW R5, 0x4433
+	MOVT R5, 0x6655	// R5 = 0x6655 4433
+
+test_offset1:
+	STR R6, [R4]
+	STR R6, [R4, 4]
+	MOVS R1, 1
+
+	// Unaligned, straddling two words
+	STR.N R5, [R4, R1]
+
+	// Expect word 0 == 0x5544 3344
+	LDR R2, [R4]
+	MOVW R3, 0x3344
+	MOVT R3, 0x5544
+	CMP R2, R3
+	BNE str_reg_t1_fail_offset1_lo
+
+	// Expect word 1 == 0x1122 3366
+	LDR R2, [R4, 4]
+	MOVW R3, 0x3366
+	MOVT R3, 0x1122
+	CMP R2, R3
+	BNE str_reg_t1_fail_offset1_hi
+
+
+test_offset2:
+	STR R6, [R4]
+	STR R6, [R4, 4]
+	MOVS R1, 2
+
+	// Unaligned, straddling two words
+	STR.N R5, [R4, R1]
+
+	// Expect word 0 == 0x4433 3344
+	LDR R2, [R4]
+	MOVW R3, 0x3344
+	MOVT R3, 0x4433
+	CMP R2, R3
+	BNE str_reg_t1_fail_offset2_lo
+
+	// Expect word 1 == 0x1122 6655
+	LDR R2, [R4, 4]
+	MOVW R3, 0x6655
+	MOVT R3, 0x1122
+	CMP R2, R3
+	BNE str_reg_t1_fail_offset2_hi
+
+
+test_offset3:
+	STR R6, [R4]
+	STR R6, [R4, 4]
+	MOVS R1, 3
+
+	// Unaligned, straddling two words
+	STR.N R5, [R4, R1]
+
+	// Expect word 0 == 0x3322 3344
+	LDR R2, [R4]
+	MOVW R3, 0x3344
+	MOVT R3, 0x3322
+	CMP R2, R3
+	BNE str_reg_t1_fail_offset3_lo
+
+	// Expect word 1 == 0x1166 5544
+	LDR R2, [R4, 4]
+	MOVW R3, 0x5544
+	MOVT R3, 0x1166
+	CMP R2, R3
+	BNE str_reg_t1_fail_offset3_hi
+
+success:
+	// All passed
+	MOVS R0, 0
+	BX LR
+
+str_reg_t1_fail_offset1_lo:
+	MOVS R0, 1
+	BX LR
+
+str_reg_t1_fail_offset1_hi:
+	MOVS R0, 2
+	BX LR
+
+str_reg_t1_fail_offset2_lo:
+	MOVS R0, 3
+	BX LR
+
+str_reg_t1_fail_offset2_hi:
+	MOVS R0, 4
+	BX LR
+
+str_reg_t1_fail_offset3_lo:
+	MOVS R0, 5
+	BX LR
+
+str_reg_t1_fail_offset3_hi:
+	MOVS R0, 6
+	BX LR
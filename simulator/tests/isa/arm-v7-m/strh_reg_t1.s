@@ -0,0 +1,74 @@
+.syntax unified
+
+.thumb_func
+.global main
+main:
+	MOVW R4, 0x0000
+	MOVT R4, 0x2000	// R4 = RAM
+	MOVW R6, 0x3344
+	MOVT R6, 0x1122	// R6 = 0x1122 3344
+	MOVW R0, 0xabcd
+
+test_offset1:
+	STR R6, [R4]
+	STR R6, [R4, 4]
+	MOVS R1, 1
+
+	// Unaligned, within one word
+	STRH.N R0, [R4, R1]
+
+	// Expect word 0 == 0x11ab cd44
+	LDR R2, [R4]
+	MOVW R3, 0xcd44
+	MOVT R3, 0x11ab
+	CMP R2, R3
+	BNE strh_reg_t1_fail_offset1_lo
+
+	// Expect word 1 untouched
+	LDR R2, [R4, 4]
+	CMP R2, R6
+	BNE strh_reg_t1_fail_offset1_hi
+
+
+test_offset3:
+	STR R6, [R4]
+	STR R6, [R4, 4]
+	MOVS R1, 3
+
+	// Unaligned, straddling two words
+	STRH.N R0, [R4, R1]
+
+	// Expect word 0 == 0xcd22 3344
+	LDR R2, [R4]
+	MOVW R3, 0x3344
+	MOVT R3, 0xcd22
+	CMP R2, R3
+	BNE strh_reg_t1_fail_offset3_lo
+
+	// Expect word 1 == 0x1122 33ab
+	LDR R2, [R4, 4]
+	MOVW R3, 0x33ab
+	MOVT R3, 0x1122
+	CMP R2, R3
+	BNE strh_reg_t1_fail_offset3_hi
+
+success:
+	// All passed
+	MOVS R0, 0
+	BX LR
+
+strh_reg_t1_fail_offset1_lo:
+	MOVS R0, 1
+	BX LR
+
+strh_reg_t1_fail_offset1_hi:
+	MOVS R0, 2
+	BX LR
+
+strh_reg_t1_fail_offset3_lo:
+	MOVS R0, 3
+	BX LR
+
+strh_reg_t1_fail_offset3_hi:
+	MOVS R0, 4
+	BX LR
@@ -0,0 +1,611 @@
+/* Mulator - An extensible {ARM} {e,si}mulator
+ * Copyright 2011-2016  Pat Pannuto <pat.pannuto@gmail.com>
+ *
+ * This file is part of Mulator.
+ *
+ * Mulator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mulator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Mulator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Decodes the binary traces the simulator writes with --trace
+
+#include "core/trace_format.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MAX_OPS			0x10000
+
+// What to print, by record kind
+#define SHOW_EXEC		0x1
+#define SHOW_MEM		0x2
+#define SHOW_EXC		0x4
+#define SHOW_FETCH		0x8
+
+struct event {
+	enum trace_type type;
+	int width;
+	int64_t cycle;
+	uint32_t pc;		// For memory accesses, of the stream's last record
+	uint32_t a;
+	uint32_t b;
+};
+
+struct chunk {
+	const struct trace_chunk_header *hdr;
+	const struct trace_record *recs;
+};
+
+struct stream {
+	uint32_t id;
+	uint32_t thread;
+	struct chunk *chunks;
+	unsigned nchunks;
+	unsigned chunks_alloc;
+
+	// Decode position, and the next event if have_next
+	unsigned ci;
+	unsigned ri;
+	int64_t cycle;
+	uint32_t pc;
+	bool have_next;
+	struct event next;
+
+	uint64_t events;	// Wanted events read one stream at a time
+	bool matched;		// With a stream of the other trace, when diffing
+};
+
+struct trace {
+	const char *file;
+	const uint8_t *map;
+	size_t len;
+	struct stream *streams;
+	unsigned nstreams;
+	char *names[MAX_OPS];	// Op names as NAME records spell them out
+	uint64_t events;
+};
+
+static struct {
+	unsigned show;
+	uint32_t addr_lo;
+	uint32_t addr_hi;
+	int64_t cycle_lo;
+	int64_t cycle_hi;
+	bool ignore_cycles;
+	unsigned max_diffs;
+} opts = {
+	.show = 0,
+	.addr_lo = 0,
+	.addr_hi = UINT32_MAX,
+	.cycle_lo = INT64_MIN,
+	.cycle_hi = INT64_MAX,
+	.ignore_cycles = false,
+	.max_diffs = 10,
+};
+
+static void __attribute__ ((noreturn, format (printf, 1, 2)))
+die(const char *fmt, ...) {
+	va_list ap;
+	va_start(ap, fmt);
+	fprintf(stderr, "trace_decode: ");
+	vfprintf(stderr, fmt, ap);
+	va_end(ap);
+	exit(2);
+}
+
+static struct stream *stream_of(struct trace *t, uint32_t id) {
+	unsigned i;
+	for (i = 0; i < t->nstreams; i++)
+		if (t->streams[i].id == id)
+			return &t->streams[i];
+
+	t->streams = realloc(t->streams, (t->nstreams + 1) * sizeof(struct stream));
+	if (t->streams == NULL)
+		die("Out of memory\n");
+	memset(&t->streams[t->nstreams], 0, sizeof(struct stream));
+	t->streams[t->nstreams].id = id;
+	return &t->streams[t->nstreams++];
+}
+
+static void trace_load(struct trace *t, const char *file) {
+	struct stat st;
+	int fd = open(file, O_RDONLY);
+
+	memset(t, 0, sizeof(*t));
+	t->file = file;
+	if ((fd < 0) || (0 != fstat(fd, &st)))
+		die("%s: %s\n", file, strerror(errno));
+	t->len = st.st_size;
+	if (t->len < sizeof(struct trace_file_header))
+		die("%s: Not a trace (too short)\n", file);
+	t->map = mmap(NULL, t->len, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (t->map == MAP_FAILED)
+		die("%s: mmap: %s\n", file, strerror(errno));
+	close(fd);
+
+	const struct trace_file_header *h = (const void *) t->map;
+	if (0 != memcmp(h->magic, TRACE_MAGIC, sizeof(h->magic)))
+		die("%s: Not a trace (bad magic)\n", file);
+	if (h->version != TRACE_VERSION)
+		die("%s: Trace version %u, this decoder reads %u\n",
+				file, h->version, TRACE_VERSION);
+	if (h->record_size != sizeof(struct trace_record))
+		die("%s: Records of %u bytes, expected %zu\n",
+				file, h->record_size, sizeof(struct trace_record));
+
+	// Index every chunk under its stream
+	size_t off = sizeof(*h);
+	while (off < t->len) {
+		const struct trace_chunk_header *c = (const void *) (t->map + off);
+		size_t size = sizeof(*c) +
+			(size_t) c->count * sizeof(struct trace_record);
+
+		if ((t->len - off < sizeof(*c)) || (t->len - off < size)) {
+			fprintf(stderr, "trace_decode: %s: Truncated at byte %zu, "
+					"decoding what came before\n", file, off);
+			break;
+		}
+
+		struct stream *s = stream_of(t, c->stream);
+		s->thread = c->thread;
+		if (s->nchunks == s->chunks_alloc) {
+			s->chunks_alloc = (s->chunks_alloc) ? s->chunks_alloc * 2 : 64;
+			s->chunks = realloc(s->chunks,
+					s->chunks_alloc * sizeof(struct chunk));
+			if (s->chunks == NULL)
+				die("Out of memory\n");
+		}
+		s->chunks[s->nchunks].hdr = c;
+		s->chunks[s->nchunks].recs = (const void *) (c + 1);
+		s->nchunks++;
+		off += size;
+	}
+}
+
+static void name_piece(struct trace *t, const struct trace_record *r) {
+	char **name = &t->names[r->dcycle];
+	size_t len = (*name) ? strlen(*name) : 0;
+
+	*name = realloc(*name, len + TRACE_NAME_CHARS + 1);
+	if (*name == NULL)
+		die("Out of memory\n");
+	memcpy(*name + len, &r->a, 4);
+	memcpy(*name + len + 4, &r->b, 4);
+	(*name)[len + TRACE_NAME_CHARS] = '\0';
+}
+
+// Decodes the stream's next event, false at its end
+static bool stream_advance(struct trace *t, struct stream *s) {
+	while (s->ci < s->nchunks) {
+		const struct chunk *c = &s->chunks[s->ci];
+
+		if (s->ri == 0) {
+			s->cycle = c->hdr->base_cycle;
+			s->pc = c->hdr->base_pc;
+		}
+		if (s->ri == c->hdr->count) {
+			s->ci++;
+			s->ri = 0;
+			continue;
+		}
+
+		const struct trace_record *r = &c->recs[s->ri++];
+		if (r->type == TRACE_NAME) {
+			name_piece(t, r);
+			continue;
+		}
+		s->cycle += r->dcycle;
+		s->pc += r->dpc;
+		if (r->type == TRACE_CYCLES) {
+			s->cycle += (int64_t) (((uint64_t) r->b << 32) | r->a);
+			continue;
+		}
+
+		s->next.type = r->type;
+		s->next.width = r->width;
+		s->next.cycle = s->cycle;
+		s->next.pc = s->pc;
+		s->next.a = r->a;
+		s->next.b = r->b;
+		return true;
+	}
+	return false;
+}
+
+static unsigned kind_of(enum trace_type type) {
+	switch (type) {
+		case TRACE_EXEC:
+		case TRACE_EXEC_IT:
+		case TRACE_SKIP_IT:
+		case TRACE_STALL:
+			return SHOW_EXEC;
+		case TRACE_READ:
+		case TRACE_READ_ERR:
+		case TRACE_WRITE:
+		case TRACE_WRITE_ERR:
+			return SHOW_MEM;
+		case TRACE_EXC_ENTER:
+		case TRACE_EXC_RETURN:
+			return SHOW_EXC;
+		case TRACE_FETCH:
+			return SHOW_FETCH;
+		default:
+			return 0;
+	}
+}
+
+static bool wanted(const struct event *e) {
+	uint32_t addr = (kind_of(e->type) == SHOW_MEM) ? e->a : e->pc;
+
+	if (!(kind_of(e->type) & opts.show))
+		return false;
+	if ((addr < opts.addr_lo) || (addr > opts.addr_hi))
+		return false;
+	if ((e->cycle < opts.cycle_lo) || (e->cycle > opts.cycle_hi))
+		return false;
+	return true;
+}
+
+// The next wanted event of all streams, earliest cycle first
+static bool trace_next(struct trace *t, struct event *e) {
+	while (1) {
+		struct stream *best = NULL;
+		unsigned i;
+
+		for (i = 0; i < t->nstreams; i++) {
+			struct stream *s = &t->streams[i];
+			if (!s->have_next)
+				s->have_next = stream_advance(t, s);
+			if (s->have_next && ((best == NULL) ||
+						(s->next.cycle < best->next.cycle) ||
+						((s->next.cycle == best->next.cycle) &&
+						 (s->thread < best->thread))))
+				best = s;
+		}
+		if (best == NULL)
+			return false;
+
+		*e = best->next;
+		best->have_next = false;
+		if (wanted(e)) {
+			t->events++;
+			return true;
+		}
+	}
+}
+
+// The next wanted event of one stream, ignoring the others
+static bool stream_next(struct trace *t, struct stream *s, struct event *e) {
+	while (stream_advance(t, s)) {
+		if (wanted(&s->next)) {
+			*e = s->next;
+			s->events++;
+			return true;
+		}
+	}
+	return false;
+}
+
+static const char *op_name(const struct trace *t, uint32_t id) {
+	if ((id < MAX_OPS) && t->names[id])
+		return t->names[id];
+	return "?";
+}
+
+// The line the simulator's own text trace prints for the event
+static void format(const struct trace *t, const struct event *e,
+		char *buf, size_t len) {
+	switch (e->type) {
+		case TRACE_EXEC:
+			snprintf(buf, len, "    P: %" PRId64 " - 0x%08x : %04x (%s)",
+					e->cycle, e->pc, e->a, op_name(t, e->b));
+			break;
+		case TRACE_EXEC_IT:
+			snprintf(buf, len, "    P: %" PRId64 "- 0x%08x : %04x (%s)\t%s",
+					e->cycle, e->pc, e->a, op_name(t, e->b),
+					"ITSTATE {executed}");
+			break;
+		case TRACE_SKIP_IT:
+			snprintf(buf, len, "    P: %" PRId64 " - 0x%08x : %04x (%s)\t%s",
+					e->cycle, e->pc, e->a, op_name(t, e->b),
+					"ITSTATE {skipped}");
+			break;
+		case TRACE_STALL:
+			snprintf(buf, len, "    P: %" PRId64 " - 0x%08x : <stall>",
+					e->cycle, e->pc);
+			break;
+		case TRACE_FETCH:
+			snprintf(buf, len, "FETCH: %" PRId64 " - 0x%08x : %0*x",
+					e->cycle, e->pc, e->width * 2, e->a);
+			break;
+		case TRACE_READ:
+			snprintf(buf, len, "MEMTR:  READ 0x%08x -> 0x%08x, %d",
+					e->a, e->b, (int) e->b);
+			break;
+		case TRACE_READ_ERR:
+			snprintf(buf, len, "MEMTR:  READ 0x%08x -> !! ERROR !!", e->a);
+			break;
+		case TRACE_WRITE:
+			snprintf(buf, len, "MEMTR: WRITE 0x%08x <- 0x%08x, %d",
+					e->a, e->b, (int) e->b);
+			break;
+		case TRACE_WRITE_ERR:
+			snprintf(buf, len, "MEMTR: WRITE 0x%08x <- !! ERROR !!", e->a);
+			break;
+		case TRACE_EXC_ENTER:
+			snprintf(buf, len, "EXCPT: %" PRId64 " - enter %u, handler 0x%08x",
+					e->cycle, e->a, e->pc);
+			break;
+		case TRACE_EXC_RETURN:
+			snprintf(buf, len, "EXCPT: %" PRId64 " - return from %u to 0x%08x",
+					e->cycle, e->a, e->pc);
+			break;
+		default:
+			snprintf(buf, len, "????: record type %d", e->type);
+			break;
+	}
+}
+
+static int decode(const char *file) {
+	static struct trace t;
+	struct event e;
+	char line[256];
+
+	trace_load(&t, file);
+	while (trace_next(&t, &e)) {
+		format(&t, &e, line, sizeof(line));
+		puts(line);
+	}
+	return 0;
+}
+
+static bool same(const struct trace *ta, const struct event *a,
+		const struct trace *tb, const struct event *b) {
+	if ((a->type != b->type) || (a->width != b->width) ||
+			(a->pc != b->pc) || (a->a != b->a))
+		return false;
+	if (!opts.ignore_cycles && (a->cycle != b->cycle))
+		return false;
+	// Op ids are handed out as ops first run, so compare by name
+	if (kind_of(a->type) == SHOW_EXEC)
+		return 0 == strcmp(op_name(ta, a->b), op_name(tb, b->b));
+	return a->b == b->b;
+}
+
+static unsigned diff_streams(struct trace *ta, struct stream *sa,
+		struct trace *tb, struct stream *sb, unsigned shown) {
+	struct event a, b;
+	char line[256];
+	unsigned diffs = 0;
+	bool more_a, more_b;
+
+	while (1) {
+		more_a = stream_next(ta, sa, &a);
+		more_b = stream_next(tb, sb, &b);
+		if (!more_a || !more_b)
+			break;
+		if (same(ta, &a, tb, &b))
+			continue;
+
+		if (shown + diffs++ < opts.max_diffs) {
+			printf("@@ thread %08x, event %" PRIu64 "\n",
+					sa->thread, sa->events);
+			format(ta, &a, line, sizeof(line));
+			printf("- %s\n", line);
+			format(tb, &b, line, sizeof(line));
+			printf("+ %s\n", line);
+		}
+	}
+
+	if (more_a || more_b) {
+		struct trace *tl = (more_a) ? ta : tb;
+		struct stream *sl = (more_a) ? sa : sb;
+		uint64_t common = (more_a) ? sb->events : sa->events;
+		while (stream_next(tl, sl, (more_a) ? &a : &b))
+			;
+		printf("%s has %" PRIu64 " more events in thread %08x after "
+				"the first %" PRIu64 "\n", tl->file,
+				sl->events - common, sl->thread, common);
+		diffs++;
+	}
+	return diffs;
+}
+
+static unsigned unmatched(struct trace *t) {
+	struct event e;
+	unsigned i, n = 0;
+
+	for (i = 0; i < t->nstreams; i++) {
+		struct stream *s = &t->streams[i];
+		if (s->matched)
+			continue;
+		while (stream_next(t, s, &e))
+			;
+		if (s->events) {
+			printf("%s has %" PRIu64 " events in thread %08x, which the "
+					"other trace does not have\n", t->file, s->events,
+					s->thread);
+			n++;
+		}
+	}
+	return n;
+}
+
+// Threads are compared one by one: a stage thread can read the cycle count
+// as the main loop bumps it, so only the order within a thread repeats
+static int diff(const char *file_a, const char *file_b) {
+	static struct trace ta, tb;
+	unsigned diffs = 0;
+	uint64_t events = 0;
+	unsigned i, j;
+
+	trace_load(&ta, file_a);
+	trace_load(&tb, file_b);
+
+	for (i = 0; i < ta.nstreams; i++) {
+		struct stream *sa = &ta.streams[i];
+		for (j = 0; j < tb.nstreams; j++) {
+			struct stream *sb = &tb.streams[j];
+			if (!sb->matched && (sb->thread == sa->thread)) {
+				sa->matched = sb->matched = true;
+				diffs += diff_streams(&ta, sa, &tb, sb, diffs);
+				events += sa->events;
+				break;
+			}
+		}
+	}
+	diffs += unmatched(&ta);
+	diffs += unmatched(&tb);
+
+	if (diffs > opts.max_diffs)
+		printf("... %u differences in all\n", diffs);
+	if (diffs == 0) {
+		printf("Traces match (%" PRIu64 " events)\n", events);
+		return 0;
+	}
+	return 1;
+}
+
+static void range(const char *arg, const char *what,
+		unsigned long long *lo, unsigned long long *hi) {
+	char *end;
+
+	*lo = strtoull(arg, &end, 0);
+	if (*end == ':')
+		*hi = strtoull(end + 1, &end, 0);
+	else
+		*hi = *lo;
+	if (*end != '\0')
+		die("Bad %s range '%s', expected LO or LO:HI\n", what, arg);
+}
+
+static void usage(void) {
+	printf("\
+Usage: trace_decode [OPTIONS] TRACE\n\
+       trace_decode [OPTIONS] --diff TRACE_A TRACE_B\n\
+\n\
+Prints a trace written by the simulator's --trace in the simulator's own\n\
+text formats, in cycle order.\n\
+\n\
+\t-p, --printcycles\n\
+\t\tPrint executed instructions (as --printcycles does)\n\
+\t-m, --memory-trace\n\
+\t\tPrint memory accesses (as --memory-trace does)\n\
+\t-x, --exceptions\n\
+\t\tPrint exception entries and returns\n\
+\t-F, --fetch\n\
+\t\tPrint instruction fetches (traced with --trace-fetch)\n\
+\t\tWithout any of the above, everything is printed\n\
+\t-a, --address LO[:HI]\n\
+\t\tOnly events at PCs (or for memory accesses, addresses)\n\
+\t\tfrom LO to HI inclusive\n\
+\t-c, --cycles FROM[:TO]\n\
+\t\tOnly events from cycle FROM to TO inclusive\n\
+\t-d, --diff\n\
+\t\tCompare the events of two traces thread by thread, print\n\
+\t\tthose that differ, and exit 1 if any do\n\
+\t-C, --ignore-cycles\n\
+\t\tWhen comparing, don't count different cycles as a difference\n\
+\t\t(needed with threaded pipelines, whose fetch stage can see\n\
+\t\tthe cycle count change under it)\n\
+\t-n, --max-diffs N\n\
+\t\tPrint at most N differing events (default 10)\n\
+");
+	exit(2);
+}
+
+int main(int argc, char **argv) {
+	bool diffing = false;
+	unsigned long long lo, hi;
+
+	while (1) {
+		static struct option long_options[] = {
+			{"printcycles",   no_argument,       0, 'p'},
+			{"memory-trace",  no_argument,       0, 'm'},
+			{"exceptions",    no_argument,       0, 'x'},
+			{"fetch",         no_argument,       0, 'F'},
+			{"address",       required_argument, 0, 'a'},
+			{"cycles",        required_argument, 0, 'c'},
+			{"diff",          no_argument,       0, 'd'},
+			{"ignore-cycles", no_argument,       0, 'C'},
+			{"max-diffs",     required_argument, 0, 'n'},
+			{"help",          no_argument,       0, '?'},
+			{0,0,0,0}
+		};
+		int c = getopt_long(argc, argv, "pmxFa:c:dCn:?", long_options, NULL);
+		if (c == -1)
+			break;
+
+		switch (c) {
+			case 'p':
+				opts.show |= SHOW_EXEC;
+				break;
+			case 'm':
+				opts.show |= SHOW_MEM;
+				break;
+			case 'x':
+				opts.show |= SHOW_EXC;
+				break;
+			case 'F':
+				opts.show |= SHOW_FETCH;
+				break;
+			case 'a':
+				range(optarg, "address", &lo, &hi);
+				if ((lo > hi) || (hi > UINT32_MAX))
+					die("Bad address range '%s'\n", optarg);
+				opts.addr_lo = lo;
+				opts.addr_hi = hi;
+				break;
+			case 'c':
+				range(optarg, "cycle", &lo, &hi);
+				if ((lo > hi) || (hi > INT64_MAX))
+					die("Bad cycle range '%s'\n", optarg);
+				opts.cycle_lo = lo;
+				opts.cycle_hi = hi;
+				break;
+			case 'd':
+				diffing = true;
+				break;
+			case 'C':
+				opts.ignore_cycles = true;
+				break;
+			case 'n':
+				opts.max_diffs = atoi(optarg);
+				break;
+			case '?':
+			default:
+				usage();
+		}
+	}
+	if (opts.show == 0)
+		opts.show = SHOW_EXEC | SHOW_MEM | SHOW_EXC | SHOW_FETCH;
+
+	if (diffing) {
+		if (argc - optind != 2)
+			usage();
+		return diff(argv[optind], argv[optind + 1]);
+	}
+	if (argc - optind != 1)
+		usage();
+	return decode(argv[optind]);
+}